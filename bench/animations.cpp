@@ -0,0 +1,78 @@
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "animations.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+void report(std::string name, double animations, double group) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << animations << " ns" << std::setw(10) << group << " ns" << std::setw(9) << animations / group << "x" << std::endl;
+}
+
+// plays a timeline both the way AnimationGroup::tick used to (every animation on every frame) and through the group,
+// reporting the cost per track and frame
+void compare(std::string name, std::vector<Animation> &animations, int frames, unsigned long delta) {
+    std::vector<Animation> copies(animations);
+    AnimationGroup group(animations);
+    int items = animations.size() * frames;
+    report(
+        name,
+        measure([&] {
+            for (auto &animation : copies) animation.reset();
+            for (int frame = 0; frame < frames; ++frame) {
+                std::accumulate(copies.begin(), copies.end(), true, [delta](bool done, Animation &animation) {
+                    animation.tick(delta);
+                    return done && animation.isDone();
+                });
+            } }, items),
+        measure([&] {
+            group.reset();
+            for (int frame = 0; frame < frames; ++frame) group.tick(delta); }, items));
+}
+
+int main() {
+    const int count = 100000;
+    std::mt19937 random(42);
+    GLfloat (*eases[])(GLfloat) = {Ease::linear, Ease::quadraticInOut, Ease::cubicInOut, Ease::quinticInOut, Ease::sinusoidalInOut, Ease::circularOut};
+    std::vector<GLfloat> targets(count);
+    std::vector<Animation> animations;
+
+    std::cout << std::left << std::setw(24) << "case" << std::right << std::setw(13) << "per anim" << std::setw(13) << "tracks" << std::setw(10) << "speedup" << std::endl;
+
+    // every track in progress on every frame
+    for (int i = 0; i < count; ++i) {
+        animations.emplace_back(random() % 100, 2000 + random() % 1000, 0, 1, eases[random() % 6], &targets[i]);
+    }
+    compare("100k concurrent", animations, 60, 16);
+
+    // the same tracks through callbacks
+    animations.clear();
+    for (int i = 0; i < count; ++i) {
+        GLfloat *target = &targets[i];
+        animations.emplace_back(random() % 100, 2000 + random() % 1000, 0, 1, eases[random() % 6], [target](GLfloat value) { *target = value; });
+    }
+    compare("100k callbacks", animations, 60, 16);
+
+    // a long timeline, a few hundred tracks in progress at any time
+    animations.clear();
+    for (int i = 0; i < count; ++i) {
+        animations.emplace_back(i * 10, 500 + random() % 1000, 0, 1, eases[random() % 6], &targets[i]);
+    }
+    compare("100k staggered", animations, 600, 16);
+}
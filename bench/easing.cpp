@@ -0,0 +1,95 @@
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "animations.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+// largest difference from the scalar reference
+GLfloat error(const std::vector<GLfloat> &reference, const std::vector<GLfloat> &output) {
+    GLfloat error = 0;
+    for (size_t i = 0; i < reference.size(); ++i) error = std::max(error, std::abs(reference[i] - output[i]));
+    return error;
+}
+
+// the batch kernels only reorder the same arithmetic, a baked curve is as good as its resolution allows
+// (the circular easings have unbounded slopes at their ends, so their samples are interpolated less closely)
+const GLfloat simdBound = 1e-5, curveBound = 1e-3, steepCurveBound = 5e-2;
+
+int main() {
+    const int count = 1 << 20;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<GLfloat> distribution(0, 1);
+    std::vector<GLfloat> input(count), reference(count), output(count);
+    for (auto &value : input) value = distribution(random);
+    input[0] = 0, input[1] = 0.5, input[2] = 1;
+    volatile GLfloat sink = 0;
+    bool passed = true;
+
+    std::cout << std::left << std::setw(20) << "case" << std::right << std::setw(13) << "scalar" << std::setw(13) << "simd" << std::setw(13) << "curve"
+              << std::setw(12) << "simd err" << std::setw(12) << "curve err" << std::endl;
+    auto report = [&](std::string name, double scalar, double simd, double curve, GLfloat simdError, GLfloat curveError, GLfloat bound) {
+        bool ok = simdError <= simdBound && curveError <= bound;
+        passed = passed && ok;
+        std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << scalar << " ns";
+        // keyframe curves have no batch kernel
+        if (simd < 0) {
+            std::cout << std::setw(13) << "-";
+        } else {
+            std::cout << std::setw(10) << simd << " ns";
+        }
+        std::cout << std::setw(10) << curve << " ns"
+                  << std::scientific << std::setprecision(1) << std::setw(12) << simdError << std::setw(12) << curveError << (ok ? "" : "  FAIL") << std::endl;
+    };
+
+    struct {
+        std::string name;
+        GLfloat (*ease)(GLfloat);
+    } eases[] = {
+        {"linear", Ease::linear},
+        {"quadraticIn", Ease::quadraticIn}, {"quadraticOut", Ease::quadraticOut}, {"quadraticInOut", Ease::quadraticInOut},
+        {"cubicIn", Ease::cubicIn}, {"cubicOut", Ease::cubicOut}, {"cubicInOut", Ease::cubicInOut},
+        {"quarticIn", Ease::quarticIn}, {"quarticOut", Ease::quarticOut}, {"quarticInOut", Ease::quarticInOut},
+        {"quinticIn", Ease::quinticIn}, {"quinticOut", Ease::quinticOut}, {"quinticInOut", Ease::quinticInOut},
+        {"sinusoidalIn", Ease::sinusoidalIn}, {"sinusoidalOut", Ease::sinusoidalOut}, {"sinusoidalInOut", Ease::sinusoidalInOut},
+        {"exponentialIn", Ease::exponentialIn}, {"exponentialOut", Ease::exponentialOut}, {"exponentialInOut", Ease::exponentialInOut},
+        {"circularIn", Ease::circularIn}, {"circularOut", Ease::circularOut}, {"circularInOut", Ease::circularInOut},
+    };
+    for (auto &[name, ease] : eases) {
+        auto curve = Curve::bake(ease);
+        double scalar = measure([&] { for (int i = 0; i < count; ++i) reference[i] = ease(input[i]); sink = sink + reference[count / 2]; }, count);
+        double simd = measure([&] { Ease::evaluate(ease, input.data(), output.data(), count); sink = sink + output[count / 2]; }, count);
+        GLfloat simdError = error(reference, output);
+        double baked = measure([&] { curve->evaluate(input.data(), output.data(), count); sink = sink + output[count / 2]; }, count);
+        report(name, scalar, simd, baked, simdError, error(reference, output), name.rfind("circular", 0) == 0 ? steepCurveBound : curveBound);
+    }
+
+    // keyframe curves, which only exist baked
+    auto compareCurve = [&](std::string name, std::function<GLfloat(GLfloat)> exact, std::shared_ptr<const Curve> curve) {
+        double scalar = measure([&] { for (int i = 0; i < count; ++i) reference[i] = exact(input[i]); sink = sink + reference[count / 2]; }, count, 1);
+        double baked = measure([&] { curve->evaluate(input.data(), output.data(), count); sink = sink + output[count / 2]; }, count);
+        report(name, scalar, -1, baked, 0, error(reference, output), curveBound);
+    };
+    compareCurve("bezier", [](GLfloat t) { return Ease::cubicBezier(0.25, 0.1, 0.25, 1, t); }, Curve::bezier(0.25, 0.1, 0.25, 1));
+    compareCurve("bezier overshoot", [](GLfloat t) { return Ease::cubicBezier(0.68, -0.55, 0.27, 1.55, t); }, Curve::bezier(0.68, -0.55, 0.27, 1.55));
+    std::vector<GLfloat> keys = {0, 0.6, 0.4, 0.9, 1};
+    compareCurve("catmull-rom", [&keys](GLfloat t) { return Ease::catmullRom(keys, t); }, Curve::catmullRom(keys));
+
+    std::cout << (passed ? "all within bounds" : "some cases out of bounds") << std::endl;
+    return passed ? 0 : 1;
+}
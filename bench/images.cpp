@@ -0,0 +1,66 @@
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "RgbImage.h"
+#include "bitmaps.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+// writes and loads back a bitmap of the given size, both into an RgbImage and as a Bitmap left in the mapping of its
+// file, reporting the cost per pixel and the rate over the file; files stay in the page cache between runs, so this
+// measures parsing and conversion rather than the disk
+void report(std::string path, int rows, int columns) {
+    RgbImage image(rows, columns);
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) image.SetRgbPixelc(row, column, row, column, row ^ column);
+    }
+    const int pixels = rows * columns, times = std::max(1, (1 << 22) / pixels);
+    double bytes = 54 + (double) image.GetNumBytesPerRow() * rows;
+    double write = measure([&] {
+        for (int i = 0; i < times; ++i) image.WriteBmpFile(path.c_str());
+    }, times * pixels);
+    volatile unsigned char sink = 0;
+    double load = measure([&] {
+        for (int i = 0; i < times; ++i) {
+            RgbImage loaded;
+            loaded.LoadBmpFile(path.c_str());
+            sink = sink + *loaded.GetRgbPixel(rows / 2, columns / 2);
+        }
+    }, times * pixels);
+    double map = measure([&] {
+        for (int i = 0; i < times; ++i) {
+            Bitmap bitmap;
+            bitmap.load(path);
+            sink = sink + bitmap.getWidth();
+        }
+    }, times * pixels);
+    std::cout << std::left << std::setw(24) << std::to_string(columns) + "x" + std::to_string(rows) << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << write << " ns" << std::setw(9) << bytes / write / pixels * 1000 << " MB/s"
+              << std::setw(10) << load << " ns" << std::setw(9) << bytes / load / pixels * 1000 << " MB/s"
+              << std::setw(10) << map << " ns" << std::endl;
+}
+
+int main() {
+    std::string path = (std::filesystem::temp_directory_path() / "images_benchmark.bmp").string();
+
+    std::cout << std::left << std::setw(24) << "size" << std::right << std::setw(13) << "write" << std::setw(14) << "rate" << std::setw(13) << "load" << std::setw(14) << "rate" << std::setw(13) << "map" << std::endl;
+
+    // square textures the size the scene uses and around it, and a width that needs row padding
+    for (int size : {64, 256, 512, 1024, 2048}) report(path, size, size);
+    report(path, 1023, 1023);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "maths.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+void report(std::string name, double scalar, double simd) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << scalar << " ns" << std::setw(10) << simd << " ns" << std::setw(9) << scalar / simd << "x" << std::endl;
+}
+
+int main() {
+    const int count = 1 << 20;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<GLfloat> distribution(-10, 10);
+    std::vector<GLfloat> input(count * 3), output(count * 3), other(count * 3);
+    for (auto &value : input) value = distribution(random);
+    volatile GLfloat sink = 0;
+
+    std::cout << std::left << std::setw(24) << "case" << std::right << std::setw(13) << "scalar" << std::setw(13) << "simd" << std::setw(10) << "speedup" << std::endl;
+
+    // exp
+    report(
+        "exp",
+        measure([&] { for (int i = 0; i < count; ++i) output[i] = std::exp(input[i]); sink = sink + output[count / 2]; }, count),
+        measure([&] { Maths::exp(input.data(), output.data(), count); sink = sink + output[count / 2]; }, count));
+
+    // sin & cos
+    report(
+        "sin + cos",
+        measure([&] { for (int i = 0; i < count; ++i) { output[i] = std::sin(input[i]); other[i] = std::cos(input[i]); } sink = sink + output[count / 2]; }, count),
+        measure([&] { Maths::sinCos(input.data(), output.data(), other.data(), count); sink = sink + output[count / 2]; }, count));
+
+    // matrix multiply
+    const int matrices = 1 << 14;
+    Matrix4 a = Matrix4::rotation(30, {1, 2, 3}), b = Matrix4::translation({1, 2, 3});
+    std::vector<Matrix4> inputs(matrices), outputs(matrices);
+    for (int n = 0; n < matrices; ++n) inputs[n] = Matrix4::rotation(n, {1, 1, 0}) * Matrix4::translation({(GLfloat) n, 0, 0});
+    report(
+        "mat4 * mat4",
+        measure([&] {
+            for (int n = 0; n < matrices; ++n) {
+                GLfloat *c = outputs[n].array;
+                const GLfloat *d = inputs[n].array;
+                for (int i = 0; i < 4; ++i) {
+                    for (int j = 0; j < 4; ++j) {
+                        c[i * 4 + j] = 0;
+                        for (int k = 0; k < 4; ++k) c[i * 4 + j] += a.array[k * 4 + j] * d[i * 4 + k];
+                    }
+                }
+            }
+            sink = sink + outputs[matrices / 2].array[5]; }, matrices),
+        measure([&] {
+            for (int n = 0; n < matrices; ++n) outputs[n] = a * inputs[n];
+            sink = sink + outputs[matrices / 2].array[5]; }, matrices));
+
+    // transform points
+    Matrix4 m = b * a;
+    report(
+        "transform points",
+        measure([&] {
+            for (int i = 0; i < count; ++i) {
+                const GLfloat *p = &input[i * 3];
+                for (int j = 0; j < 3; ++j) output[i * 3 + j] = m.array[j] * p[0] + m.array[4 + j] * p[1] + m.array[8 + j] * p[2] + m.array[12 + j];
+            }
+            sink = sink + output[count / 2]; }, count),
+        measure([&] { Maths::transformPoints(m, input.data(), output.data(), count); sink = sink + output[count / 2]; }, count));
+
+    // observer update (the formula Observer::updatePosition used before)
+    const int steps = 1 << 18;
+    GLfloat mass = 1000, drag = 5;
+    report(
+        "observer update",
+        measure([&] {
+            Coordinates3D position, velocity, force{0.3f, 0.1f, -0.2f};
+            for (int n = 0; n < steps; ++n) {
+                unsigned long delta = 16 + (n & 3);
+                position = {
+                    position.x + (force.x / drag) * delta + (force.x / drag - velocity.x) * (mass / drag) * (GLfloat) std::exp(-(drag / mass) * delta) - (force.x / drag - velocity.x) * (mass / drag),
+                    position.y + (force.y / drag) * delta + (force.y / drag - velocity.y) * (mass / drag) * (GLfloat) std::exp(-(drag / mass) * delta) - (force.y / drag - velocity.y) * (mass / drag),
+                    position.z + (force.z / drag) * delta + (force.z / drag - velocity.z) * (mass / drag) * (GLfloat) std::exp(-(drag / mass) * delta) - (force.z / drag - velocity.z) * (mass / drag),
+                };
+                velocity = {
+                    (force.x / drag) - (GLfloat) std::exp(-(drag / mass) * delta) * (force.x / drag - velocity.x),
+                    (force.y / drag) - (GLfloat) std::exp(-(drag / mass) * delta) * (force.y / drag - velocity.y),
+                    (force.z / drag) - (GLfloat) std::exp(-(drag / mass) * delta) * (force.z / drag - velocity.z),
+                };
+            }
+            sink = sink + position.x; }, steps),
+        measure([&] {
+            Vector3 position, velocity, force(0.3f, 0.1f, -0.2f);
+            for (int n = 0; n < steps; ++n) {
+                unsigned long delta = 16 + (n & 3);
+                GLfloat decay = Maths::exp(-(drag / mass) * delta);
+                Vector3 terminalVelocity = force / drag, difference = terminalVelocity - velocity;
+                position = position + terminalVelocity * (GLfloat) delta + difference * ((mass / drag) * (decay - 1));
+                velocity = terminalVelocity - difference * decay;
+            }
+            sink = sink + position.x; }, steps));
+}
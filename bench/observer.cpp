@@ -0,0 +1,78 @@
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "collisions.hpp"
+#include "observer.hpp"
+#include "shapes.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+// walks an observer around for a while, turning as it goes so that it keeps running into whatever is there, with the
+// constants main uses, and reports the cost per tick
+void report(std::string name, const CollisionScene *collisions) {
+    const int ticks = 1 << 14;
+    volatile GLfloat sink = 0;
+    double time = measure([&] {
+        Observer observer(0, 0, 0, -M_PI_2, 0, 0.0003, 1000, 0.35, 5);
+        if (collisions) observer.setCollisions(collisions, 0.3);
+        for (int i = 0; i < ticks; ++i) {
+            observer.moveCamera(i % 600 < 300 ? 20 : -7, i % 200 < 100 ? 3 : -3);
+            observer.applyForce(1, i % 1000 < 500 ? 0.5 : -0.5);
+            observer.tick(16);
+        }
+        sink = sink + observer.getPosition().x;
+    }, ticks);
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2) << std::setw(10) << time << " ns" << std::endl;
+}
+
+// a closed box of the given size with a grid of pillars of some detail inside
+Shape *room(GLfloat size, int pillars, int detail) {
+    std::vector<Shape *> shapes = {
+        (new Cuboid(size, 0.2, size))->translate({0, -size / 2, 0}),
+        (new Cuboid(size, 0.2, size))->translate({0, size / 2, 0}),
+        (new Cuboid(0.2, size, size))->translate({-size / 2, 0, 0}),
+        (new Cuboid(0.2, size, size))->translate({size / 2, 0, 0}),
+        (new Cuboid(size, size, 0.2))->translate({0, 0, -size / 2}),
+        (new Cuboid(size, size, 0.2))->translate({0, 0, size / 2}),
+    };
+    for (int i = 0; i < pillars; ++i) {
+        for (int j = 0; j < pillars; ++j) {
+            GLfloat x = (i + 0.5f) / pillars - 0.5f, z = (j + 0.5f) / pillars - 0.5f;
+            if (i == pillars / 2 && j == pillars / 2) continue;  // where the observer starts
+            shapes.push_back((new PrismWall(0.2, size, detail))->translate({x * size, 0, z * size})->rotate({90, 0, 0}));
+        }
+    }
+    return new CompoundShape(shapes);
+}
+
+int main() {
+    std::cout << std::left << std::setw(24) << "case" << std::right << std::setw(13) << "tick" << std::endl;
+
+    report("no collisions", nullptr);
+    for (auto [name, pillars, detail] : std::initializer_list<std::tuple<std::string, int, int>>{
+             {"empty room", 0, 0},
+             {"5x5 pillars", 5, 16},
+             {"5x5 pillars, 160 sides", 5, 160},
+             {"15x15 pillars", 15, 16},
+         }) {
+        std::unique_ptr<Shape> scene(room(10, pillars, detail));
+        CollisionScene collisions;
+        collisions.build(*scene);
+        collisions.update();
+        report(name, &collisions);
+    }
+}
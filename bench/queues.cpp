@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "queues.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+// orders a frame's worth of depths spread through the view, and a queue of that many items with one in ten of them
+// see-through, which is the work a frame does before it draws
+void report(int count) {
+    std::mt19937 random(count);
+    std::uniform_real_distribution<GLfloat> distribution(-1, 100);
+    std::vector<GLfloat> depths(count);
+    for (auto &depth : depths) depth = distribution(random);
+
+    DrawQueue queue;
+    std::vector<uint64_t> entries(count), sorted;
+    auto fill = [&] {
+        for (int i = 0; i < count; ++i) entries[i] = (uint64_t) DrawQueue::getDepthKey(depths[i]) << 32 | i;
+    };
+    double radix = measure([&] {
+        fill();
+        queue.radixSort(entries);
+    }, count);
+    sorted = entries;
+    double standard = measure([&] {
+        fill();
+        std::stable_sort(entries.begin(), entries.end(), [](uint64_t a, uint64_t b) { return a >> 32 < b >> 32; });
+    }, count);
+    if (sorted != entries) std::cerr << "radix sort disagrees with std::stable_sort for " << count << " items" << std::endl;
+
+    DrawItem item = {};
+    item.color = {1, 1, 1, 1};
+    uint32_t solid = Materials::intern({{1, 1, 1, 1}, {1, 1, 1, 1}, {1, 1, 1, 1}, 0}), glass = Materials::intern({{1, 1, 1, 0.5}, {1, 1, 1, 0.5}, {1, 1, 1, 1}, 0});
+    double queued = measure([&] {
+        queue.clear();
+        for (int i = 0; i < count; ++i) {
+            item.depth = depths[i];
+            item.material = i % 10 == 0 ? glass : solid;
+            queue.push(item);
+        }
+        queue.sort();
+    }, count);
+
+    std::cout << std::left << std::setw(12) << count << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << radix << " ns" << std::setw(10) << standard << " ns" << std::setw(10) << queued << " ns" << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(12) << "items" << std::right << std::setw(13) << "radix" << std::setw(13) << "stable" << std::setw(13) << "queue" << std::endl;
+    for (int count : {100, 1000, 10000, 100000}) report(count);
+}
@@ -0,0 +1,88 @@
+#define _USE_MATH_DEFINES
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "structures.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+// the dynamic value before it was reactive, a constant or a function called on every read, to compare against
+template <typename T>
+class VariantValue {
+    private:
+    std::variant<T, std::function<T()>> getter;
+
+    public:
+    VariantValue(const T &constant) : getter(constant) {}
+    VariantValue(std::function<T()> function) : getter(function) {}
+    VariantValue(const T *pointer) : VariantValue(std::function<T()>([pointer]() { return *pointer; })) {}
+    T operator()() const { return getter.index() == 0 ? std::get<T>(getter) : std::get<std::function<T()>>(getter)(); }
+};
+
+// reads a value many times within an epoch (as the shapes of a frame do) and once per epoch, changing its input
+// before each read when asked to, next to the same reads of the old value when there is one
+void report(std::string name, const DynamicValue<GLfloat> &value, GLfloat *input = nullptr, const VariantValue<GLfloat> *old = nullptr) {
+    const int count = 1 << 18;
+    volatile GLfloat sink = 0;
+    double same = measure([&] {
+        for (int i = 0; i < count; ++i) sink = sink + value();
+    }, count);
+    double next = measure([&] {
+        for (int i = 0; i < count; ++i) {
+            if (input) *input = i;
+            Reactive::advance();
+            sink = sink + value();
+        }
+    }, count);
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << same << " ns" << std::setw(10) << next << " ns";
+    if (old) {
+        double variant = measure([&] {
+            for (int i = 0; i < count; ++i) sink = sink + (*old)();
+        }, count);
+        std::cout << std::setw(10) << variant << " ns";
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    GLfloat variable = 1, changing = 1;
+
+    std::cout << std::left << std::setw(24) << "case" << std::right << std::setw(13) << "same epoch" << std::setw(13) << "new epoch" << std::setw(13) << "variant" << std::endl;
+
+    VariantValue<GLfloat> constant(2.0f), pointer(&variable), lambda(std::function<GLfloat()>([&] { return variable * 2; }));
+    report("constant", DynamicValue<GLfloat>(2.0f), nullptr, &constant);
+    report("pointer", DynamicValue<GLfloat>(&variable), nullptr, &pointer);
+    report("pointer, changing", DynamicValue<GLfloat>(&changing), &changing);
+    report("volatile lambda", DynamicValue<GLfloat>([&] { return variable * 2; }), nullptr, &lambda);
+    report("derived", DynamicValue<GLfloat>([&] { return Reactive::read(&variable) * 2; }));
+    report("derived, changing", DynamicValue<GLfloat>([&] { return Reactive::read(&changing) * 2; }), &changing);
+
+    // a chain of values each derived from the one before, as nested transformations are
+    for (int length : {4, 16}) {
+        for (GLfloat *input : {&variable, &changing}) {
+            std::vector<DynamicValue<GLfloat>> chain = {DynamicValue<GLfloat>(input)};
+            for (int i = 1; i < length; ++i) {
+                DynamicValue<GLfloat> previous = chain.back();
+                chain.push_back(DynamicValue<GLfloat>([previous] { return previous() + 1; }));
+            }
+            report("chain of " + std::to_string(length) + (input == &changing ? ", changing" : ""), chain.back(), input == &changing ? input : nullptr);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shapes.hpp"
+
+// best of several runs, in nanoseconds per item
+double measure(std::function<void()> run, int items, int runs = 7) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / items);
+    }
+    return best;
+}
+
+struct Case {
+    std::string name;
+    int quads;  // before meshing, as getQuadCount gives them
+    std::function<SimpleShape *()> create;
+};
+
+// builds fresh shapes the way their first render does, through collect, which needs no gl context: generate, the
+// mesh of the given level if it is above one, welding and interleaving; returns milliseconds per shape, or a negative
+// number when the mesh would be too large to be worth building
+double build(const Case &shape, int level) {
+    const long maxQuads = 1 << 18;
+    long quads = shape.quads;
+    for (int i = 1; i < level; ++i) quads *= 4;
+    if (level > 1 && quads > maxQuads) return -1;
+    int count = std::max<long>(1, (1 << 14) / quads);
+    int runs = quads > (1 << 15) ? 3 : 7;
+    std::vector<Collider> colliders;
+    std::vector<std::shared_ptr<Transformation>> chain;
+    return measure([&] {
+        for (int i = 0; i < count; ++i) {
+            std::unique_ptr<SimpleShape> built(shape.create());
+            built->setMeshLevel(level);
+            built->collect(colliders, chain);
+            colliders.clear();
+        }
+    }, count, runs) / 1e6;
+}
+
+int main() {
+    // the shapes and details the door scene uses, and a step past them
+    std::vector<Case> cases = {
+        {"cuboid", 6, [] { return new Cuboid(1, 1, 1); }},
+        {"prism 15", 15, [] { return new PrismWall(0.05, 0.7, 15); }},
+        {"prism 40", 40, [] { return new PrismWall(0.1, 1, 40); }},
+        {"prism 160", 160, [] { return new PrismWall(0.1, 1, 160); }},
+        {"sphere 10", 100, [] { return new Sphere(0.25, 10); }},
+        {"sphere 20", 400, [] { return new Sphere(1, 20); }},
+        {"sphere 40", 1600, [] { return new Sphere(0.8, 40); }},
+        {"sphere 80", 6400, [] { return new Sphere(0.8, 80); }},
+        {"donut 20x5", 100, [] { return new Donut(0.4, 1.2, 20, 5); }},
+        {"donut 41x10", 410, [] { return new Donut(0.6, 0.8, 41, 10); }},
+        {"donut 80x20", 1600, [] { return new Donut(0.6, 0.8, 80, 20); }},
+        {"ring 16", 64, [] { return new Ring(0.4, 0.5, 0.5, 16); }},
+        {"ring 40", 160, [] { return new Ring(0.8, 1, 0.1, 40); }},
+        {"ring 160", 640, [] { return new Ring(0.8, 1, 0.1, 160); }},
+    };
+
+    std::cout << std::left << std::setw(14) << "shape" << std::right << std::setw(8) << "quads";
+    for (int level = 1; level <= 6; ++level) std::cout << std::setw(12) << (level == 1 ? "build" : "mesh " + std::to_string(level));
+    std::cout << std::endl;
+    for (auto &shape : cases) {
+        std::cout << std::left << std::setw(14) << shape.name << std::right << std::setw(8) << shape.quads << std::fixed << std::setprecision(3);
+        for (int level = 1; level <= 6; ++level) {
+            double time = build(shape, level);
+            if (time < 0) std::cout << std::setw(12) << "-";
+            else std::cout << std::setw(9) << time << " ms";
+        }
+        std::cout << std::endl;
+    }
+}
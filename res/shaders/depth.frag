@@ -0,0 +1,5 @@
+#version 130
+
+// only depth is written, the color mask is off
+void main(void) {
+}
@@ -0,0 +1,6 @@
+#version 130
+
+void main(void) {
+    // exactly as the fixed pipeline transforms, like the shading passes, so their depths test equal to these
+    gl_Position = ftransform();
+}
@@ -1,3 +1,7 @@
+attribute vec2 octahedralNormal;
+attribute vec4 vertexDecode;
+attribute float normalEncoding;
+
 uniform int maxLights;
 uniform int lightsOn[8];
 
@@ -7,12 +11,28 @@ float d, attenuation;
 vec3 position, N, O, L, R;
 vec4 Iamb, Idiff, Ispec;
 
+vec3 decodeNormal() {
+    // octahedral normal (unfold the lower hemisphere)
+    if (normalEncoding == 1.0) {
+        vec3 n = vec3(octahedralNormal, 1.0 - abs(octahedralNormal.x) - abs(octahedralNormal.y));
+        if (n.z < 0.0) {
+            n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        }
+        return n;
+    }
+    // analytic normal (sphere centered at the origin)
+    if (normalEncoding == 2.0) {
+        return gl_Vertex.xyz * vertexDecode.w + vertexDecode.xyz;
+    }
+    return gl_Normal;
+}
+
 void main(void) {
     // calculate vertex position
     position = vec3(gl_ModelViewMatrix * gl_Vertex);
     
     // calculate N (normal)
-    N = normalize(gl_NormalMatrix * gl_Normal);
+    N = normalize(gl_NormalMatrix * decodeNormal());
 
     // set initial color to ambient color of scene
     color = gl_FrontLightModelProduct.sceneColor;
@@ -23,12 +43,12 @@ void main(void) {
     // for light in lights
     for (int i = 0; i < maxLights; i++) {
         // cancel if light is not on
-        if (!lightsOn[i]) {
+        if (lightsOn[i] == 0) {
             continue;
         }
 
         // calculate L (points towards light source)
-        if (gl_LightSource[i].position.w == 0) {
+        if (gl_LightSource[i].position.w == 0.0) {
             L = normalize(gl_LightSource[i].position.xyz);
         } else {
             L = normalize(gl_LightSource[i].position.xyz - position);
@@ -43,7 +63,7 @@ void main(void) {
         R = normalize(reflect(-L, N));
 
         // calculate d (distance to light)
-        d = distance(gl_LightSource[i].position, position);
+        d = distance(gl_LightSource[i].position.xyz, position);
         // calculate light attenuation
         attenuation = clamp(1.0 / (gl_LightSource[i].constantAttenuation + gl_LightSource[i].linearAttenuation * d + gl_LightSource[i].quadraticAttenuation * d * d), 0.0, 1.0);
 
@@ -58,6 +78,6 @@ void main(void) {
         color += attenuation * (Iamb + Idiff + Ispec);
     }
 
-    // set vertex position
-    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+    // set vertex position, as the depth pre-pass does, which the shading pass tests equal against
+    gl_Position = ftransform();
 }
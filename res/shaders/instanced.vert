@@ -0,0 +1,93 @@
+#version 140
+#extension GL_ARB_compatibility : enable
+
+// keyframe tracks, four floats a texel; an animation is a texel holding its track count followed by its tracks,
+// each a header texel (kind, key count, duration, looping) followed by its keys (time, x, y, z) by time
+uniform samplerBuffer keyframes;
+uniform float time;
+// the modelview matrix the shape is drawn with, without the decode of quantized positions, which comes separately
+uniform mat4 view;
+uniform mat4 decode;
+
+in vec2 octahedralNormal;
+in vec4 vertexDecode;
+in float normalEncoding;
+in float materialIndex;
+in vec2 instanceAnimation;  // first texel of the animation, time it started at
+in mat4 instanceMatrix;
+
+// computed the same in the depth-only variant, so the pre-pass depths test equal to the shaded ones
+invariant gl_Position;
+
+out vec3 position;
+out vec3 N;
+flat out int material;
+
+vec3 decodeNormal() {
+    // octahedral normal (unfold the lower hemisphere)
+    if (normalEncoding == 1.0) {
+        vec3 n = vec3(octahedralNormal, 1.0 - abs(octahedralNormal.x) - abs(octahedralNormal.y));
+        if (n.z < 0.0) {
+            n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        }
+        return n;
+    }
+    // analytic normal (sphere centered at the origin)
+    if (normalEncoding == 2.0) {
+        return gl_Vertex.xyz * vertexDecode.w + vertexDecode.xyz;
+    }
+    return gl_Normal;
+}
+
+vec3 sampleTrack(int first, int count, float age) {
+    // last key at or before the age
+    int low = 0, high = count - 1;
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+        if (texelFetch(keyframes, first + middle).x <= age) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    vec4 key = texelFetch(keyframes, first + low);
+    if (low == count - 1 || age <= key.x) return key.yzw;
+    vec4 next = texelFetch(keyframes, first + low + 1);
+    return mix(key.yzw, next.yzw, (age - key.x) / (next.x - key.x));
+}
+
+// same matrices as glTranslatef, glRotatef around x, then y, then z, and glScalef
+mat4 transformation(float kind, vec3 value) {
+    if (kind == 0.0) return mat4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, value, 1);
+    if (kind == 2.0) return mat4(value.x, 0, 0, 0, 0, value.y, 0, 0, 0, 0, value.z, 0, 0, 0, 0, 1);
+    vec3 s = sin(radians(value)), c = cos(radians(value));
+    mat4 x = mat4(1, 0, 0, 0, 0, c.x, s.x, 0, 0, -s.x, c.x, 0, 0, 0, 0, 1);
+    mat4 y = mat4(c.y, 0, -s.y, 0, 0, 1, 0, 0, s.y, 0, c.y, 0, 0, 0, 0, 1);
+    mat4 z = mat4(c.z, s.z, 0, 0, -s.z, c.z, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+    return x * y * z;
+}
+
+mat4 animate(int first, float age) {
+    mat4 matrix = mat4(1.0);
+    int tracks = int(texelFetch(keyframes, first).x);
+    int texel = first + 1;
+    for (int i = 0; i < tracks; ++i) {
+        vec4 header = texelFetch(keyframes, texel);
+        int count = int(header.y);
+        // instances that have not started yet rest on the first keys
+        float trackAge = header.w > 0.5 && age > 0.0 ? mod(age, header.z) : age;
+        matrix = matrix * transformation(header.x, sampleTrack(texel + 1, count, trackAge));
+        texel += 1 + count;
+    }
+    return matrix;
+}
+
+void main(void) {
+    mat4 model = instanceMatrix * animate(int(instanceAnimation.x), time - instanceAnimation.y);
+    vec4 vertex = view * model * decode * gl_Vertex;
+    position = vec3(vertex);
+    // lighting takes instances as scaled uniformly, so normals skip the inverse transpose
+    N = normalize(mat3(view) * mat3(model) * decodeNormal());
+    material = int(materialIndex);
+    gl_Position = gl_ProjectionMatrix * vertex;
+}
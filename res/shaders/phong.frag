@@ -1,17 +1,28 @@
+#version 140
+#extension GL_ARB_compatibility : enable
+
 uniform int maxLights;
 uniform int lightsOn[8];
 uniform float solidness;
+// the material table, four texels a material: ambient, diffuse, specular and shininess
+uniform samplerBuffer materials;
 
-varying vec3 position;
-varying vec3 N;
+in vec3 position;
+in vec3 N;
+flat in int material;
 
 float d, attenuation;
 vec3 O, L, R;
 vec4 Iamb, Idiff, Ispec;
 
 void main(void) {
-    // set initial color to ambient color of scene
-    gl_FragColor = gl_FrontLightModelProduct.sceneColor;
+    // fetch the material
+    int first = material * 4;
+    vec4 ambient = texelFetch(materials, first), diffuse = texelFetch(materials, first + 1), specular = texelFetch(materials, first + 2);
+    float shininess = texelFetch(materials, first + 3).x;
+
+    // set initial color to ambient color of scene, with the diffuse alpha as lit colors have
+    gl_FragColor = vec4(gl_FrontMaterial.emission.rgb + ambient.rgb * gl_LightModel.ambient.rgb, diffuse.a);
 
     // calculate O (points towards observer)
     O = normalize(-position);
@@ -19,12 +30,12 @@ void main(void) {
     // for light in lights
     for (int i = 0; i < maxLights; i++) {
         // cancel if light is not on
-        if (!lightsOn[i]) {
+        if (lightsOn[i] == 0) {
             continue;
         }
 
         // calculate L (points towards light source)
-        if (gl_LightSource[i].position.w == 0) {
+        if (gl_LightSource[i].position.w == 0.0) {
             L = normalize(gl_LightSource[i].position.xyz);
         } else {
             L = normalize(gl_LightSource[i].position.xyz - position);
@@ -39,16 +50,16 @@ void main(void) {
         R = normalize(reflect(-L, N));
 
         // calculate d (distance to light)
-        d = distance(gl_LightSource[i].position, position);
+        d = distance(gl_LightSource[i].position.xyz, position);
         // calculate light attenuation
         attenuation = clamp(1.0 / (gl_LightSource[i].constantAttenuation + gl_LightSource[i].linearAttenuation * d + gl_LightSource[i].quadraticAttenuation * d * d), 0.0, 1.0);
 
         // calculate ambient color
-        Iamb = gl_FrontLightProduct[i].ambient;
+        Iamb = gl_LightSource[i].ambient * ambient;
         // calculate diffuse color
-        Idiff = clamp(gl_FrontLightProduct[i].diffuse * max(dot(N, L), 0.0), 0.0, 1.0);
+        Idiff = clamp(gl_LightSource[i].diffuse * diffuse * max(dot(N, L), 0.0), 0.0, 1.0);
         // calculate specular color
-        Ispec = clamp(gl_FrontLightProduct[i].specular * pow(max(dot(R, O), 0.0), gl_FrontMaterial.shininess), 0.0, 1.0);
+        Ispec = clamp(gl_LightSource[i].specular * specular * pow(max(dot(R, O), 0.0), shininess), 0.0, 1.0);
 
         // add to final color all color components multiplied by attenuation
         gl_FragColor += attenuation * (Iamb + Idiff + Ispec);
@@ -1,8 +1,35 @@
-varying vec3 position;
-varying vec3 N;
+#version 140
+#extension GL_ARB_compatibility : enable
+
+in vec2 octahedralNormal;
+in vec4 vertexDecode;
+in float normalEncoding;
+in float materialIndex;
+
+out vec3 position;
+out vec3 N;
+flat out int material;
+
+vec3 decodeNormal() {
+    // octahedral normal (unfold the lower hemisphere)
+    if (normalEncoding == 1.0) {
+        vec3 n = vec3(octahedralNormal, 1.0 - abs(octahedralNormal.x) - abs(octahedralNormal.y));
+        if (n.z < 0.0) {
+            n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        }
+        return n;
+    }
+    // analytic normal (sphere centered at the origin)
+    if (normalEncoding == 2.0) {
+        return gl_Vertex.xyz * vertexDecode.w + vertexDecode.xyz;
+    }
+    return gl_Normal;
+}
 
 void main(void) {
     position = vec3(gl_ModelViewMatrix * gl_Vertex);
-    N = normalize(gl_NormalMatrix * gl_Normal);
-    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+    N = normalize(gl_NormalMatrix * decodeNormal());
+    material = int(materialIndex);
+    // as in the depth pre-pass, which the shading pass tests equal against
+    gl_Position = ftransform();
 }
@@ -0,0 +1,11 @@
+#version 130
+#extension GL_ARB_explicit_attrib_location : require
+
+uniform uint id;
+
+// written to the integer attachment of the picking framebuffer
+layout(location = 0) out uint pickId;
+
+void main(void) {
+    pickId = id;
+}
@@ -0,0 +1,5 @@
+#version 130
+
+void main(void) {
+    gl_Position = ftransform();
+}
@@ -0,0 +1,9 @@
+#version 130
+
+uniform samplerCube sky;
+
+in vec3 direction;
+
+void main(void) {
+    gl_FragColor = texture(sky, direction);
+}
@@ -0,0 +1,19 @@
+#version 130
+
+// from clip space to the world, without the observer's position
+uniform mat4 unproject;
+// radians the sky is turned by around y
+uniform float angle;
+
+out vec3 direction;
+
+void main(void) {
+    // a right triangle with legs twice the screen's width and height covers all of it
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(corner, 1.0, 1.0);
+    vec4 far = unproject * gl_Position;
+    vec3 ray = far.xyz / far.w;
+    // the turned sky seen along a ray is the unturned one along the ray turned back
+    float c = cos(angle), s = sin(angle);
+    direction = vec3(c * ray.x - s * ray.z, ray.y, s * ray.x + c * ray.z);
+}
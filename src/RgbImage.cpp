@@ -20,10 +20,9 @@
 
 #include "RgbImage.h"
 
-#ifndef RGBIMAGE_DONT_USE_OPENGL
-#include <GL/freeGlut.h>
-#include <windows.h>
-#endif
+#include <vector>
+
+#include "bitmaps.hpp"
 
 RgbImage::RgbImage(int numRows, int numCols) {
     NumRows = numRows;
@@ -47,7 +46,9 @@ RgbImage::RgbImage(int numRows, int numCols) {
 
 /* ********************************************************************
  *  LoadBmpFile
- *  Read into memory an RGB image from an uncompressed BMP file.
+ *  Read into memory an RGB image from a BMP file, through Bitmap, which
+ *     maps the file and takes 24 and 32 bit pixels, top down rows and
+ *     8 bit palettes, plain or RLE8 compressed.
  *  Return true for success, false for failure.  Error code is available
  *     with a separate call.
  *  Author: Sam Buss December 2001.
@@ -56,111 +57,20 @@ RgbImage::RgbImage(int numRows, int numCols) {
 bool RgbImage::LoadBmpFile(const char* filename) {
     Reset();
 
-    FILE* infile;
-    if (fopen_s(&infile, filename, "rb")) {
-        fprintf(stderr, "Unable to open file: %s\n", filename);
-        ErrorCode = OpenError;
-        return false;
-    }
-
-    bool fileFormatOK = false;
-    int bChar = fgetc(infile);
-    int mChar = fgetc(infile);
-    if (bChar == 'B' && mChar == 'M') {        // If starts with "BM" for "BitMap"
-        skipChars(infile, 4 + 2 + 2 + 4 + 4);  // Skip 4 fields we don't care about
-        NumCols = readLong(infile);
-        NumRows = readLong(infile);
-        skipChars(infile, 2);  // Skip one field
-        int bitsPerPixel = readShort(infile);
-        skipChars(infile, 4 + 4 + 4 + 4 + 4 + 4);  // Skip 6 more fields
-
-        if (NumCols > 0 && NumCols <= 100000 && NumRows > 0 && NumRows <= 100000 && bitsPerPixel == 24 && !feof(infile)) {
-            fileFormatOK = true;
-        }
-    }
-    if (!fileFormatOK) {
-        Reset();
+    Bitmap bitmap;
+    if (!bitmap.load(filename)) {
         ErrorCode = FileFormatError;
-        fprintf(stderr, "Not a valid 24-bit bitmap file: %s.\n", filename);
-        fclose(infile);
         return false;
     }
+    NumCols = bitmap.getWidth();
+    NumRows = bitmap.getHeight();
 
     // Allocate memory
     ImagePtr = new unsigned char[NumRows * GetNumBytesPerRow()];
-    if (!ImagePtr) {
-        fprintf(stderr, "Unable to allocate memory for %ld x %ld bitmap: %s.\n",
-                NumRows, NumCols, filename);
-        Reset();
-        ErrorCode = MemoryError;
-        fclose(infile);
-        return false;
-    }
-
-    unsigned char* cPtr = ImagePtr;
-    for (int i = 0; i < NumRows; i++) {
-        int j;
-        for (j = 0; j < NumCols; j++) {
-            *(cPtr + 2) = fgetc(infile);  // Blue color value
-            *(cPtr + 1) = fgetc(infile);  // Green color value
-            *cPtr = fgetc(infile);        // Red color value
-            cPtr += 3;
-        }
-        int k = 3 * NumCols;  // Num bytes already read
-        for (; k < GetNumBytesPerRow(); k++) {
-            fgetc(infile);  // Read and ignore padding;
-            *(cPtr++) = 0;
-        }
-    }
-    if (feof(infile)) {
-        fprintf(stderr, "Premature end of file: %s.\n", filename);
-        Reset();
-        ErrorCode = ReadError;
-        fclose(infile);
-        return false;
-    }
-    fclose(infile);  // Close the file
+    bitmap.toRgb(ImagePtr, GetNumBytesPerRow());
     return true;
 }
 
-short RgbImage::readShort(FILE* infile) {
-    // read a 16 bit integer
-    unsigned char lowByte, hiByte;
-    lowByte = fgetc(infile);  // Read the low order byte (little endian form)
-    hiByte = fgetc(infile);   // Read the high order byte
-
-    // Pack together
-    short ret = hiByte;
-    ret <<= 8;
-    ret |= lowByte;
-    return ret;
-}
-
-long RgbImage::readLong(FILE* infile) {
-    // Read in 32 bit integer
-    unsigned char byte0, byte1, byte2, byte3;
-    byte0 = fgetc(infile);  // Read bytes, low order to high order
-    byte1 = fgetc(infile);
-    byte2 = fgetc(infile);
-    byte3 = fgetc(infile);
-
-    // Pack together
-    long ret = byte3;
-    ret <<= 8;
-    ret |= byte2;
-    ret <<= 8;
-    ret |= byte1;
-    ret <<= 8;
-    ret |= byte0;
-    return ret;
-}
-
-void RgbImage::skipChars(FILE* infile, int numChars) {
-    for (int i = 0; i < numChars; i++) {
-        fgetc(infile);
-    }
-}
-
 /* ********************************************************************
  *  WriteBmpFile
  *  Write an RGB image to an uncompressed BMP file.
@@ -170,79 +80,65 @@ void RgbImage::skipChars(FILE* infile, int numChars) {
  **********************************************************************/
 
 bool RgbImage::WriteBmpFile(const char* filename) {
-    errno_t err;
-    FILE* outfile;
-
-    if (fopen_s(&outfile, filename, "wb")) {
+    FILE* outfile = fopen(filename, "wb");
+    if (!outfile) {
         fprintf(stderr, "Unable to open file: %s\n", filename);
         ErrorCode = OpenError;
         return false;
     }
 
-    fputc('B', outfile);
-    fputc('M', outfile);
+    // The whole file is put together in memory and written at once
     int rowLen = GetNumBytesPerRow();
-    writeLong(40 + 14 + NumRows * rowLen, outfile);  // Length of file
-    writeShort(0, outfile);                          // Reserved for future use
-    writeShort(0, outfile);
-    writeLong(40 + 14, outfile);  // Offset to pixel data
-    writeLong(40, outfile);       // header length
-    writeLong(NumCols, outfile);  // width in pixels
-    writeLong(NumRows, outfile);  // height in pixels (pos for bottom up)
-    writeShort(1, outfile);       // number of planes
-    writeShort(24, outfile);      // bits per pixel
-    writeLong(0, outfile);        // no compression
-    writeLong(0, outfile);        // not used if no compression
-    writeLong(0, outfile);        // Pixels per meter
-    writeLong(0, outfile);        // Pixels per meter
-    writeLong(0, outfile);        // unused for 24 bits/pixel
-    writeLong(0, outfile);        // unused for 24 bits/pixel
-
-    // Now write out the pixel data:
-    unsigned char* cPtr = ImagePtr;
+    std::vector<unsigned char> data(54 + NumRows * rowLen);
+    unsigned char* header = data.data();
+    *(header++) = 'B';
+    *(header++) = 'M';
+    writeLong(40 + 14 + NumRows * rowLen, header);  // Length of file
+    writeShort(0, header);                          // Reserved for future use
+    writeShort(0, header);
+    writeLong(40 + 14, header);  // Offset to pixel data
+    writeLong(40, header);       // header length
+    writeLong(NumCols, header);  // width in pixels
+    writeLong(NumRows, header);  // height in pixels (pos for bottom up)
+    writeShort(1, header);       // number of planes
+    writeShort(24, header);      // bits per pixel
+    writeLong(0, header);        // no compression
+    writeLong(0, header);        // not used if no compression
+    writeLong(0, header);        // Pixels per meter
+    writeLong(0, header);        // Pixels per meter
+    writeLong(0, header);        // unused for 24 bits/pixel
+    writeLong(0, header);        // unused for 24 bits/pixel
+
+    // Now the pixel data, rows padded to a word boundary with zeros
     for (int i = 0; i < NumRows; i++) {
-        // Write out i-th row's data
-        int j;
-        for (j = 0; j < NumCols; j++) {
-            fputc(*(cPtr + 2), outfile);  // Blue color value
-            fputc(*(cPtr + 1), outfile);  // Blue color value
-            fputc(*(cPtr + 0), outfile);  // Blue color value
-            cPtr += 3;
-        }
-        // Pad row to word boundary
-        int k = 3 * NumCols;  // Num bytes already read
-        for (; k < GetNumBytesPerRow(); k++) {
-            fputc(0, outfile);  // Read and ignore padding;
-            cPtr++;
+        unsigned char* row = header + i * rowLen;
+        Bitmap::bgrToRgb(ImagePtr + i * rowLen, row, NumCols);
+        for (int k = 3 * NumCols; k < rowLen; k++) {
+            row[k] = 0;
         }
     }
 
-    fclose(outfile);  // Close the file
-    return true;
+    bool written = fwrite(data.data(), 1, data.size(), outfile) == data.size();
+    written = fclose(outfile) == 0 && written;
+    if (!written) {
+        fprintf(stderr, "Unable to write file: %s\n", filename);
+        ErrorCode = WriteError;
+    }
+    return written;
 }
 
-void RgbImage::writeLong(long data, FILE* outfile) {
-    // Read in 32 bit integer
-    unsigned char byte0, byte1, byte2, byte3;
-    byte0 = (unsigned char) (data & 0x000000ff);  // Write bytes, low order to high order
-    byte1 = (unsigned char) ((data >> 8) & 0x000000ff);
-    byte2 = (unsigned char) ((data >> 16) & 0x000000ff);
-    byte3 = (unsigned char) ((data >> 24) & 0x000000ff);
-
-    fputc(byte0, outfile);
-    fputc(byte1, outfile);
-    fputc(byte2, outfile);
-    fputc(byte3, outfile);
+void RgbImage::writeLong(long data, unsigned char*& output) {
+    // Write a 32 bit integer, low order byte first
+    *(output++) = (unsigned char) (data & 0x000000ff);
+    *(output++) = (unsigned char) ((data >> 8) & 0x000000ff);
+    *(output++) = (unsigned char) ((data >> 16) & 0x000000ff);
+    *(output++) = (unsigned char) ((data >> 24) & 0x000000ff);
 }
 
-void RgbImage::writeShort(short data, FILE* outfile) {
-    // Read in 32 bit integer
-    unsigned char byte0, byte1;
-    byte0 = data & 0x000000ff;  // Write bytes, low order to high order
-    byte1 = (data >> 8) & 0x000000ff;
-
-    fputc(byte0, outfile);
-    fputc(byte1, outfile);
+void RgbImage::writeShort(short data, unsigned char*& output) {
+    // Write a 16 bit integer, low order byte first
+    *(output++) = data & 0x000000ff;
+    *(output++) = (data >> 8) & 0x000000ff;
 }
 
 /*********************************************************************
@@ -75,11 +75,8 @@ class RgbImage {
     long NumCols;             // number of columns in image
     int ErrorCode;            // error code
 
-    static short readShort(FILE* infile);
-    static long readLong(FILE* infile);
-    static void skipChars(FILE* infile, int numChars);
-    static void writeLong(long data, FILE* outfile);
-    static void writeShort(short data, FILE* outfile);
+    static void writeLong(long data, unsigned char*& output);
+    static void writeShort(short data, unsigned char*& output);
 
     static unsigned char doubleToUnsignedChar(double x);
 };
@@ -1,5 +1,80 @@
 #include "animations.hpp"
 
+#include <assert.h>
+
+#include <map>
+#include <numeric>
+#include <set>
+
+#include "simd.hpp"
+
+// vectorized easing kernels, every out and in-out easing is built from its in easing
+
+namespace {
+    using namespace Simd;
+
+    Floats linear(Floats t) { return t; }
+    Floats quadraticIn(Floats t) { return mul(t, t); }
+    Floats cubicIn(Floats t) { return mul(mul(t, t), t); }
+    Floats quarticIn(Floats t) {
+        Floats square = mul(t, t);
+        return mul(square, square);
+    }
+    Floats quinticIn(Floats t) { return mul(quarticIn(t), t); }
+    Floats sinusoidalIn(Floats t) {
+        Floats sines, cosines;
+        sinCosLanes(mul(t, set(M_PI_2)), sines, cosines);
+        return sub(set(1), cosines);
+    }
+    Floats exponentialIn(Floats t) { return expLanes(mul(sub(t, set(1)), set(10 * M_LN2))); }
+    Floats circularIn(Floats t) { return sub(set(1), sqrt(max(sub(set(1), mul(t, t)), set(0)))); }
+
+    template <Floats (*in)(Floats)>
+    Floats out(Floats t) { return sub(set(1), in(sub(set(1), t))); }
+
+    template <Floats (*in)(Floats)>
+    Floats inOut(Floats t) {
+        Floats twice = add(t, t);
+        Floats firstHalf = mul(in(twice), set(0.5f));
+        Floats secondHalf = sub(set(1), mul(in(sub(set(2), twice)), set(0.5f)));
+        return select(greater(set(0.5f), t), firstHalf, secondHalf);
+    }
+
+    Floats sinusoidalInOut(Floats t) {
+        Floats sines, cosines;
+        sinCosLanes(mul(t, set(M_PI)), sines, cosines);
+        return mul(sub(set(1), cosines), set(0.5f));
+    }
+
+    const struct {
+        GLfloat (*ease)(GLfloat);
+        Floats (*kernel)(Floats);
+    } kernels[] = {
+        {Ease::linear, linear},
+        {Ease::quadraticIn, quadraticIn},
+        {Ease::quadraticOut, out<quadraticIn>},
+        {Ease::quadraticInOut, inOut<quadraticIn>},
+        {Ease::cubicIn, cubicIn},
+        {Ease::cubicOut, out<cubicIn>},
+        {Ease::cubicInOut, inOut<cubicIn>},
+        {Ease::quarticIn, quarticIn},
+        {Ease::quarticOut, out<quarticIn>},
+        {Ease::quarticInOut, inOut<quarticIn>},
+        {Ease::quinticIn, quinticIn},
+        {Ease::quinticOut, out<quinticIn>},
+        {Ease::quinticInOut, inOut<quinticIn>},
+        {Ease::sinusoidalIn, sinusoidalIn},
+        {Ease::sinusoidalOut, out<sinusoidalIn>},
+        {Ease::sinusoidalInOut, sinusoidalInOut},
+        {Ease::exponentialIn, exponentialIn},
+        {Ease::exponentialOut, out<exponentialIn>},
+        {Ease::exponentialInOut, inOut<exponentialIn>},
+        {Ease::circularIn, circularIn},
+        {Ease::circularOut, out<circularIn>},
+        {Ease::circularInOut, inOut<circularIn>},
+    };
+}
+
 // namespace Ease
 
 GLfloat Ease::linear(GLfloat t) {
@@ -112,26 +187,117 @@ GLfloat Ease::circularInOut(GLfloat t) {
     return (sqrt(1 - t * t) + 1) / 2;
 }
 
+GLfloat Ease::cubicBezier(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2, GLfloat t) {
+    auto bezier = [](GLfloat a, GLfloat b, GLfloat s) { return ((1 + 3 * a - 3 * b) * s + 3 * b - 6 * a) * s * s + 3 * a * s; };
+    // find the curve parameter at which x reaches t, newton steps kept inside a shrinking bracket
+    GLfloat low = 0, high = 1, s = t;
+    for (int i = 0; i < 32; ++i) {
+        GLfloat error = bezier(x1, x2, s) - t;
+        if (std::abs(error) < 1e-7f) break;
+        (error > 0 ? high : low) = s;
+        GLfloat slope = (3 * (1 + 3 * x1 - 3 * x2) * s + 2 * (3 * x2 - 6 * x1)) * s + 3 * x1;
+        s = slope > 1e-6f ? s - error / slope : (low + high) / 2;
+        if (s <= low || s >= high) s = (low + high) / 2;
+    }
+    return bezier(y1, y2, s);
+}
+
+GLfloat Ease::catmullRom(const std::vector<GLfloat> &keys, GLfloat t) {
+    int last = keys.size() - 1;
+    if (last <= 0) return last < 0 ? 0 : keys[0];
+    GLfloat position = std::min(std::max(t, (GLfloat) 0), (GLfloat) 1) * last;
+    int segment = std::min((int) position, last - 1);
+    GLfloat u = position - segment;
+    // the end keys are repeated to give the outer segments their tangents
+    GLfloat p0 = keys[std::max(segment - 1, 0)], p1 = keys[segment], p2 = keys[segment + 1], p3 = keys[std::min(segment + 2, last)];
+    return ((((-p0 + 3 * p1 - 3 * p2 + p3) * u + 2 * p0 - 5 * p1 + 4 * p2 - p3) * u + p2 - p0) * u + 2 * p1) / 2;
+}
+
+void Ease::evaluate(GLfloat (*ease)(GLfloat), const GLfloat *input, GLfloat *output, int count) {
+    auto kernel = std::find_if(std::begin(kernels), std::end(kernels), [ease](auto &kernel) { return kernel.ease == ease; });
+    if (kernel == std::end(kernels)) {
+        std::transform(input, input + count, output, ease);
+        return;
+    }
+    int i = 0;
+    for (; i + lanes <= count; i += lanes) store(output + i, kernel->kernel(load(input + i)));
+    if (i < count) {
+        GLfloat in[lanes] = {0}, out[lanes];
+        std::copy(input + i, input + count, in);
+        store(out, kernel->kernel(load(in)));
+        std::copy(out, out + count - i, output + i);
+    }
+}
+
+int Ease::indexOf(GLfloat (*ease)(GLfloat)) {
+    auto kernel = std::find_if(std::begin(kernels), std::end(kernels), [ease](auto &kernel) { return kernel.ease == ease; });
+    return kernel == std::end(kernels) ? -1 : kernel - std::begin(kernels);
+}
+
+GLfloat (*Ease::byIndex(int index))(GLfloat) {
+    return index >= 0 && index < (int) std::size(kernels) ? kernels[index].ease : nullptr;
+}
+
+// class Curve
+
+Curve::Curve(std::function<GLfloat(GLfloat)> function, int resolution) : samples(resolution + 1) {
+    for (int i = 0; i <= resolution; ++i) samples[i] = function((GLfloat) i / resolution);
+}
+
+std::shared_ptr<const Curve> Curve::fromSamples(std::vector<GLfloat> samples) {
+    assert(samples.size() >= 2);
+    std::shared_ptr<Curve> curve(new Curve());
+    curve->samples = std::move(samples);
+    return curve;
+}
+
+std::shared_ptr<const Curve> Curve::bake(GLfloat (*ease)(GLfloat), int resolution) {
+    return std::make_shared<const Curve>(ease, resolution);
+}
+
+std::shared_ptr<const Curve> Curve::bezier(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2, int resolution) {
+    return std::make_shared<const Curve>([=](GLfloat t) { return Ease::cubicBezier(x1, y1, x2, y2, t); }, resolution);
+}
+
+std::shared_ptr<const Curve> Curve::catmullRom(std::vector<GLfloat> keys, int resolution) {
+    return std::make_shared<const Curve>([keys](GLfloat t) { return Ease::catmullRom(keys, t); }, resolution);
+}
+
+const std::vector<GLfloat> &Curve::getSamples() const { return samples; }
+
+GLfloat Curve::operator()(GLfloat t) const {
+    int resolution = samples.size() - 1;
+    GLfloat position = std::min(std::max(t, (GLfloat) 0), (GLfloat) 1) * resolution;
+    int index = std::min((int) position, resolution - 1);
+    return samples[index] + (samples[index + 1] - samples[index]) * (position - index);
+}
+
+void Curve::evaluate(const GLfloat *input, GLfloat *output, int count) const {
+    for (int i = 0; i < count; ++i) output[i] = (*this)(input[i]);
+}
+
 // class Animation
 
-Animation::Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), std::function<void(GLfloat)> callback)
-    : start(start), duration(duration), time(0), first(first), last(last), started(false), done(false), ease(ease), callback(callback) {}
+Animation::Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, Easing ease, std::function<void(GLfloat)> callback)
+    : start(start), duration(duration), time(0), first(first), last(last), started(false), done(false), ease(ease), callback(callback), target(nullptr), binding(-1) {}
 
-Animation::Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), GLfloat *value)
-    : Animation(start, duration, first, last, ease, [value](GLfloat newValue) { *value = newValue; }) {}
+Animation::Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *value)
+    : Animation(start, duration, first, last, ease, [value](GLfloat newValue) { *value = newValue; }) {
+    target = value;
+}
 
 Animation::Animation(unsigned long start, unsigned long duration, GLfloat fixed, std::function<void(GLfloat)> callback)
     : Animation(
-          start, duration, fixed, fixed, [](GLfloat) { return (GLfloat) 0; }, callback) {}
+          start, duration, fixed, fixed, Ease::linear, callback) {}
 
 Animation::Animation(unsigned long start, unsigned long duration, GLfloat fixed, GLfloat *value)
     : Animation(
-          start, duration, fixed, fixed, [](GLfloat) { return (GLfloat) 0; }, value) {}
+          start, duration, fixed, fixed, Ease::linear, value) {}
 
-Animation::Animation(unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), std::function<void(GLfloat)> callback)
+Animation::Animation(unsigned long duration, GLfloat first, GLfloat last, Easing ease, std::function<void(GLfloat)> callback)
     : Animation(0, duration, first, last, ease, callback) {}
 
-Animation::Animation(unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), GLfloat *value)
+Animation::Animation(unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *value)
     : Animation(0, duration, first, last, ease, value) {}
 
 Animation::Animation(unsigned long duration, GLfloat fixed, std::function<void(GLfloat)> callback)
@@ -140,6 +306,8 @@ Animation::Animation(unsigned long duration, GLfloat fixed, std::function<void(G
 Animation::Animation(unsigned long duration, GLfloat fixed, GLfloat *value)
     : Animation(0, duration, fixed, value) {}
 
+void Animation::setBinding(int binding) { this->binding = binding; }
+
 bool Animation::isDone() { return done; }
 
 void Animation::reset() {
@@ -166,18 +334,190 @@ void Animation::tick(unsigned long delta) {
 // class AnimationGroup
 
 AnimationGroup::AnimationGroup(std::initializer_list<Animation> animations)
-    : done(false), animations(animations) {}
+    : AnimationGroup(std::vector<Animation>(animations)) {}
+
+AnimationGroup::AnimationGroup(const std::vector<Animation> &animations)
+    : time(0), started(false), done(false), cursor(0) {
+    std::vector<int> order(animations.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&animations](int a, int b) { return animations[a].start < animations[b].start; });
+    for (int index : order) {
+        const Animation &animation = animations[index];
+        starts.push_back(animation.start);
+        ends.push_back(animation.start + animation.duration);
+        firsts.push_back(animation.first);
+        lasts.push_back(animation.last);
+        orders.push_back(index);
+        auto ease = std::find(eases.begin(), eases.end(), animation.ease);
+        easings.push_back(ease - eases.begin());
+        if (ease == eases.end()) eases.push_back(animation.ease);
+        targets.push_back(animation.target);
+        bindings.push_back(animation.binding);
+        callbacks.push_back(animation.target ? -1 : functions.size());
+        if (!animation.target) functions.push_back(animation.callback);
+    }
+    values.resize(starts.size());
+    batches.resize(eases.size());
+
+    std::map<GLfloat *, int> channelsByTarget;
+    std::vector<std::vector<int>> tracksByChannel;  // by start time
+    for (size_t track = 0; track < starts.size(); ++track) {
+        int index = tracksByChannel.size();
+        if (targets[track]) index = channelsByTarget.emplace(targets[track], index).first->second;
+        if (index == (int) tracksByChannel.size()) tracksByChannel.emplace_back();
+        tracksByChannel[index].push_back(track);
+    }
+    channels.resize(tracksByChannel.size());
+    for (size_t index = 0; index < channels.size(); ++index) {
+        Channel &channel = channels[index];
+        const std::vector<int> &tracks = tracksByChannel[index];
+        // sweep the starts and ends in order: a track in progress wins over ended ones, the later declared one if
+        // several are, and otherwise the one that ended last, again the later declared one on ties
+        std::vector<int> ending = tracks;
+        std::sort(ending.begin(), ending.end(), [this](int a, int b) { return ends[a] < ends[b]; });
+        for (int track : tracks) channel.times.insert(channel.times.end(), {starts[track], ends[track]});
+        std::sort(channel.times.begin(), channel.times.end());
+        channel.times.erase(std::unique(channel.times.begin(), channel.times.end()), channel.times.end());
+        std::set<std::pair<int, int>> inProgress;  // by order
+        int ended = -1;
+        size_t started = 0, finished = 0;
+        auto winner = [&] { return inProgress.empty() ? ended : inProgress.rbegin()->second; };
+        for (unsigned long time : channel.times) {
+            // tracks are in progress from their start to their end, both included
+            for (; started < tracks.size() && starts[tracks[started]] == time; ++started) inProgress.emplace(orders[tracks[started]], tracks[started]);
+            channel.at.push_back(winner());
+            for (; finished < ending.size() && ends[ending[finished]] == time; ++finished) {
+                int track = ending[finished];
+                inProgress.erase({orders[track], track});
+                if (ended < 0 || ends[track] > ends[ended] || orders[track] > orders[ended]) ended = track;
+            }
+            channel.after.push_back(winner());
+        }
+    }
+    duration = ends.empty() ? 0 : *std::max_element(ends.begin(), ends.end());
+}
+
+GLfloat AnimationGroup::evaluate(int track, double time) const {
+    if (time >= ends[track]) return lasts[track];
+    return firsts[track] + eases[easings[track]]((time - starts[track]) / (ends[track] - starts[track])) * (lasts[track] - firsts[track]);
+}
 
 bool AnimationGroup::isDone() { return done; }
 
 void AnimationGroup::reset() {
-    for_each(animations.begin(), animations.end(), [](Animation &animation) { animation.reset(); });
-    done = false;
+    time = cursor = 0;
+    started = done = false;
+    active.clear();
+    for (auto &batch : batches) batch.clear();
 }
 
 void AnimationGroup::tick(unsigned long delta) {
-    done = accumulate(animations.begin(), animations.end(), true, [delta](bool done, Animation &animation) {
-        animation.tick(delta);
-        return done && animation.isDone();
-    });
+    if (!started) {
+        started = true;
+        delta = 0;
+    }
+    time += delta;
+
+    // start the tracks whose time has come
+    size_t running = active.size();
+    for (; cursor < starts.size() && starts[cursor] <= time; ++cursor) {
+        active.push_back(cursor);
+        batches[easings[cursor]].push_back(cursor);
+    }
+    if (active.size() > running) {
+        auto byOrder = [this](int a, int b) { return orders[a] < orders[b]; };
+        std::sort(active.begin() + running, active.end(), byOrder);
+        std::inplace_merge(active.begin(), active.begin() + running, active.end(), byOrder);
+    }
+
+    // evaluate each easing function over all of its tracks at once
+    bool finished = false;
+    for (size_t easing = 0; easing < batches.size(); ++easing) {
+        const std::vector<int> &batch = batches[easing];
+        progress.resize(batch.size());
+        eased.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            int track = batch[i];
+            unsigned long duration = ends[track] - starts[track];
+            progress[i] = time > ends[track] || !duration ? 1 : (time - starts[track] + 0.) / duration;
+        }
+        eases[easing].evaluate(progress.data(), eased.data(), batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            int track = batch[i];
+            if (time > ends[track]) {
+                values[track] = lasts[track];
+                finished = true;
+            } else {
+                values[track] = firsts[track] + eased[i] * (lasts[track] - firsts[track]);
+            }
+        }
+    }
+
+    for (int track : active) {
+        if (callbacks[track] < 0) {
+            *targets[track] = values[track];
+        } else {
+            functions[callbacks[track]](values[track]);
+        }
+    }
+
+    // tracks past their end have written their last value and are dropped
+    if (finished) {
+        auto ended = [this](int track) { return time > ends[track]; };
+        active.erase(std::remove_if(active.begin(), active.end(), ended), active.end());
+        for (auto &batch : batches) batch.erase(std::remove_if(batch.begin(), batch.end(), ended), batch.end());
+    }
+    done = cursor == starts.size() && active.empty();
+}
+
+void AnimationGroup::sample(double time) {
+    // callbacks may have side effects, so they are called in the order playback would have last called them
+    std::vector<std::pair<double, int>> calls;
+    for (const Channel &channel : channels) {
+        int index = std::upper_bound(channel.times.begin(), channel.times.end(), time) - channel.times.begin() - 1;
+        if (index < 0) continue;
+        int winner = time == channel.times[index] ? channel.at[index] : channel.after[index];
+        if (winner < 0) continue;
+        if (callbacks[winner] < 0) {
+            *targets[winner] = evaluate(winner, time);
+        } else {
+            calls.emplace_back(std::min<double>(time, ends[winner]), winner);
+        }
+    }
+    std::sort(calls.begin(), calls.end(), [this](auto &a, auto &b) { return a.first < b.first || a.first == b.first && orders[a.second] < orders[b.second]; });
+    for (auto [written, track] : calls) functions[callbacks[track]](evaluate(track, time));
+}
+
+unsigned long AnimationGroup::getDuration() { return duration; }
+
+// class Timeline
+
+Timeline::Timeline(Playable *animation) : animation(animation), time(0), scale(1) {}
+
+void Timeline::setAnimation(Playable *animation) {
+    this->animation = animation;
+    time = 0;
 }
+
+double Timeline::getTime() { return time; }
+
+double Timeline::getScale() { return scale; }
+
+void Timeline::setScale(double scale) { this->scale = scale; }
+
+void Timeline::reverse() { scale = -scale; }
+
+void Timeline::seek(double time) {
+    if (!animation) return;
+    this->time = std::min(std::max(time, 0.), (double) animation->getDuration());
+    animation->sample(this->time);
+}
+
+void Timeline::rewind() {
+    if (animation) seek(scale < 0 ? animation->getDuration() : 0);
+}
+
+// without an animation there is nothing left to play
+bool Timeline::isDone() { return !animation || (scale < 0 ? time <= 0 : time >= animation->getDuration()); }
+
+void Timeline::tick(double delta) { seek(time + delta * scale); }
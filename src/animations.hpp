@@ -7,7 +7,7 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
-#include <numeric>
+#include <memory>
 #include <vector>
 
 namespace Ease {
@@ -33,40 +33,156 @@ namespace Ease {
     GLfloat circularIn(GLfloat t);
     GLfloat circularOut(GLfloat t);
     GLfloat circularInOut(GLfloat t);
+    // the timing curve css calls cubic-bezier, from (0, 0) to (1, 1) with two control points
+    GLfloat cubicBezier(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2, GLfloat t);
+    // a uniform catmull-rom spline through keyframes spaced evenly over [0, 1]
+    GLfloat catmullRom(const std::vector<GLfloat> &keys, GLfloat t);
+    // any of the functions above over a batch of parameters, vectorized where a kernel exists
+    void evaluate(GLfloat (*ease)(GLfloat), const GLfloat *input, GLfloat *output, int count);
+    // the easings from linear to circularInOut are numbered in order, which compiled animations rely on
+    int indexOf(GLfloat (*ease)(GLfloat));  // -1 for any other function
+    GLfloat (*byIndex(int index))(GLfloat);
 }
 
+// a curve baked into evenly spaced samples over [0, 1] and read back with linear interpolation
+class Curve {
+    private:
+    std::vector<GLfloat> samples;
+    Curve() {}
+
+    public:
+    Curve(std::function<GLfloat(GLfloat)> function, int resolution = 256);
+    static std::shared_ptr<const Curve> fromSamples(std::vector<GLfloat> samples);
+    static std::shared_ptr<const Curve> bake(GLfloat (*ease)(GLfloat), int resolution = 256);
+    static std::shared_ptr<const Curve> bezier(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2, int resolution = 256);
+    static std::shared_ptr<const Curve> catmullRom(std::vector<GLfloat> keys, int resolution = 256);
+    const std::vector<GLfloat> &getSamples() const;
+    GLfloat operator()(GLfloat t) const;
+    void evaluate(const GLfloat *input, GLfloat *output, int count) const;
+};
+
+// what a track eases with, a function or a baked curve
+struct Easing {
+    GLfloat (*function)(GLfloat);
+    std::shared_ptr<const Curve> curve;
+
+    Easing(GLfloat (*function)(GLfloat)) : function(function) {}
+    Easing(std::shared_ptr<const Curve> curve) : function(nullptr), curve(curve) {}
+
+    GLfloat operator()(GLfloat t) const { return curve ? (*curve)(t) : function(t); }
+    bool operator==(const Easing &other) const { return function == other.function && curve == other.curve; }
+    void evaluate(const GLfloat *input, GLfloat *output, int count) const {
+        if (curve) {
+            curve->evaluate(input, output, count);
+        } else {
+            Ease::evaluate(function, input, output, count);
+        }
+    }
+};
+
 class Animation {
     private:
     unsigned long start, duration, time;
     GLfloat first, last;
     bool started, done;
-    GLfloat (*ease)(GLfloat);
+    Easing ease;
     std::function<void(GLfloat)> callback;
+    GLfloat *target;  // set when the callback only writes to a value
+    int binding;      // the binding it was made from, -1 if none
+    friend class AnimationGroup;
 
     public:
-    Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), std::function<void(GLfloat)> callback);
-    Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), GLfloat *value);
+    Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, Easing ease, std::function<void(GLfloat)> callback);
+    Animation(unsigned long start, unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *value);
     Animation(unsigned long start, unsigned long duration, GLfloat fixed, std::function<void(GLfloat)> callback);
     Animation(unsigned long start, unsigned long duration, GLfloat fixed, GLfloat *value);
-    Animation(unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), std::function<void(GLfloat)> callback);
-    Animation(unsigned long duration, GLfloat first, GLfloat last, GLfloat (*ease)(GLfloat), GLfloat *value);
+    Animation(unsigned long duration, GLfloat first, GLfloat last, Easing ease, std::function<void(GLfloat)> callback);
+    Animation(unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *value);
     Animation(unsigned long duration, GLfloat fixed, std::function<void(GLfloat)> callback);
     Animation(unsigned long duration, GLfloat fixed, GLfloat *value);
+    // the index of the binding it writes, among the ones a clip of it will be compiled with
+    void setBinding(int binding);
     bool isDone();
     void reset();
     void tick(unsigned long delta);
 };
 
-class AnimationGroup {
+// anything a timeline can play by sampling
+class Playable {
+    public:
+    virtual ~Playable() {}
+    // sets every value to what playing up to a time would leave it at, regardless of what was played before
+    virtual void sample(double time) = 0;
+    virtual unsigned long getDuration() = 0;
+};
+
+class Sequence;
+
+// plays animations as tracks in structure of arrays form, only visiting the ones in progress
+class AnimationGroup : public Playable {
     private:
-    bool done;
-    std::vector<Animation> animations;
+    // tracks, sorted by start time
+    std::vector<unsigned long> starts, ends;
+    std::vector<GLfloat> firsts, lasts, values;
+    std::vector<int> orders;     // position in the initializer list
+    std::vector<int> easings;    // index into eases
+    std::vector<int> callbacks;  // index into functions, -1 for tracks written straight to their target
+    std::vector<GLfloat *> targets;
+    std::vector<int> bindings;   // index into the bindings the tracks were made from, -1 for ones that weren't
+    std::vector<Easing> eases;
+    std::vector<std::function<void(GLfloat)>> functions;
+    // playback
+    unsigned long time;
+    bool started, done;
+    size_t cursor;                          // first track not started yet
+    std::vector<int> active;                // tracks in progress, by order so later ones win on a shared target
+    std::vector<std::vector<int>> batches;  // tracks in progress, by easing
+    std::vector<GLfloat> progress, eased;   // of a batch
+    // sampling, by the value tracks write to (every callback track is a channel of its own): the track that decides
+    // the value at each start or end and up to the next one, so only one of them is ever looked at
+    struct Channel {
+        std::vector<unsigned long> times;  // every start and end, once each
+        std::vector<int> at, after;        // the winning track, -1 before any started
+    };
+    std::vector<Channel> channels;
+    unsigned long duration;
+    GLfloat evaluate(int track, double time) const;
+    friend class AnimationClip;
+    friend Sequence play(const AnimationGroup &group);
 
     public:
     AnimationGroup(std::initializer_list<Animation> animations);
+    AnimationGroup(const std::vector<Animation> &animations);
     bool isDone();
     void reset();
     void tick(unsigned long delta);
+    // each channel costs a binary search
+    void sample(double time);
+    unsigned long getDuration();
+};
+
+// plays an animation by sampling it, so it can be seeked, reversed and sped up
+class Timeline {
+    private:
+    Playable *animation;
+    double time, scale;
+
+    public:
+    // without an animation, seeking and ticking do nothing and it is always done
+    Timeline(Playable *animation = nullptr);
+    // switches animations, rewinding without sampling
+    void setAnimation(Playable *animation);
+    double getTime();
+    double getScale();
+    // negative scales play backwards
+    void setScale(double scale);
+    void reverse();
+    void seek(double time);
+    // seeks to where playing in the current direction starts
+    void rewind();
+    // whether playing in the current direction reached its end
+    bool isDone();
+    void tick(double delta);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "benchmarks.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include "vertices.hpp"
+
+// class Benchmark
+
+const char *Benchmark::metrics[] = {"cpu_ms", "gpu_ms", "draw_calls", "triangles"};
+
+Benchmark::Benchmark() : queries{0}, timed(false) {}
+
+Benchmark::~Benchmark() {
+    if (timed) glDeleteQueries(latency, queries);
+}
+
+void Benchmark::initialize() {
+    // without timer queries, gpu times are left at zero
+    timed = GLEW_ARB_timer_query;
+    if (timed) glGenQueries(latency, queries);
+}
+
+void Benchmark::collect(size_t frame) {
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(queries[frame % latency], GL_QUERY_RESULT, &elapsed);
+    samples[frame].gpuTime = elapsed / 1e6;
+}
+
+void Benchmark::begin() {
+    size_t frame = samples.size();
+    if (timed) {
+        // the query about to be reused belongs to a frame far enough back to be done by now
+        if (frame >= latency) collect(frame - latency);
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame % latency]);
+    }
+    VertexArray::drawCalls = VertexArray::triangles = 0;
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void Benchmark::end() {
+    double cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    if (timed) glEndQuery(GL_TIME_ELAPSED);
+    samples.push_back({cpuTime, 0, VertexArray::drawCalls, VertexArray::triangles});
+}
+
+void Benchmark::finish() {
+    if (!timed) return;
+    for (size_t frame = samples.size() > latency ? samples.size() - latency : 0; frame < samples.size(); ++frame) collect(frame);
+}
+
+const std::vector<FrameSample> &Benchmark::getSamples() const { return samples; }
+
+std::vector<double> Benchmark::values(int metric) const {
+    std::vector<double> values(samples.size());
+    std::transform(samples.begin(), samples.end(), values.begin(), [metric](const FrameSample &sample) {
+        return metric == 0 ? sample.cpuTime : metric == 1 ? sample.gpuTime : metric == 2 ? sample.drawCalls : sample.triangles;
+    });
+    return values;
+}
+
+Summary Benchmark::summarize(std::vector<double> values) {
+    if (values.empty()) return {0, 0, 0, 0, 0};
+    std::sort(values.begin(), values.end());
+    // nearest rank
+    auto percentile = [&values](double rank) { return values[std::max((size_t) std::ceil(rank / 100 * values.size()), (size_t) 1) - 1]; };
+    return {std::accumulate(values.begin(), values.end(), 0.) / values.size(), percentile(50), percentile(95), percentile(99), values.back()};
+}
+
+std::map<std::string, Summary> Benchmark::summarize() const {
+    std::map<std::string, Summary> summaries;
+    for (int metric = 0; metric < 4; ++metric) summaries[metrics[metric]] = summarize(values(metric));
+    return summaries;
+}
+
+void Benchmark::print(std::ostream &stream) const {
+    stream << samples.size() << " frames" << std::endl
+           << std::left << std::setw(12) << "metric" << std::right;
+    for (const char *statistic : {"mean", "p50", "p95", "p99", "max"}) stream << std::setw(12) << statistic;
+    stream << std::endl;
+    for (auto &[metric, summary] : summarize()) {
+        stream << std::left << std::setw(12) << metric << std::right << std::fixed << std::setprecision(3);
+        for (double value : {summary.mean, summary.p50, summary.p95, summary.p99, summary.max}) stream << std::setw(12) << value;
+        stream << std::endl;
+    }
+}
+
+bool Benchmark::saveReport(std::string path, std::map<std::string, std::string> details) const {
+    std::ofstream file(path);
+    file << "{" << std::endl;
+    for (auto &[key, value] : details) file << "    \"" << key << "\": \"" << value << "\"," << std::endl;
+    file << "    \"frames\": " << samples.size();
+    file << std::setprecision(6) << std::fixed;
+    for (auto &[metric, summary] : summarize()) {
+        file << "," << std::endl
+             << "    \"" << metric << "\": {\"mean\": " << summary.mean << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99
+             << ", \"max\": " << summary.max << "}";
+    }
+    file << std::endl << "}" << std::endl;
+    return file.good();
+}
+
+bool Benchmark::saveFrames(std::string path) const {
+    std::ofstream file(path);
+    file << "frame,cpu_ms,gpu_ms,draw_calls,triangles" << std::endl << std::setprecision(6) << std::fixed;
+    for (size_t frame = 0; frame < samples.size(); ++frame) {
+        const FrameSample &sample = samples[frame];
+        file << frame << "," << sample.cpuTime << "," << sample.gpuTime << "," << sample.drawCalls << "," << sample.triangles << std::endl;
+    }
+    return file.good();
+}
+
+bool Benchmark::compare(std::string baselinePath, double tolerance, std::ostream &stream) const {
+    std::ostringstream contents;
+    contents << std::ifstream(baselinePath).rdbuf();
+    std::string baseline = contents.str();
+    if (baseline.empty()) {
+        stream << "couldn't read baseline " << baselinePath << std::endl;
+        return false;
+    }
+
+    // reads back only what saveReport writes, a statistic being the first number after its key
+    auto read = [&baseline](std::string metric, std::string statistic, double &value) {
+        size_t position = baseline.find("\"" + metric + "\"");
+        if (position == std::string::npos) return false;
+        position = baseline.find("\"" + statistic + "\":", position);
+        if (position == std::string::npos) return false;
+        value = std::strtod(baseline.c_str() + position + statistic.size() + 3, nullptr);
+        return true;
+    };
+
+    // maxima are single frames and too noisy to fail on, they are only shown
+    bool passed = true;
+    stream << std::left << std::setw(12) << "metric" << std::setw(8) << "stat" << std::right << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(11) << "change" << std::endl;
+    for (auto &[metric, summary] : summarize()) {
+        std::pair<const char *, double> statistics[] = {{"mean", summary.mean}, {"p50", summary.p50}, {"p95", summary.p95}, {"p99", summary.p99}, {"max", summary.max}};
+        for (auto [statistic, current] : statistics) {
+            double previous;
+            if (!read(metric, statistic, previous)) continue;
+            double change = previous != 0 ? (current - previous) / previous : 0;
+            bool regressed = std::strcmp(statistic, "max") != 0 && change > tolerance;
+            passed = passed && !regressed;
+            stream << std::left << std::setw(12) << metric << std::setw(8) << statistic << std::right << std::fixed << std::setprecision(3) << std::setw(14) << previous << std::setw(14) << current
+                   << std::setw(10) << std::showpos << change * 100 << std::noshowpos << "%" << (regressed ? "  regression" : "") << std::endl;
+        }
+    }
+    return passed;
+}
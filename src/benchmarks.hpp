@@ -0,0 +1,55 @@
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+// what one frame cost, cpu and gpu times in milliseconds
+struct FrameSample {
+    double cpuTime, gpuTime;
+    unsigned long drawCalls, triangles;
+};
+
+struct Summary {
+    double mean, p50, p95, p99, max;
+};
+
+// measures frames between begin and end, timing the gpu with queries read a few frames late so measuring never
+// stalls the pipeline it measures
+class Benchmark {
+    private:
+    static const int latency = 4;  // frames in flight before a query is waited on
+    static const char *metrics[];
+    GLuint queries[latency];
+    bool timed;
+    std::vector<FrameSample> samples;
+    std::chrono::steady_clock::time_point frameStart;
+    void collect(size_t frame);
+    std::vector<double> values(int metric) const;
+
+    public:
+    Benchmark();
+    ~Benchmark();
+    void initialize();
+    void begin();
+    void end();
+    // waits for the frames still in flight
+    void finish();
+    const std::vector<FrameSample> &getSamples() const;
+    static Summary summarize(std::vector<double> values);
+    std::map<std::string, Summary> summarize() const;
+    void print(std::ostream &stream) const;
+    // the summary as json, and every frame as csv
+    bool saveReport(std::string path, std::map<std::string, std::string> details) const;
+    bool saveFrames(std::string path) const;
+    // prints how every statistic moved against a report saved before, false if any grew by more than the tolerance
+    bool compare(std::string baselinePath, double tolerance, std::ostream &stream) const;
+};
+
+#endif
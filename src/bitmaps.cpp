@@ -0,0 +1,242 @@
+#include "bitmaps.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "files.hpp"
+#include "maths.hpp"
+
+namespace {
+    // bmp fields are little endian and not necessarily aligned
+    template <typename T>
+    T read(const unsigned char *data, size_t offset) {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    enum Compression {
+        None = 0,
+        Rle8 = 1,
+        BitFields = 3
+    };
+}
+
+// class Bitmap
+
+Bitmap::Bitmap() : pixels(nullptr), width(0), height(0), stride(0), format(GL_RGB), alpha(false) {}
+
+bool Bitmap::load(std::string path) {
+    size_t size = 0;
+    file = Files::map(path, size);
+    decoded.clear();
+    pixels = nullptr;
+    auto fail = [this, &path](std::string reason) {
+        std::cerr << path << " " << reason << std::endl;
+        file.reset();
+        decoded.clear();
+        pixels = nullptr;
+        return false;
+    };
+    if (!file) return fail("couldn't be opened");
+    const unsigned char *data = (const unsigned char *) file.get();
+    if (size < 54 || data[0] != 'B' || data[1] != 'M') return fail("isn't a bmp file");
+    uint32_t offset = read<uint32_t>(data, 10), headerSize = read<uint32_t>(data, 14), compression = read<uint32_t>(data, 30);
+    int32_t fileWidth = read<int32_t>(data, 18), fileHeight = read<int32_t>(data, 22);
+    int bitsPerPixel = read<uint16_t>(data, 28);
+    if (headerSize < 40 || headerSize > size - 14) return fail("has an unsupported header");
+    if (fileWidth <= 0 || fileWidth > 65536 || fileHeight == 0 || std::abs(fileHeight) > 65536) return fail("has an invalid size");
+    // a negative height is a bitmap stored top down
+    bool topDown = fileHeight < 0;
+    width = fileWidth;
+    height = std::abs(fileHeight);
+    alpha = false;
+    if (offset > size) return fail("ends early");
+
+    if (bitsPerPixel == 8 && (compression == None || compression == Rle8)) {
+        if (!decodePalette(data, size, offset, headerSize, compression, topDown)) return fail("has a palette or pixels that don't fit in it");
+        return true;
+    }
+    if (bitsPerPixel == 32 && compression == BitFields) {
+        // only the layout of plain 32 bit pixels, with or without alpha
+        if (size < 70) return fail("ends early");
+        uint32_t alphaMask = headerSize >= 56 ? read<uint32_t>(data, 66) : 0;
+        if (read<uint32_t>(data, 54) != 0xff0000 || read<uint32_t>(data, 58) != 0xff00 || read<uint32_t>(data, 62) != 0xff || alphaMask != 0 && alphaMask != 0xff000000) {
+            return fail("has an unsupported channel layout");
+        }
+        alpha = alphaMask != 0;
+    } else if (bitsPerPixel != 24 && bitsPerPixel != 32 || compression != None) {
+        return fail("has " + std::to_string(bitsPerPixel) + " bit pixels with an unsupported compression");
+    }
+    int channels = bitsPerPixel / 8;
+    stride = (width * channels + 3) / 4 * 4;
+    if ((size - offset) / stride < (size_t) height) return fail("ends early");
+    const unsigned char *rows = data + offset;
+    if (!topDown) {
+        pixels = rows;
+        format = channels == 3 ? GL_BGR : GL_BGRA;
+        return true;
+    }
+
+    // top down rows are flipped into gl's order, and converted on the way
+    int outputStride = width * channels;
+    decoded.resize((size_t) outputStride * height);
+    for (int row = 0; row < height; ++row) {
+        const unsigned char *input = rows + (size_t) (height - 1 - row) * stride;
+        unsigned char *output = decoded.data() + (size_t) row * outputStride;
+        if (channels == 3) {
+            bgrToRgb(input, output, width);
+        } else {
+            bgraToRgba(input, output, width, !alpha);
+        }
+    }
+    file.reset();
+    pixels = decoded.data();
+    stride = outputStride;
+    format = channels == 3 ? GL_RGB : GL_RGBA;
+    return true;
+}
+
+bool Bitmap::decodePalette(const unsigned char *data, size_t size, int offset, int headerSize, int compression, bool topDown) {
+    uint32_t colorsUsed = read<uint32_t>(data, 46);
+    int colors = colorsUsed == 0 || colorsUsed > 256 ? 256 : colorsUsed;
+    size_t paletteOffset = 14 + headerSize;
+    // rle8 is only ever bottom up
+    if (paletteOffset + colors * 4 > size || compression == Rle8 && topDown) return false;
+    unsigned char palette[256 * 3] = {};
+    for (int i = 0; i < colors; ++i) bgrToRgb(data + paletteOffset + i * 4, palette + i * 3, 1);
+
+    // pixels rle8 skips over keep the first color
+    std::vector<unsigned char> indices((size_t) width * height, 0);
+    if (compression == None) {
+        int fileStride = (width + 3) / 4 * 4;
+        if ((size - offset) / fileStride < (size_t) height) return false;
+        for (int row = 0; row < height; ++row) {
+            std::memcpy(&indices[(size_t) row * width], data + offset + (size_t) (topDown ? height - 1 - row : row) * fileStride, width);
+        }
+    } else {
+        // pairs of a count and an index, or of a zero and an escape: 0 ends a line, 1 the bitmap, 2 moves by the next
+        // two bytes and anything else is that many literal indices, padded to an even count
+        const unsigned char *input = data + offset, *end = data + size;
+        int x = 0, y = 0;
+        while (end - input >= 2 && y < height) {
+            int count = input[0], value = input[1];
+            input += 2;
+            if (count > 0) {
+                for (int i = 0; i < count && x < width; ++i) indices[(size_t) y * width + x++] = value;
+            } else if (value == 0) {
+                x = 0;
+                ++y;
+            } else if (value == 1) {
+                break;
+            } else if (value == 2) {
+                if (end - input < 2) return false;
+                x += input[0];
+                y += input[1];
+                input += 2;
+            } else {
+                if (end - input < value) return false;
+                for (int i = 0; i < value && x < width; ++i) indices[(size_t) y * width + x++] = input[i];
+                input += value + (value & 1);
+            }
+        }
+    }
+
+    decoded.resize((size_t) width * height * 3);
+    for (size_t i = 0; i < indices.size(); ++i) std::memcpy(&decoded[i * 3], palette + indices[i] * 3, 3);
+    file.reset();
+    pixels = decoded.data();
+    stride = width * 3;
+    format = GL_RGB;
+    return true;
+}
+
+GLint Bitmap::getWidth() const { return width; }
+
+GLint Bitmap::getHeight() const { return height; }
+
+GLenum Bitmap::getFormat() const { return format; }
+
+bool Bitmap::hasAlpha() const { return alpha; }
+
+const unsigned char *Bitmap::getPixels() const { return pixels; }
+
+GLint Bitmap::getStride() const { return stride; }
+
+bool Bitmap::isMapped() const { return file != nullptr; }
+
+void Bitmap::toRgb(unsigned char *output, int outputStride) const {
+    for (int row = 0; row < height; ++row) {
+        const unsigned char *input = pixels + (size_t) row * stride;
+        unsigned char *line = output + (size_t) row * outputStride;
+        if (format == GL_RGB) {
+            std::memcpy(line, input, width * 3);
+        } else if (format == GL_BGR) {
+            bgrToRgb(input, line, width);
+        } else {
+            bool swapped = format == GL_BGRA;
+            for (int column = 0; column < width; ++column) {
+                line[column * 3] = input[column * 4 + (swapped ? 2 : 0)];
+                line[column * 3 + 1] = input[column * 4 + 1];
+                line[column * 3 + 2] = input[column * 4 + (swapped ? 0 : 2)];
+            }
+        }
+        std::fill(line + width * 3, line + outputStride, 0);
+    }
+}
+
+void Bitmap::upload(GLenum target, GLint level) const {
+    // mapped rows are padded to four bytes, decoded ones are packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, stride % 4 == 0 ? 4 : 1);
+    glTexImage2D(target, level, alpha ? GL_RGBA8 : GL_RGB8, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Bitmap::bgrToRgb(const unsigned char *input, unsigned char *output, int count) {
+    int i = 0;
+#ifdef __SSSE3__
+    // five pixels a shuffle, which also writes the first byte of the next pixel, rewritten by the following one; six
+    // pixels must be left so the load stays inside the row
+    const __m128i order = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+    for (; i + 6 <= count; i += 5) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (input + i * 3));
+        _mm_storeu_si128((__m128i *) (output + i * 3), _mm_shuffle_epi8(bytes, order));
+    }
+#endif
+    for (; i < count; ++i) {
+        output[i * 3] = input[i * 3 + 2];
+        output[i * 3 + 1] = input[i * 3 + 1];
+        output[i * 3 + 2] = input[i * 3];
+    }
+}
+
+void Bitmap::bgraToRgba(const unsigned char *input, unsigned char *output, int count, bool opaque) {
+    int i = 0;
+#ifdef MATHS_SSE
+    const __m128i filled = _mm_set1_epi32(opaque ? 0xff000000 : 0);
+#ifdef __SSSE3__
+    const __m128i order = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    for (; i + 4 <= count; i += 4) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (input + i * 4));
+        _mm_storeu_si128((__m128i *) (output + i * 4), _mm_or_si128(_mm_shuffle_epi8(bytes, order), filled));
+    }
+#else
+    // blue and red trade places within each 32 bit pixel
+    const __m128i kept = _mm_set1_epi32(0xff00ff00), low = _mm_set1_epi32(0xff);
+    for (; i + 4 <= count; i += 4) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (input + i * 4));
+        __m128i swapped = _mm_or_si128(_mm_and_si128(bytes, kept), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(bytes, 16), low), _mm_slli_epi32(_mm_and_si128(bytes, low), 16)));
+        _mm_storeu_si128((__m128i *) (output + i * 4), _mm_or_si128(swapped, filled));
+    }
+#endif
+#endif
+    for (; i < count; ++i) {
+        output[i * 4] = input[i * 4 + 2];
+        output[i * 4 + 1] = input[i * 4 + 1];
+        output[i * 4 + 2] = input[i * 4];
+        output[i * 4 + 3] = opaque ? 255 : input[i * 4 + 3];
+    }
+}
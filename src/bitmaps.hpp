@@ -0,0 +1,48 @@
+#ifndef BITMAPS_HPP
+#define BITMAPS_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// a bmp file read from a mapping of it: 24 and 32 bit pixels, bottom up or top down, and 8 bit palettes, plain or
+// rle8 compressed; bottom up 24 and 32 bit pixels are what gl takes as bgr and bgra, so those are handed to it straight
+// from the mapping, anything else is decoded into rgb or rgba rows, bottom up like gl's
+class Bitmap {
+    private:
+    std::shared_ptr<const char> file;
+    std::vector<unsigned char> decoded;
+    const unsigned char *pixels;
+    GLint width, height, stride;  // stride in bytes
+    GLenum format;
+    bool alpha;
+    bool decodePalette(const unsigned char *data, size_t size, int offset, int headerSize, int compression, bool topDown);
+
+    public:
+    Bitmap();
+    // reports what is wrong with the file to std::cerr
+    bool load(std::string path);
+    GLint getWidth() const;
+    GLint getHeight() const;
+    // GL_BGR or GL_BGRA while the pixels are in the mapping, GL_RGB or GL_RGBA once decoded
+    GLenum getFormat() const;
+    bool hasAlpha() const;
+    // rows bottom up, stride bytes apart
+    const unsigned char *getPixels() const;
+    GLint getStride() const;
+    // whether the pixels are used from the file as they are, with no copy
+    bool isMapped() const;
+    // writes the pixels as rgb rows of the given length in bytes, bottom up
+    void toRgb(unsigned char *output, int outputStride) const;
+    // specifies a level of the texture bound to the target, leaving the unpack state as gl's defaults
+    void upload(GLenum target, GLint level = 0) const;
+    static void bgrToRgb(const unsigned char *input, unsigned char *output, int count);
+    // fills in an opaque alpha when asked to, for pixels whose fourth byte is padding
+    static void bgraToRgba(const unsigned char *input, unsigned char *output, int count, bool opaque);
+};
+
+#endif
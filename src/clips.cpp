@@ -0,0 +1,240 @@
+#include "clips.hpp"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "files.hpp"
+
+// class AnimationClip
+
+AnimationClip::AnimationClip() : size(0), header(nullptr), channels(nullptr), curveRanges(nullptr), segments(nullptr), samples(nullptr), names(nullptr) {}
+
+bool AnimationClip::compile(const AnimationGroup &group, const std::vector<Binding> &bindings) {
+    // find what every track writes to, which a callback can only say through the binding it was made from
+    std::vector<std::vector<int>> tracksByBinding(bindings.size());
+    for (size_t track = 0; track < group.starts.size(); ++track) {
+        int binding = group.bindings[track];
+        if (binding < 0 && group.targets[track]) {
+            binding = std::find_if(bindings.begin(), bindings.end(), [&](const Binding &binding) { return binding.value == group.targets[track]; }) - bindings.begin();
+        }
+        if (binding < 0 || binding >= (int) bindings.size()) return false;
+        tracksByBinding[binding].push_back(track);
+    }
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (bindings[i].name == bindings[j].name) return false;
+        }
+    }
+
+    std::vector<Channel> channelRecords;
+    std::vector<CurveRange> curveRecords;
+    std::vector<Segment> segmentRecords;
+    std::vector<float> sampleRecords;
+    std::string nameRecords;
+    std::map<const ::Curve *, int32_t> curveIndices;
+    auto easingOf = [&](const Easing &easing) -> int32_t {
+        int index = easing.curve ? -1 : Ease::indexOf(easing.function);
+        if (index >= 0) return index;
+        // curves, and functions that are not one of the named easings, are stored as samples
+        std::shared_ptr<const ::Curve> curve = easing.curve ? easing.curve : ::Curve::bake(easing.function);
+        auto found = curveIndices.find(curve.get());
+        if (found != curveIndices.end()) return found->second;
+        const std::vector<GLfloat> &curveSamples = curve->getSamples();
+        curveRecords.push_back({(uint32_t) sampleRecords.size(), (uint32_t) curveSamples.size()});
+        sampleRecords.insert(sampleRecords.end(), curveSamples.begin(), curveSamples.end());
+        return curveIndices[curve.get()] = -(int32_t) curveRecords.size();
+    };
+
+    uint32_t duration = 0;
+    for (size_t binding = 0; binding < bindings.size(); ++binding) {
+        const std::vector<int> &tracks = tracksByBinding[binding];
+        if (tracks.empty()) continue;
+        Channel channel = {(uint32_t) nameRecords.size(), (uint32_t) bindings[binding].name.size(), (uint32_t) segmentRecords.size(), 0};
+        nameRecords += bindings[binding].name;
+
+        std::vector<unsigned long> times;
+        for (int track : tracks) {
+            times.push_back(group.starts[track]);
+            times.push_back(group.ends[track]);
+        }
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+        duration = std::max(duration, (uint32_t) times.back());
+
+        // between two consecutive starts or ends the same track decides the value, the way AnimationGroup::sample picks it,
+        // and after the last one a hold takes over unless the last piece already ends on its value
+        for (size_t i = 0; i < times.size(); ++i) {
+            bool after = i + 1 == times.size();
+            double middle = after ? times[i] + 1 : (times[i] + times[i + 1]) / 2.;
+            int winner = -1;
+            bool inProgress = false;
+            for (int track : tracks) {
+                if (group.starts[track] > middle) continue;
+                bool trackInProgress = group.ends[track] >= middle;
+                if (winner < 0 || trackInProgress && !inProgress) {
+                    winner = track;
+                    inProgress = trackInProgress;
+                } else if (trackInProgress == inProgress) {
+                    bool later = inProgress ? false : group.ends[track] > group.ends[winner];
+                    bool tied = inProgress || group.ends[track] == group.ends[winner];
+                    if (later || tied && group.orders[track] > group.orders[winner]) winner = track;
+                }
+            }
+            if (winner < 0 || after && channel.segmentCount > 0 && segmentRecords.back().last == group.lasts[winner]) continue;
+
+            Segment segment = {(uint32_t) times[i], (uint32_t) (after ? times[i] : times[i + 1]), (uint32_t) group.starts[winner], (uint32_t) group.ends[winner], group.lasts[winner], group.lasts[winner], 0};
+            if (inProgress && group.firsts[winner] != group.lasts[winner]) {
+                segment.first = group.firsts[winner];
+                segment.easing = easingOf(group.eases[group.easings[winner]]);
+            } else {
+                // a hold, by itself or after its animation ended
+                segment.animationStart = segment.start;
+                segment.animationEnd = segment.end;
+            }
+
+            // merge with the previous piece when it is the same animation or holds the same value
+            if (channel.segmentCount > 0) {
+                Segment &previous = segmentRecords.back();
+                bool constant = segment.first == segment.last, previousConstant = previous.first == previous.last;
+                bool sameHold = constant && previousConstant && previous.last == segment.last;
+                bool sameAnimation = !constant && !previousConstant && previous.animationStart == segment.animationStart && previous.animationEnd == segment.animationEnd &&
+                                     previous.first == segment.first && previous.last == segment.last && previous.easing == segment.easing;
+                if (previous.end == segment.start && (sameHold || sameAnimation)) {
+                    previous.end = segment.end;
+                    if (sameHold) previous.animationEnd = segment.end;
+                    continue;
+                }
+            }
+            segmentRecords.push_back(segment);
+            ++channel.segmentCount;
+        }
+        channelRecords.push_back(channel);
+    }
+
+    // lay everything out the way it is stored on disk
+    Header fileHeader = {{'A', 'N', 'I', 'M'}, version, duration, (uint32_t) channelRecords.size(), (uint32_t) segmentRecords.size(), (uint32_t) curveRecords.size(), (uint32_t) sampleRecords.size(), (uint32_t) nameRecords.size()};
+    size_t bytes = sizeof(Header) + channelRecords.size() * sizeof(Channel) + curveRecords.size() * sizeof(CurveRange) + segmentRecords.size() * sizeof(Segment) + sampleRecords.size() * sizeof(float) + nameRecords.size();
+    char *buffer = new char[bytes];
+    char *cursor = buffer;
+    auto write = [&cursor](const void *source, size_t length) {
+        if (length) std::memcpy(cursor, source, length);
+        cursor += length;
+    };
+    write(&fileHeader, sizeof fileHeader);
+    write(channelRecords.data(), channelRecords.size() * sizeof(Channel));
+    write(curveRecords.data(), curveRecords.size() * sizeof(CurveRange));
+    write(segmentRecords.data(), segmentRecords.size() * sizeof(Segment));
+    write(sampleRecords.data(), sampleRecords.size() * sizeof(float));
+    write(nameRecords.data(), nameRecords.size());
+    bool attached = attach(std::shared_ptr<const char>(buffer, std::default_delete<const char[]>()), bytes);
+    assert(attached);
+    bind(bindings);
+    return true;
+}
+
+bool AnimationClip::attach(std::shared_ptr<const char> data, size_t size) {
+    if (size < sizeof(Header)) return false;
+    const Header *header = (const Header *) data.get();
+    if (std::memcmp(header->magic, "ANIM", 4) != 0 || header->version != version) return false;
+    size_t expected = sizeof(Header) + (size_t) header->channelCount * sizeof(Channel) + (size_t) header->curveCount * sizeof(CurveRange) +
+                      (size_t) header->segmentCount * sizeof(Segment) + (size_t) header->sampleCount * sizeof(float) + header->nameBytes;
+    if (size != expected) return false;
+    const Channel *channels = (const Channel *) (header + 1);
+    const CurveRange *curveRanges = (const CurveRange *) (channels + header->channelCount);
+    const Segment *segments = (const Segment *) (curveRanges + header->curveCount);
+
+    // every record is checked once here, so a corrupt or stale file is turned down rather than read out of bounds
+    for (uint32_t i = 0; i < header->channelCount; ++i) {
+        const Channel &channel = channels[i];
+        if ((uint64_t) channel.name + channel.nameLength > header->nameBytes) return false;
+        if ((uint64_t) channel.firstSegment + channel.segmentCount > header->segmentCount) return false;
+        // sampling searches them by start
+        for (uint32_t j = 1; j < channel.segmentCount; ++j) {
+            if (segments[channel.firstSegment + j].start < segments[channel.firstSegment + j - 1].start) return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->curveCount; ++i) {
+        if (curveRanges[i].sampleCount < 2 || (uint64_t) curveRanges[i].firstSample + curveRanges[i].sampleCount > header->sampleCount) return false;
+    }
+    for (uint32_t i = 0; i < header->segmentCount; ++i) {
+        const Segment &segment = segments[i];
+        if (segment.first == segment.last) continue;
+        if (segment.animationEnd <= segment.animationStart) return false;
+        if (segment.easing >= 0 ? !Ease::byIndex(segment.easing) : -(int64_t) segment.easing - 1 >= header->curveCount) return false;
+    }
+
+    this->data = data;
+    this->size = size;
+    this->header = header;
+    this->channels = channels;
+    this->curveRanges = curveRanges;
+    this->segments = segments;
+    samples = (const float *) (segments + header->segmentCount);
+    names = (const char *) (samples + header->sampleCount);
+    curves.clear();
+    for (uint32_t i = 0; i < header->curveCount; ++i) {
+        curves.push_back(Curve::fromSamples(std::vector<GLfloat>(samples + curveRanges[i].firstSample, samples + curveRanges[i].firstSample + curveRanges[i].sampleCount)));
+    }
+    bindings.assign(header->channelCount, Binding("", (GLfloat *) nullptr));
+    written.assign(header->channelCount, -1);
+    return true;
+}
+
+bool AnimationClip::save(std::string path) const {
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.get(), size);
+    return file.good();
+}
+
+bool AnimationClip::load(std::string path) {
+    // little endian and packed the same on every platform the scene runs on, so the mapping is used as is
+    size_t size = 0;
+    std::shared_ptr<const char> data = Files::map(path, size);
+    if (!data) return false;
+    return attach(data, size);
+}
+
+void AnimationClip::bind(const std::vector<Binding> &bindings) {
+    for (uint32_t i = 0; i < header->channelCount; ++i) {
+        std::string name(names + channels[i].name, channels[i].nameLength);
+        auto binding = std::find_if(bindings.begin(), bindings.end(), [&name](const Binding &binding) { return binding.name == name; });
+        this->bindings[i] = binding != bindings.end() ? *binding : Binding(name, (GLfloat *) nullptr);
+    }
+    written.assign(header->channelCount, -1);
+}
+
+size_t AnimationClip::getSize() const { return size; }
+
+GLfloat AnimationClip::evaluate(const Segment &segment, double time) const {
+    if (segment.first == segment.last || time >= segment.animationEnd) return segment.last;
+    GLfloat progress = std::max(time - segment.animationStart, 0.) / (segment.animationEnd - segment.animationStart);
+    GLfloat eased = segment.easing >= 0 ? Ease::byIndex(segment.easing)(progress) : (*curves[-1 - segment.easing])(progress);
+    return segment.first + eased * (segment.last - segment.first);
+}
+
+void AnimationClip::sample(double time) {
+    if (!header) return;
+    for (uint32_t i = 0; i < header->channelCount; ++i) {
+        const Segment *first = segments + channels[i].firstSegment, *last = first + channels[i].segmentCount;
+        // the last segment that started, which also covers the time after it ended
+        const Segment *segment = std::upper_bound(first, last, time, [](double time, const Segment &segment) { return time < segment.start; }) - 1;
+        if (segment < first) continue;
+        int index = segment - segments;
+        bool constant = segment->first == segment->last;
+        if (constant && written[i] == index) continue;
+        written[i] = constant ? index : -1;
+        GLfloat value = evaluate(*segment, time);
+        const Binding &binding = bindings[i];
+        if (binding.value) {
+            *binding.value = value;
+        } else if (binding.setter) {
+            binding.setter(value);
+        }
+    }
+}
+
+unsigned long AnimationClip::getDuration() { return header ? header->duration : 0; }
@@ -0,0 +1,75 @@
+#ifndef CLIPS_HPP
+#define CLIPS_HPP
+
+#include <GL/freeglut.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "animations.hpp"
+
+// a named value animations write to, either a variable or a setter for values kept elsewhere
+struct Binding {
+    std::string name;
+    GLfloat *value;
+    std::function<void(GLfloat)> setter;
+
+    Binding(std::string name, GLfloat *value) : name(name), value(value) {}
+    Binding(std::string name, std::function<void(GLfloat)> setter) : name(name), value(nullptr), setter(setter) {}
+};
+
+// an animation group compiled into one piecewise track per bound value, where nothing overlaps, pieces of the same
+// animation are merged and holds are constant spans written once; stored in the same layout in memory and on disk,
+// so a saved clip is used straight from a mapping of its file
+class AnimationClip : public Playable {
+    private:
+    struct Header {
+        char magic[4];
+        uint32_t version, duration, channelCount, segmentCount, curveCount, sampleCount, nameBytes;
+    };
+    struct Channel {
+        uint32_t name, nameLength, firstSegment, segmentCount;
+    };
+    struct CurveRange {
+        uint32_t firstSample, sampleCount;
+    };
+    // the piece of an animation between start and end, which keeps the animation's own span for its easing
+    struct Segment {
+        uint32_t start, end, animationStart, animationEnd;
+        float first, last;
+        int32_t easing;  // an Ease index, or -1 - a curve index
+    };
+    static const uint32_t version = 1;
+    std::shared_ptr<const char> data;
+    size_t size;
+    const Header *header;
+    const Channel *channels;
+    const CurveRange *curveRanges;
+    const Segment *segments;
+    const float *samples;
+    const char *names;
+    // resolved when bound or loaded
+    std::vector<std::shared_ptr<const Curve>> curves;
+    std::vector<Binding> bindings;  // by channel, with neither a value nor a setter when unbound
+    std::vector<int> written;  // constant segment each channel last wrote, so holds are written once
+    bool attach(std::shared_ptr<const char> data, size_t size);
+    GLfloat evaluate(const Segment &segment, double time) const;
+
+    public:
+    AnimationClip();
+    // tracks are matched to the bindings by the binding they were made from, or by the value they write; false when
+    // one matches none, or two bindings share a name
+    bool compile(const AnimationGroup &group, const std::vector<Binding> &bindings);
+    bool save(std::string path) const;
+    // maps a saved clip, which still has to be bound
+    bool load(std::string path);
+    void bind(const std::vector<Binding> &bindings);
+    size_t getSize() const;
+    void sample(double time);
+    unsigned long getDuration();
+};
+
+#endif
@@ -0,0 +1,311 @@
+#include "collisions.hpp"
+
+#include <algorithm>
+#include <map>
+
+namespace {
+    // lowest root of a * x^2 + b * x + c inside (0, limit)
+    bool lowestRoot(GLfloat a, GLfloat b, GLfloat c, GLfloat limit, GLfloat &root) {
+        GLfloat determinant = b * b - 4 * a * c;
+        if (a == 0 || determinant < 0) return false;
+        GLfloat squareRoot = std::sqrt(determinant);
+        GLfloat first = (-b - squareRoot) / (2 * a), second = (-b + squareRoot) / (2 * a);
+        if (first > second) std::swap(first, second);
+        if (first > 0 && first < limit) {
+            root = first;
+            return true;
+        }
+        if (second > 0 && second < limit) {
+            root = second;
+            return true;
+        }
+        return false;
+    }
+
+    bool insideTriangle(const Vector3 &point, const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &normal) {
+        return (b - a).cross(point - a).dot(normal) >= 0 && (c - b).cross(point - b).dot(normal) >= 0 && (a - c).cross(point - c).dot(normal) >= 0;
+    }
+
+    // sphere moving from base by velocity against a two-sided triangle, lowers time (a fraction of velocity) on a hit
+    bool sweepTriangle(const Vector3 &base, const Vector3 &velocity, GLfloat radius, const Vector3 &a, const Vector3 &b, const Vector3 &c, GLfloat &time, Vector3 &contact) {
+        // nothing to do if the triangle's bounding sphere stays out of reach of the swept path
+        Vector3 center = (a + b + c) / 3, end = velocity * time;
+        GLfloat extent = std::max({(a - center).dot(a - center), (b - center).dot(b - center), (c - center).dot(c - center)});
+        GLfloat along = std::clamp((center - base).dot(end) / std::max(end.dot(end), 1e-12f), 0.f, 1.f);
+        Vector3 gap = base + end * along - center;
+        if (gap.dot(gap) > extent + radius * (radius + 2 * std::sqrt(extent))) return false;
+
+        Vector3 faceNormal = (b - a).cross(c - a);
+        GLfloat area = faceNormal.length();
+        if (area == 0) return false;
+        faceNormal = faceNormal / area;
+        // turn the plane towards the sphere
+        GLfloat distance = faceNormal.dot(base - a);
+        Vector3 normal = distance < 0 ? faceNormal * -1 : faceNormal;
+        distance = std::abs(distance);
+        GLfloat approach = normal.dot(velocity);
+
+        // the face itself, reached when the sphere first touches the plane
+        if (approach < 0) {
+            GLfloat touch = std::max((radius - distance) / approach, 0.f);
+            if (touch > time) return false;
+            Vector3 point = base - normal * std::min(distance, radius) + velocity * touch;
+            if (insideTriangle(point, a, b, c, faceNormal)) {
+                time = touch;
+                contact = point;
+                return true;
+            }
+        } else if (distance >= radius) {
+            return false;
+        }
+
+        // otherwise the sphere can only touch a vertex or an edge
+        bool hit = false;
+        GLfloat speed = velocity.dot(velocity), root;
+        for (const Vector3 *vertex : {&a, &b, &c}) {
+            if (lowestRoot(speed, 2 * velocity.dot(base - *vertex), (*vertex - base).dot(*vertex - base) - radius * radius, time, root)) {
+                time = root;
+                contact = *vertex;
+                hit = true;
+            }
+        }
+        const Vector3 *edges[3][2] = {{&a, &b}, {&b, &c}, {&c, &a}};
+        for (auto &edge : edges) {
+            Vector3 direction = *edge[1] - *edge[0], toVertex = *edge[0] - base;
+            GLfloat lengthSquared = direction.dot(direction), alongVelocity = direction.dot(velocity), alongToVertex = direction.dot(toVertex);
+            GLfloat quadratic = lengthSquared * -speed + alongVelocity * alongVelocity;
+            GLfloat linear = lengthSquared * 2 * velocity.dot(toVertex) - 2 * alongVelocity * alongToVertex;
+            GLfloat constant = lengthSquared * (radius * radius - toVertex.dot(toVertex)) + alongToVertex * alongToVertex;
+            if (lowestRoot(quadratic, linear, constant, time, root)) {
+                // only counts if it lands within the segment
+                GLfloat fraction = (alongVelocity * root - alongToVertex) / lengthSquared;
+                if (fraction >= 0 && fraction <= 1) {
+                    time = root;
+                    contact = *edge[0] + direction * fraction;
+                    hit = true;
+                }
+            }
+        }
+        return hit;
+    }
+
+    BoundingBox sweptBox(const Vector3 &base, const Vector3 &velocity, GLfloat radius) {
+        Vector3 margin(radius, radius, radius), end = base + velocity;
+        return {Vector3::min(base, end) - margin, Vector3::max(base, end) + margin};
+    }
+
+    void triangleBoxes(const std::vector<GLfloat> &vertices, const std::vector<GLuint> &indices, std::vector<BoundingBox> &boxes) {
+        boxes.resize(indices.size() / 3);
+        for (int i = 0; i < boxes.size(); ++i) {
+            boxes[i] = BoundingBox();
+            for (int k = 0; k < 3; ++k) {
+                const GLfloat *vertex = &vertices[indices[i * 3 + k] * 3];
+                boxes[i].expand(Vector3(vertex[0], vertex[1], vertex[2]));
+            }
+        }
+    }
+
+    Matrix4 compose(std::vector<std::shared_ptr<Transformation>>::const_iterator begin, std::vector<std::shared_ptr<Transformation>>::const_iterator end) {
+        Matrix4 matrix = Matrix4::identity();
+        for (auto transformation = begin; transformation != end; ++transformation) matrix = matrix * (*transformation)->getMatrix();
+        return matrix;
+    }
+}
+
+// class BoundingVolumeHierarchy
+
+int BoundingVolumeHierarchy::build(const std::vector<BoundingBox> &boxes, int start, int end) {
+    int index = nodes.size();
+    nodes.push_back({});
+    BoundingBox box, centers;
+    for (int i = start; i < end; ++i) {
+        box.expand(boxes[primitives[i]]);
+        centers.expand(boxes[primitives[i]].getCenter());
+    }
+    nodes[index].box = box;
+    if (end - start <= leafSize) {
+        nodes[index].start = start;
+        nodes[index].count = end - start;
+        return index;
+    }
+
+    // median split along the widest spread of centers
+    Vector3 extent = centers.max - centers.min;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    int middle = (start + end) / 2;
+    std::nth_element(primitives.begin() + start, primitives.begin() + middle, primitives.begin() + end, [&](int a, int b) {
+        return boxes[a].getCenter().array[axis] < boxes[b].getCenter().array[axis];
+    });
+    build(boxes, start, middle);
+    int right = build(boxes, middle, end);
+    nodes[index].count = 0;
+    nodes[index].right = right;
+    return index;
+}
+
+void BoundingVolumeHierarchy::build(const std::vector<BoundingBox> &boxes) {
+    nodes.clear();
+    primitives.resize(boxes.size());
+    for (int i = 0; i < primitives.size(); ++i) primitives[i] = i;
+    if (!boxes.empty()) build(boxes, 0, boxes.size());
+}
+
+void BoundingVolumeHierarchy::refit(const std::vector<BoundingBox> &boxes) {
+    for (int i = nodes.size() - 1; i >= 0; --i) {
+        Node &node = nodes[i];
+        node.box = BoundingBox();
+        if (node.count > 0) {
+            for (int j = node.start; j < node.start + node.count; ++j) node.box.expand(boxes[primitives[j]]);
+        } else {
+            node.box.expand(nodes[i + 1].box);
+            node.box.expand(nodes[node.right].box);
+        }
+    }
+}
+
+BoundingBox BoundingVolumeHierarchy::getBounds() const { return nodes.empty() ? BoundingBox() : nodes[0].box; }
+
+// class CollisionScene
+
+void CollisionScene::place(Group &group) {
+    group.matrix = compose(group.transformations.begin(), group.transformations.end());
+    group.inverse = group.matrix.inverse();
+    for (int index : group.instances) {
+        Instance &instance = instances[index];
+        instance.matrix = group.matrix * instance.local;
+        instance.inverse = instance.localInverse * group.inverse;
+        instance.box = instance.tree.getBounds().transform(instance.matrix);
+    }
+}
+
+void CollisionScene::build(Shape &scene) {
+    std::vector<Collider> colliders;
+    std::vector<std::shared_ptr<Transformation>> chain;
+    scene.collect(colliders, chain);
+
+    instances.clear();
+    groups.clear();
+    animated.clear();
+    instances.resize(colliders.size());
+    std::map<std::vector<std::shared_ptr<Transformation>>, int> groupIndices;
+    std::map<Transformation *, int> animatedIndices;
+    for (int i = 0; i < instances.size(); ++i) {
+        const Collider &collider = colliders[i];
+        Instance &instance = instances[i];
+        instance.vertices = collider.vertices;
+        instance.indices = collider.indices;
+        triangleBoxes(*instance.vertices, *instance.indices, boxes);
+        instance.tree.build(boxes);
+
+        // split the chain after its last animated transformation
+        auto split = std::find_if(collider.transformations.rbegin(), collider.transformations.rend(), [](auto &transformation) { return (bool) transformation->getParameters; }).base();
+        instance.local = compose(split, collider.transformations.end());
+        instance.localInverse = instance.local.inverse();
+        instance.group = -1;
+        if (split == collider.transformations.begin()) {
+            instance.matrix = instance.local;
+            instance.inverse = instance.localInverse;
+            instance.box = instance.tree.getBounds().transform(instance.matrix);
+            continue;
+        }
+        std::vector<std::shared_ptr<Transformation>> prefix(collider.transformations.begin(), split);
+        auto group = groupIndices.emplace(prefix, groups.size());
+        if (group.second) {
+            groups.push_back({prefix, Matrix4(), Matrix4(), {}});
+            for (auto &transformation : prefix) {
+                if (!transformation->getParameters) continue;
+                auto entry = animatedIndices.emplace(transformation.get(), animated.size());
+                if (entry.second) {
+                    transformation->update();
+                    animated.push_back({transformation, transformation->parameters, {}});
+                }
+                animated[entry.first->second].groups.push_back(group.first->second);
+            }
+        }
+        instance.group = group.first->second;
+        groups[instance.group].instances.push_back(i);
+    }
+    for (auto &group : groups) place(group);
+
+    boxes.resize(instances.size());
+    std::transform(instances.begin(), instances.end(), boxes.begin(), [](auto &instance) { return instance.box; });
+    tree.build(boxes);
+    moved.assign(groups.size(), false);
+}
+
+void CollisionScene::update() {
+    // each animated transformation is evaluated once, however many groups and instances sit below it
+    std::vector<int> changed;
+    for (auto &entry : animated) {
+        entry.transformation->update();
+        const Coordinates3D &parameters = entry.transformation->parameters;
+        if (parameters.x == entry.parameters.x && parameters.y == entry.parameters.y && parameters.z == entry.parameters.z) continue;
+        entry.parameters = parameters;
+        for (int index : entry.groups) {
+            if (moved[index]) continue;
+            moved[index] = true;
+            changed.push_back(index);
+        }
+    }
+    if (changed.empty()) return;
+
+    // rigid moves leave the instance trees alone, only their world boxes and the top tree change
+    for (int index : changed) {
+        place(groups[index]);
+        for (int instance : groups[index].instances) boxes[instance] = instances[instance].box;
+        moved[index] = false;
+    }
+    tree.refit(boxes);
+}
+
+bool CollisionScene::sweep(const Vector3 &base, const Vector3 &velocity, GLfloat radius, GLfloat &time, Vector3 &contact) const {
+    BoundingBox box = sweptBox(base, velocity, radius);
+    bool hit = false;
+    tree.query(box, [&](int index) {
+        const Instance &instance = instances[index];
+        const std::vector<GLfloat> &vertices = *instance.vertices;
+        const std::vector<GLuint> &indices = *instance.indices;
+        // candidates come from the untransformed tree, the test itself runs in world space
+        instance.tree.query(box.transform(instance.inverse), [&](int triangle) {
+            Vector3 corners[3];
+            BoundingBox bounds;
+            for (int k = 0; k < 3; ++k) {
+                const GLfloat *vertex = &vertices[indices[triangle * 3 + k] * 3];
+                corners[k] = instance.matrix.transformPoint({vertex[0], vertex[1], vertex[2]});
+                bounds.expand(corners[k]);
+            }
+            // leaves are coarse, most of their triangles are nowhere near the sweep
+            if (bounds.intersects(box)) hit |= sweepTriangle(base, velocity, radius, corners[0], corners[1], corners[2], time, contact);
+        });
+    });
+    return hit;
+}
+
+Vector3 CollisionScene::slide(const Vector3 &position, const Vector3 &displacement, GLfloat radius, Vector3 &velocity) const {
+    // gap left between the sphere and the surface so the next sweep does not start inside it
+    const GLfloat skin = 0.001f;
+    Vector3 base = position, remaining = displacement;
+    for (int i = 0; i < maxSlides; ++i) {
+        GLfloat length = remaining.length(), time = 1;
+        if (length < skin / 100) return base;
+        Vector3 contact;
+        if (!sweep(base, remaining, radius, time, contact)) return base + remaining;
+
+        // stop just short of the contact
+        Vector3 direction = remaining / length, destination = base + remaining;
+        if (time * length > skin) {
+            base = base + direction * (time * length - skin);
+            contact = contact - direction * skin;
+        }
+
+        // project what is left of the move onto the plane tangent to the contact
+        Vector3 normal = base - contact;
+        GLfloat distance = normal.length();
+        if (distance == 0) return base;
+        normal = normal / distance;
+        remaining = destination - normal * normal.dot(destination - contact) - contact;
+        GLfloat into = velocity.dot(normal);
+        if (into < 0) velocity = velocity - normal * into;
+    }
+    return base;
+}
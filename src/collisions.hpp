@@ -0,0 +1,120 @@
+#ifndef COLLISIONS_HPP
+#define COLLISIONS_HPP
+
+#include <vector>
+
+#include "maths.hpp"
+#include "shapes.hpp"
+
+struct BoundingBox {
+    Vector3 min, max;
+
+    BoundingBox() : min(INFINITY, INFINITY, INFINITY), max(-INFINITY, -INFINITY, -INFINITY) {}
+    BoundingBox(const Vector3 &min, const Vector3 &max) : min(min), max(max) {}
+
+    void expand(const Vector3 &point) {
+        min = Vector3::min(min, point);
+        max = Vector3::max(max, point);
+    }
+
+    void expand(const BoundingBox &box) {
+        min = Vector3::min(min, box.min);
+        max = Vector3::max(max, box.max);
+    }
+
+    bool intersects(const BoundingBox &other) const {
+        return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y && min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    Vector3 getCenter() const { return (min + max) * 0.5f; }
+
+    BoundingBox transform(const Matrix4 &matrix) const {
+        BoundingBox box;
+        for (int corner = 0; corner < 8; ++corner) {
+            box.expand(matrix.transformPoint({corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z}));
+        }
+        return box;
+    }
+};
+
+class BoundingVolumeHierarchy {
+    private:
+    // the left child always follows its parent, so children are stored after parents
+    struct Node {
+        BoundingBox box;
+        int start, count, right;  // leaves have a count, inner nodes a right child
+    };
+    static const int leafSize = 4;
+    std::vector<Node> nodes;
+    std::vector<int> primitives;
+    int build(const std::vector<BoundingBox> &boxes, int start, int end);
+
+    public:
+    BoundingVolumeHierarchy() {}
+    void build(const std::vector<BoundingBox> &boxes);
+    // keeps the topology and only recomputes the boxes, for primitives that moved
+    void refit(const std::vector<BoundingBox> &boxes);
+    BoundingBox getBounds() const;
+
+    template <class Callback>
+    void query(const BoundingBox &box, Callback callback) const {
+        if (nodes.empty()) return;
+        int stack[64], size = 0;
+        stack[size++] = 0;
+        while (size > 0) {
+            const Node &node = nodes[stack[--size]];
+            if (!node.box.intersects(box)) continue;
+            if (node.count > 0) {
+                for (int i = node.start; i < node.start + node.count; ++i) callback(primitives[i]);
+            } else {
+                stack[size++] = node.right;
+                stack[size++] = &node - nodes.data() + 1;
+            }
+        }
+    }
+};
+
+class CollisionScene {
+    private:
+    // a chain of transformations up to an animated one, shared by every instance below it
+    struct Group {
+        std::vector<std::shared_ptr<Transformation>> transformations;
+        Matrix4 matrix, inverse;
+        std::vector<int> instances;
+    };
+    // a simple shape placed in the world, its tree built once over the untransformed triangles
+    struct Instance {
+        const std::vector<GLfloat> *vertices;
+        const std::vector<GLuint> *indices;
+        int group;  // -1 when nothing above it is animated
+        Matrix4 local, localInverse;  // the static transformations below the group
+        Matrix4 matrix, inverse;
+        BoundingBox box;  // world space
+        BoundingVolumeHierarchy tree;
+    };
+    // an animated transformation and the groups it takes part in
+    struct Animated {
+        std::shared_ptr<Transformation> transformation;
+        Coordinates3D parameters;
+        std::vector<int> groups;
+    };
+    static const int maxSlides = 5;
+    std::vector<Instance> instances;
+    std::vector<Group> groups;
+    std::vector<Animated> animated;
+    std::vector<BoundingBox> boxes;
+    std::vector<bool> moved;
+    BoundingVolumeHierarchy tree;
+    void place(Group &group);
+    bool sweep(const Vector3 &base, const Vector3 &velocity, GLfloat radius, GLfloat &time, Vector3 &contact) const;
+
+    public:
+    CollisionScene() {}
+    void build(Shape &scene);
+    // moves only the groups whose animated transformations changed since the last update
+    void update();
+    // moves a sphere by a displacement, sliding along whatever it hits, and clips the velocity likewise
+    Vector3 slide(const Vector3 &position, const Vector3 &displacement, GLfloat radius, Vector3 &velocity) const;
+};
+
+#endif
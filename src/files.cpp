@@ -0,0 +1,43 @@
+#include "files.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// namespace Files
+
+std::shared_ptr<const char> Files::map(std::string path, size_t &size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    CloseHandle(file);
+    if (!mapping) return nullptr;
+    const char *view = (const char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return nullptr;
+    size = fileSize.QuadPart;
+    return std::shared_ptr<const char>(view, [](const char *view) { UnmapViewOfFile(view); });
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) return nullptr;
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        close(file);
+        return nullptr;
+    }
+    size_t length = status.st_size;
+    void *view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED) return nullptr;
+    size = length;
+    return std::shared_ptr<const char>((const char *) view, [length](const char *view) { munmap((void *) view, length); });
+#endif
+}
@@ -0,0 +1,12 @@
+#ifndef FILES_HPP
+#define FILES_HPP
+
+#include <memory>
+#include <string>
+
+namespace Files {
+    // maps a whole file read only, released with the last copy of the pointer; nullptr for missing or empty files
+    std::shared_ptr<const char> map(std::string path, size_t &size);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include "inputs.hpp"
+
+// class InputQueue
+
+void InputQueue::setKeys(const std::vector<Key> &keys) {
+    this->keys.fill(nullptr);
+    // the first key given a slot keeps it, as the first match did when keys were searched
+    for (const auto &key : keys) {
+        for (int slot : key.getSlots()) {
+            if (slot >= 0 && !this->keys[slot]) this->keys[slot] = &key;
+        }
+    }
+}
+
+void InputQueue::keyDown(int slot) {
+    if (slot >= 0 && slot < Key::slotCount && keys[slot]) events.push_back({InputEvent::KeyDown, slot, 0, 0, std::chrono::steady_clock::now()});
+}
+
+void InputQueue::keyUp(int slot) {
+    if (slot >= 0 && slot < Key::slotCount && keys[slot]) events.push_back({InputEvent::KeyUp, slot, 0, 0, std::chrono::steady_clock::now()});
+}
+
+void InputQueue::button(int button, int x, int y) {
+    events.push_back({InputEvent::Button, button, x, y, std::chrono::steady_clock::now()});
+}
+
+void InputQueue::move(int x, int y) {
+    if (!moved) firstMotion = std::chrono::steady_clock::now();
+    moved = true;
+    motionX += x - lastX;
+    motionY += y - lastY;
+    lastX = x;
+    lastY = y;
+}
+
+void InputQueue::warp(int x, int y) {
+    lastX = x;
+    lastY = y;
+}
+
+void InputQueue::dispatch(std::function<void(int button, int x, int y)> onButton) {
+    for (const auto &event : events) {
+        switch (event.kind) {
+            case InputEvent::KeyDown:
+                keys[event.code]->down();
+                break;
+            case InputEvent::KeyUp:
+                keys[event.code]->up();
+                break;
+            case InputEvent::Button:
+                if (onButton) onButton(event.code, event.x, event.y);
+                break;
+        }
+    }
+    events.clear();
+}
+
+bool InputQueue::takeMotion(int &x, int &y) {
+    if (!moved) return false;
+    x = motionX;
+    y = motionY;
+    motionX = motionY = 0;
+    moved = false;
+    latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - firstMotion).count();
+    return true;
+}
+
+double InputQueue::getLatency() const {
+    return latency;
+}
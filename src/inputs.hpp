@@ -0,0 +1,51 @@
+#ifndef INPUTS_HPP
+#define INPUTS_HPP
+
+#define _USE_MATH_DEFINES
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "keys.hpp"
+
+struct InputEvent {
+    enum Kind { KeyDown, KeyUp, Button };
+    Kind kind;
+    int code;  // the key's slot, or the mouse button
+    int x, y;
+    std::chrono::steady_clock::time_point time;
+};
+
+// what glut delivers between frames, held until the frame that acts on it: keys and clicks run in the order they came
+// when the frame starts, keys found by a table rather than a search, and pointer moves are summed into one motion that
+// the frame takes as late as it can, right before it places the camera
+class InputQueue {
+    private:
+    std::vector<InputEvent> events;
+    std::array<const Key *, Key::slotCount> keys = {};
+    int lastX = 0, lastY = 0, motionX = 0, motionY = 0;
+    bool moved = false;
+    std::chrono::steady_clock::time_point firstMotion;
+    double latency = 0;
+
+    public:
+    // keys are looked up in place, so the vector must outlive the queue unchanged
+    void setKeys(const std::vector<Key> &keys);
+    void keyDown(int slot);
+    void keyUp(int slot);
+    void button(int button, int x, int y);
+    void move(int x, int y);
+    // the pointer was put at x, y by the program, which is no motion
+    void warp(int x, int y);
+    // runs the key and button events queued since the last call; buttons go to onButton
+    void dispatch(std::function<void(int button, int x, int y)> onButton);
+    // the pointer motion since it was last taken, false if there was none
+    bool takeMotion(int &x, int &y);
+    // milliseconds from the first move of the last motion taken to when it was taken
+    double getLatency() const;
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "instances.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "shaders.hpp"
+
+// class InstancedShape : public Shape
+
+InstancedShape::InstancedShape(SimpleShape *shape, ShaderHandle shader, ShaderHandle depthShader)
+    : shape(shape), shader(shader), depthShader(depthShader), uploadedKeyframes(0), uploadedInstances(0), changedFirst(0), changedLast(-1), keyframeBuffer(0), keyframeTexture(0), matrixBuffer(0), animationBuffer(0) {}
+
+InstancedShape::InstancedShape(const InstancedShape &other)
+    : Shape(other), shape(other.shape), shader(other.shader), depthShader(other.depthShader), keyframes(other.keyframes), offsets(other.offsets), matrices(other.matrices), animations(other.animations),
+      uploadedKeyframes(0), uploadedInstances(0), changedFirst(0), changedLast(-1), keyframeBuffer(0), keyframeTexture(0), matrixBuffer(0), animationBuffer(0) {}
+
+InstancedShape::~InstancedShape() {
+    if (!keyframeBuffer) return;
+    glDeleteTextures(1, &keyframeTexture);
+    GLuint buffers[] = {keyframeBuffer, matrixBuffer, animationBuffer};
+    glDeleteBuffers(3, buffers);
+}
+
+Shape *InstancedShape::clone() const { return new InstancedShape(*this); }
+
+int InstancedShape::addAnimation(std::vector<KeyframeTrack> tracks) {
+    offsets.push_back(keyframes.size() / 4);
+    keyframes.insert(keyframes.end(), {(GLfloat) tracks.size(), 0, 0, 0});
+    for (auto &track : tracks) {
+        assert(!track.keyframes.empty());
+        // the shader only interpolates linearly, eased segments become runs of linear keys
+        std::vector<GLfloat> keys;
+        for (size_t i = 0; i < track.keyframes.size(); ++i) {
+            const Keyframe &key = track.keyframes[i];
+            int steps = i > 0 && !(key.ease == Easing(Ease::linear)) ? bakedKeys : 1;
+            for (int step = 1; step <= steps; ++step) {
+                const Keyframe &previous = i > 0 ? track.keyframes[i - 1] : key;
+                GLfloat progress = (GLfloat) step / steps, eased = key.ease(progress);
+                GLfloat texel[4] = {previous.time + (key.time - previous.time) * progress};
+                for (int axis = 0; axis < 3; ++axis) {
+                    texel[axis + 1] = step == steps ? key.value.array[axis] : previous.value.array[axis] + (key.value.array[axis] - previous.value.array[axis]) * eased;
+                }
+                keys.insert(keys.end(), texel, texel + 4);
+            }
+        }
+        GLfloat duration = track.keyframes.back().time;
+        keyframes.insert(keyframes.end(), {(GLfloat) track.kind, (GLfloat) keys.size() / 4, duration, track.looping && duration > 0 ? 1.f : 0.f});
+        keyframes.insert(keyframes.end(), keys.begin(), keys.end());
+    }
+    return offsets.size() - 1;
+}
+
+int InstancedShape::addInstance(Matrix4 matrix, int animation) {
+    matrices.push_back(matrix);
+    animations.insert(animations.end(), {(GLfloat) offsets[animation], std::numeric_limits<GLfloat>::max()});
+    return matrices.size() - 1;
+}
+
+void InstancedShape::start(int instance, GLfloat time) {
+    animations[instance * 2 + 1] = time;
+    changedFirst = changedLast < 0 ? instance : std::min(changedFirst, instance);
+    changedLast = std::max(changedLast, instance);
+}
+
+int InstancedShape::getInstanceCount() const { return matrices.size(); }
+
+void InstancedShape::upload() {
+    if (!keyframeBuffer) {
+        GLuint buffers[3];
+        glGenBuffers(3, buffers);
+        keyframeBuffer = buffers[0], matrixBuffer = buffers[1], animationBuffer = buffers[2];
+        glGenTextures(1, &keyframeTexture);
+    }
+    // keyframes and placements go up once, start times as they change
+    if (keyframes.size() != uploadedKeyframes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, keyframeBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, keyframes.size() * sizeof(GLfloat), keyframes.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, keyframeTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, keyframeBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        uploadedKeyframes = keyframes.size();
+    }
+    if (matrices.size() != uploadedInstances) {
+        glBindBuffer(GL_ARRAY_BUFFER, matrixBuffer);
+        glBufferData(GL_ARRAY_BUFFER, matrices.size() * sizeof(Matrix4), matrices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, animationBuffer);
+        glBufferData(GL_ARRAY_BUFFER, animations.size() * sizeof(GLfloat), animations.data(), GL_DYNAMIC_DRAW);
+        uploadedInstances = matrices.size();
+    } else if (changedLast >= 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, animationBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, changedFirst * 2 * sizeof(GLfloat), (changedLast - changedFirst + 1) * 2 * sizeof(GLfloat), &animations[changedFirst * 2]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    changedLast = -1;
+}
+
+void InstancedShape::renderRaw() { draw(Resources::getShader(shader)); }
+
+void InstancedShape::renderDepthRaw() {
+    Shader *depth = Resources::getShader(depthShader);
+    draw(depth ? depth : Resources::getShader(shader));
+}
+
+void InstancedShape::draw(Shader *instanced) {
+    if (matrices.empty() || !instanced) return;
+    if (shape->vertexArray.getCount() == 0) shape->build();
+    upload();
+    const VertexArray &array = shape->meshEnabled() && shape->meshLevel > 1 ? shape->meshVertexArray : shape->vertexArray;
+
+    // the shader draws with the view alone and decodes positions itself, so instances go between the two
+    Shader *previous = Shader::getBound();
+    Matrix4 view, decode;
+    glGetFloatv(GL_MODELVIEW_MATRIX, view.array);
+    if (shape->texture) glBindTexture(GL_TEXTURE_2D, Resources::getTexture(shape->texture));
+    array.enable((bool) shape->texture);
+    glGetFloatv(GL_MODELVIEW_MATRIX, decode.array);
+    decode = view.inverse() * decode;
+    instanced->enable();
+    glUniformMatrix4fv(instanced->getUniformLocation("view"), 1, GL_FALSE, view.array);
+    glUniformMatrix4fv(instanced->getUniformLocation("decode"), 1, GL_FALSE, decode.array);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, keyframeTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, matrixBuffer);
+    for (GLuint column = 0; column < 4; ++column) {
+        glEnableVertexAttribArray(VertexAttribute::instanceMatrix + column);
+        glVertexAttribPointer(VertexAttribute::instanceMatrix + column, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4), (const void *) (column * 4 * sizeof(GLfloat)));
+        glVertexAttribDivisor(VertexAttribute::instanceMatrix + column, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, animationBuffer);
+    glEnableVertexAttribArray(VertexAttribute::instanceAnimation);
+    glVertexAttribPointer(VertexAttribute::instanceAnimation, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glVertexAttribDivisor(VertexAttribute::instanceAnimation, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    array.draw(matrices.size());
+
+    for (GLuint attribute = VertexAttribute::instanceAnimation; attribute < VertexAttribute::instanceMatrix + 4; ++attribute) {
+        glVertexAttribDivisor(attribute, 0);
+        glDisableVertexAttribArray(attribute);
+    }
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    if (previous) previous->enable(); else Shader::clear();
+    array.disable((bool) shape->texture);
+    if (shape->texture) glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void InstancedShape::pickRaw(Picker &picker) {}
+
+void InstancedShape::collectRaw(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain) {}
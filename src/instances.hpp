@@ -0,0 +1,74 @@
+#ifndef INSTANCES_HPP
+#define INSTANCES_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <memory>
+#include <vector>
+
+#include "animations.hpp"
+#include "maths.hpp"
+#include "resources.hpp"
+#include "shapes.hpp"
+
+enum class TrackKind {
+    Translation,
+    Rotation,  // degrees around x, then y, then z, like Shape::rotate
+    Scale
+};
+
+struct Keyframe {
+    GLfloat time;  // milliseconds after the instance started
+    Coordinates3D value;
+    Easing ease = Ease::linear;  // from the previous keyframe to this one
+};
+
+// a transformation animated by keyframes, holding the first and last values before and after them
+struct KeyframeTrack {
+    TrackKind kind;
+    std::vector<Keyframe> keyframes;
+    bool looping;
+
+    KeyframeTrack(TrackKind kind, std::vector<Keyframe> keyframes, bool looping = false) : kind(kind), keyframes(keyframes), looping(looping) {}
+};
+
+// copies of a shape drawn in a single call, each placed by a matrix and moved by an animation whose keyframe tracks
+// sit in a buffer on the gpu and are evaluated in the vertex shader from its time uniform, so all the cpu does per
+// frame is send the start times that changed; instances can't be picked and don't collide
+class InstancedShape : public Shape {
+    private:
+    static const int bakedKeys = 32;  // linear keys an eased segment is baked into
+    std::shared_ptr<SimpleShape> shape;
+    ShaderHandle shader, depthShader;
+    std::vector<GLfloat> keyframes;  // texels of four floats, in the layout the shader reads
+    std::vector<int> offsets;        // first texel, by animation
+    std::vector<Matrix4> matrices;
+    std::vector<GLfloat> animations;  // first texel of the animation and start time, by instance
+    size_t uploadedKeyframes, uploadedInstances;
+    int changedFirst, changedLast;  // instances whose start times changed since the last upload
+    GLuint keyframeBuffer, keyframeTexture, matrixBuffer, animationBuffer;
+    void upload();
+    void draw(Shader *program);
+    void renderRaw();
+    void renderDepthRaw();
+    void pickRaw(Picker &picker);
+    void collectRaw(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain);
+
+    public:
+    // the shader is instanced.vert with the keyframes sampler on texture unit 1, and the depth shader the same vertex
+    // shader with one that writes nothing, for the depth pre-pass, which otherwise draws with the full one
+    InstancedShape(SimpleShape *shape, ShaderHandle shader, ShaderHandle depthShader = {});
+    InstancedShape(const InstancedShape &other);
+    ~InstancedShape();
+    Shape *clone() const;
+    int addAnimation(std::vector<KeyframeTrack> tracks);
+    // an instance rests on the first keys of its animation until started
+    int addInstance(Matrix4 matrix, int animation);
+    // in the time of the shader's time uniform, restarting the animation if it was playing
+    void start(int instance, GLfloat time);
+    int getInstanceCount() const;
+};
+
+#endif
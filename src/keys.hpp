@@ -3,6 +3,7 @@
 
 #include <functional>
 #include <iostream>
+#include <vector>
 
 #include "structures.hpp"
 
@@ -29,6 +30,11 @@ class Key {
     bool isAlphabetical;
 
     public:
+    // a table of keys holds the ascii codes followed by glut's special keys
+    static const int slotCount = 512;
+    static int getSlot(unsigned char ascii) { return ascii; }
+    static int getSlot(int special) { return special >= 0 && special < 256 ? 256 + special : -1; }
+
     Key(char ascii, std::string description, bool &toggle) : Key(ascii, description, [&toggle] { toggle = !toggle; }) {}
     Key(char ascii, std::string name, std::string description, bool &toggle) : Key(ascii, name, description, [&toggle] { toggle = !toggle; }) {}
     Key(unsigned char ascii, std::string name, std::string description, bool &toggle) : Key(ascii, name, description, [&toggle] { toggle = !toggle; }) {}
@@ -43,11 +49,17 @@ class Key {
 
     std::string getName() const { return name; }
     std::string getDescription() const { return description; }
+    // both cases of a letter
+    std::vector<int> getSlots() const {
+        if (!isAscii) return {getSlot(value.special)};
+        if (isAlphabetical) return {getSlot(value.ascii.lowercase), getSlot(value.ascii.uppercase)};
+        return {getSlot(value.ascii.lowercase)};
+    }
 
     bool operator==(unsigned char &ascii) const { return isAscii && (ascii == value.ascii.lowercase || isAlphabetical && ascii == value.ascii.uppercase); }
-    friend bool operator==(unsigned char &ascii, Key &key) { return key == ascii; }
+    friend bool operator==(unsigned char &ascii, Key &key) { return key.operator==(ascii); }
     bool operator==(int &special) const { return !isAscii && special == value.special; }
-    friend bool operator==(int &special, Key &key) { return key == special; }
+    friend bool operator==(int &special, Key &key) { return key.operator==(special); }
 
     void down() const {
         if (onDown != nullptr) onDown();
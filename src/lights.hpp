@@ -1,3 +1,6 @@
+#ifndef LIGHTS_HPP
+#define LIGHTS_HPP
+
 #include <GL/freeglut.h>
 #include <assert.h>
 
@@ -11,6 +14,7 @@ class Light {
     DynamicValue<ColorRGBA> ambient, diffuse, specular;
     DynamicValue<Coordinates4D> position;
     DynamicValue<bool> on;
+    unsigned long uploaded = 0;  // epoch in which the colors were last sent
 
     protected:
     int id;
@@ -29,9 +33,11 @@ class Light {
     virtual void render() {
         if (on()) {
             glEnable(id);
-            glLightfv(id, GL_AMBIENT, ambient().array);
-            glLightfv(id, GL_DIFFUSE, diffuse().array);
-            glLightfv(id, GL_SPECULAR, specular().array);
+            // colors are kept by the light, the position is sent every time since it depends on the modelview
+            if (ambient.changedSince(uploaded)) glLightfv(id, GL_AMBIENT, ambient().array);
+            if (diffuse.changedSince(uploaded)) glLightfv(id, GL_DIFFUSE, diffuse().array);
+            if (specular.changedSince(uploaded)) glLightfv(id, GL_SPECULAR, specular().array);
+            uploaded = Reactive::epoch;
             glLightfv(id, GL_POSITION, position().array);
         } else {
             glDisable(id);
@@ -39,7 +45,7 @@ class Light {
     }
 };
 
-int Light::count = 0;
+inline int Light::count = 0;
 
 class PointLight : public Light {
     private:
@@ -101,3 +107,5 @@ class DirectionalLight : public Light {
     DirectionalLight(DynamicValue<ColorRGBA> ambient, DynamicValue<ColorRGBA> diffuse, DynamicValue<ColorRGBA> specular, DynamicValue<Coordinates3D> direction, DynamicValue<bool> on = true)
         : Light(ambient, diffuse, specular, [direction] { return direction().toVector(); }, on) {}
 };
+
+#endif
@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -24,39 +25,39 @@
 #include <sstream>
 #include <vector>
 
-#include "RgbImage.h"
 #include "animations.hpp"
+#include "benchmarks.hpp"
+#include "clips.hpp"
+#include "collisions.hpp"
+#include "inputs.hpp"
+#include "instances.hpp"
 #include "keys.hpp"
 #include "lights.hpp"
+#include "materials.hpp"
 #include "observer.hpp"
+#include "offscreen.hpp"
+#include "picking.hpp"
+#include "queues.hpp"
+#include "recordings.hpp"
+#include "resources.hpp"
+#include "scenes.hpp"
+#include "sequences.hpp"
 #include "shaders.hpp"
 #include "shapes.hpp"
+#include "skyboxes.hpp"
 #include "structures.hpp"
+#include "textures.hpp"
 
 #define BLUE 0.0, 0.0, 1.0, 1.0
-#define TRANSPARENT_BLUE 0.0, 0.0, 1.0, 0.5
 #define RED 1.0, 0.0, 0.0, 1.0
-#define YELLOW 1.0, 1.0, 0.0, 1.0
 #define GREEN 0.0, 1.0, 0.0, 1.0
 #define WHITE 1.0, 1.0, 1.0, 1.0
 #define BLACK 0.0, 0.0, 0.0, 1.0
 #define GRAY 0.5, 0.5, 0.5, 1.0
-#define WHITE_METAL \
-    ColorRGBA{1.0f, 1.0f, 1.0f, 1.0f}, ColorRGBA{1.0f, 1.0f, 1.0f, 1.0f}, ColorRGBA{1.0f, 1.0f, 1.0f, 1.0f}, 76.8f
-#define GRAY_METAL \
-    ColorRGBA{0.7f, 0.7f, 0.7f, 1.0f}, ColorRGBA{0.7f, 0.7f, 0.7f, 1.0f}, ColorRGBA{0.9f, 0.9f, 0.9f, 1.0f}, 76.8f
-#define DARK_GRAY_METAL \
-    ColorRGBA{0.25f, 0.25f, 0.25f, 1.0f}, ColorRGBA{0.4f, 0.4f, 0.4f, 1.0f}, ColorRGBA{0.774597f, 0.774597f, 0.774597f, 1.0f}, 76.8f
 #define RED_METAL \
     ColorRGBA{1.f, 0.20725f, 0.20725f, 1}, ColorRGBA{1.0f, 0.5f, 0.5f, 1}, ColorRGBA{1.0f, 0.5f, 0.5f, 1}, 76.8f
 #define BLACK_RUBBER \
     ColorRGBA{0.02f, 0.02f, 0.02f, 1.0f}, ColorRGBA{0.01f, 0.01f, 0.01f, 1.0f}, ColorRGBA{0.4f, 0.4f, 0.4f, 1.0f}, 10.0f
-#define YELLOW_METAL \
-    ColorRGBA{0.5f, 0.5f, 0.0f, 1.0f}, ColorRGBA{0.5f, 0.5f, 0.0f, 1.0f}, ColorRGBA{0.60f, 0.60f, 0.50f, 1.0f}, 32.0f
-#define GLASS \
-    ColorRGBA{0.1f, 0.18725f, 0.1745f, 0.4f}, ColorRGBA{0.396f, 0.74151f, 0.69102f, 0.4f}, ColorRGBA{0.297254f, 0.30829f, 0.306678f, 0.8f}, 12.8f
-#define SILVER \
-    ColorRGBA{0.773911f, 0.773911f, 0.773911f, 1.0f}, ColorRGBA{0.773911f, 0.773911f, 0.773911f, 1.0f}, ColorRGBA{0.773911f, 0.773911f, 0.773911f, 1.0f}, 100.f
 
 /* CLASSES */
 
@@ -64,21 +65,61 @@
 
 // assets
 // SpotLight flashlight;
-std::map<std::string, GLuint> textures;
-std::map<std::string, Shader> shaders;
+ShaderHandle phongShader, gouraudShader, pickShader, instancedShader, instancedDepthShader, skyboxShader, depthShader;
+TextureHandle skyboxTexture;
 std::vector<std::unique_ptr<Light>> lights;
-std::unique_ptr<Shape> skybox, scene;
+std::unique_ptr<Shape> scene;
+Skybox skybox;
 std::vector<AnimationGroup> animations;
+std::vector<AnimationClip> clips;
+std::string clipsLoadPath, clipsSavePath;
+SceneFile sceneFile;
+SceneContext sceneContext;
+std::string scenePath = "res/scenes/door.scene", sceneSavePath;
+Timeline timeline;
+Scheduler interactions;
+CollisionScene collisions;
+Picker picker;
+DrawQueue drawQueue;
+
+// textures
+TextureSampling textureSampling;
 
 // screen
 GLint screenWidth = 1280, screenHeight = 720, screenCenterX = screenWidth / 2, screenCenterY = screenHeight / 2;
 
 // observer
 Observer observer = Observer(0, 0, 14, -M_PI_2, 0, 0.0003, 1000, 0.35, 5);
-GLfloat fov = 75, renderDistance = 100;
+GLfloat fov = 75, renderDistance = 100, observerRadius = 0.3;
 
 // scene
 GLfloat doorAngle = 0, valveAngle = 0, lockProgress = 1, solidness = 1, skyboxAngle = 0;
+int instancedValves = 0;  // spinning valve wheels drawn behind the door, animated on the gpu
+GLfloat instanceTime = 0;  // clock of the instanced shader, in milliseconds
+
+// headless
+bool headless = false;
+int headlessFrames = 0, headlessAnimation = -1;
+double headlessStep = 1000. / 60;  // simulated milliseconds between frames
+std::string headlessOutput;
+Offscreen offscreen;
+
+// benchmark
+bool benchmarking = false;
+int benchmarkWarmup = 30;
+double benchmarkTolerance = 5;  // percent a statistic may grow by over the baseline's
+std::string benchmarkReport, benchmarkFrames, benchmarkBaseline;
+Benchmark benchmark;
+
+// sequence check
+bool checkingSequences = false;
+
+// recording
+std::string recordingPath = "recording.y4m";
+Recorder recorder;
+
+// input
+InputQueue input;
 
 // time
 std::chrono::steady_clock::time_point lastFrameTime = std::chrono::steady_clock::now(), currentFrameTime;
@@ -97,11 +138,12 @@ bool
     flashlightOn = true,
     skyboxOn = true,
     meshOn = false,
+    depthPrepassOn = false,
     debugInfoOn = true,
     instructionsOn = true,
     animationPlaying = false;
 int currentAnimation = 0;
-std::string currentShader = "phong";
+ShaderHandle currentShader;
 
 // keys
 std::vector<Key> keys = {
@@ -120,27 +162,54 @@ std::vector<Key> keys = {
     Key('L', "Toggle lighting", lightingOn),
     Key('C', "Toggle culling", cullingOn),
     Key('M', "Toggle mesh", meshOn),
-    Key('P', "Turn on Phong shading", [] { currentShader = "phong"; }),
-    Key('G', "Turn on Gouraud shading", [] { currentShader = "gouraud"; }),
-    Key('H', "Turn off shaders", [] { currentShader = ""; }),
+    Key('P', "Turn on Phong shading", [] { currentShader = phongShader; }),
+    Key('G', "Turn on Gouraud shading", [] { currentShader = gouraudShader; }),
+    Key('H', "Turn off shaders", [] { currentShader = {}; }),
+    Key('O', "Toggle depth pre-pass", depthPrepassOn),
     Key(GLUT_KEY_F3, "F3", "Toggle debug informnation", debugInfoOn),
     Key(GLUT_KEY_F4, "F4", "Toggle instructions", instructionsOn),
     Key(GLUT_KEY_F11, "F11", "Toggle fullscreen", glutFullScreenToggle),
+    // a scene without animations leaves nothing for these to play
     Key(' ', "Spacebar", "Play/pause animation", [] {
+        if (clips.empty()) return;
         animationPlaying = !animationPlaying;
         if (animationPlaying) observer.setVelocity(0, 0, 0);
+        if (animationPlaying && timeline.isDone()) timeline.rewind();
     }),
     Key(GLUT_KEY_LEFT, "Left Arrow", "Go to previous animation", [] {
-        currentAnimation = ((currentAnimation - 1) % (int) animations.size() + animations.size()) % (int) animations.size();
-        animations[currentAnimation].reset();
+        if (clips.empty()) return;
+        currentAnimation = (currentAnimation + clips.size() - 1) % clips.size();
+        timeline.setAnimation(&clips[currentAnimation]);
         animationPlaying = false;
     }),
     Key(GLUT_KEY_RIGHT, "Right Arrow", "Go to next animation", [] {
-        currentAnimation = (currentAnimation + 1) % animations.size();
-        animations[currentAnimation].reset();
+        if (clips.empty()) return;
+        currentAnimation = (currentAnimation + 1) % clips.size();
+        timeline.setAnimation(&clips[currentAnimation]);
         animationPlaying = false;
     }),
-    Key((char) 27, "ESC", "Exit", [] { exit(0); }),
+    Key(GLUT_KEY_DOWN, "Down Arrow", "Reverse animation", [] { timeline.reverse(); }),
+    Key(',', "Rewind animation by a second", [] {
+        if (!clips.empty()) timeline.seek(timeline.getTime() - 1000);
+    }),
+    Key('.', "Fast-forward animation by a second", [] {
+        if (!clips.empty()) timeline.seek(timeline.getTime() + 1000);
+    }),
+    Key('[', "Slow down animation", [] { timeline.setScale(std::max(std::abs(timeline.getScale()) / 2, 0.125) * (timeline.getScale() < 0 ? -1 : 1)); }),
+    Key(']', "Speed up animation", [] { timeline.setScale(std::min(std::abs(timeline.getScale()) * 2, 8.) * (timeline.getScale() < 0 ? -1 : 1)); }),
+    Key('R', "Start/stop recording", [] {
+        // frames the writer can't keep up with are dropped, at a nominal rate since the window's varies
+        if (!recorder.isRecording()) {
+            if (recorder.start(recordingPath, screenWidth, screenHeight, 60, false)) std::cout << "recording to " << recordingPath << std::endl;
+        } else {
+            recorder.stop();
+            std::cout << "recorded " << recorder.getFrameCount() << " frames, dropped " << recorder.getDroppedCount() << std::endl;
+        }
+    }),
+    Key((char) 27, "ESC", "Exit", [] {
+        if (recorder.isRecording()) recorder.stop();
+        exit(0);
+    }),
 };
 
 /* INITIALIZATION FUNCTIONS */
@@ -151,35 +220,76 @@ std::string readFile(std::string path) {
     return stream.str();
 }
 
-void loadTexture(GLuint *texture, std::string filename) {
-    glGenTextures(1, texture);
-    glBindTexture(GL_TEXTURE_2D, *texture);
-    RgbImage img;
-    img.LoadBmpFile(filename.c_str());
+void initializeTextures() {
     glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexImage2D(GL_TEXTURE_2D, 0, 3, img.GetNumCols(), img.GetNumRows(), 0, GL_RGB, GL_UNSIGNED_BYTE, img.ImageData());
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // textures load in the background, drawn as a placeholder until they are in
+    Resources::initialize(textureSampling);
+    // a texture compressed offline is taken over its bitmap, a ktx2 one over a dds one
+    auto find = [](std::string base) {
+        std::string path = base + ".bmp";
+        for (std::string extension : {".dds", ".ktx2"}) {
+            if (std::filesystem::exists(base + extension)) path = base + extension;
+        }
+        return path;
+    };
+    for (std::string name : sceneFile.getTextureNames()) sceneContext.textures[name] = Resources::loadTexture(find("res/textures/" + name));
+    // the sky's faces, as tools/cubemap cuts them out of a panorama
+    std::vector<std::string> faces;
+    for (std::string face : {"px", "nx", "py", "ny", "pz", "nz"}) faces.push_back(find("res/textures/skybox_" + face));
+    skyboxTexture = Resources::loadCubeMap(faces);
 }
 
-void initializeTextures() {
-    for (std::string name : {"skybox"}) {
-        loadTexture(&textures[name], "res/textures/" + name + ".bmp");
+void initializeScene() {
+    // compiled scenes are mapped as they are, anything else is taken as text
+    std::ifstream file(scenePath, std::ios::binary);
+    char magic[4] = {};
+    file.read(magic, sizeof magic);
+    file.close();
+    bool loaded = std::string(magic, sizeof magic) == "SCNE" ? sceneFile.load(scenePath) : sceneFile.compile(readFile(scenePath));
+    if (!loaded) {
+        std::cerr << "couldn't load scene " << scenePath << std::endl;
+        exit(1);
     }
+    if (!sceneSavePath.empty()) sceneFile.save(sceneSavePath);
+
+    auto setObserverX = [](double x) { observer.setX(x); };
+    auto setObserverY = [](double y) { observer.setY(y); };
+    auto setObserverZ = [](double z) { observer.setZ(z); };
+    auto setObserverTheta = [](double theta) { observer.setTheta(theta); observer.updateVectors(); };
+    auto setObserverPhi = [](double phi) { observer.setPhi(phi); observer.updateVectors(); };
+    sceneContext.bindings = {
+        {"valveAngle", &valveAngle},
+        {"lockProgress", &lockProgress},
+        {"doorAngle", &doorAngle},
+        {"solidness", &solidness},
+        {"skyboxAngle", &skyboxAngle},
+        {"observerX", setObserverX},
+        {"observerY", setObserverY},
+        {"observerZ", setObserverZ},
+        {"observerTheta", setObserverTheta},
+        {"observerPhi", setObserverPhi},
+    };
+    // read reactively, except for the observer, which is polled on every frame
+    sceneContext.variables = {
+        {"valveAngle", [] { return Reactive::read(&valveAngle); }},
+        {"lockProgress", [] { return Reactive::read(&lockProgress); }},
+        {"doorAngle", [] { return Reactive::read(&doorAngle); }},
+        {"solidness", [] { return Reactive::read(&solidness); }},
+        {"skyboxAngle", [] { return Reactive::read(&skyboxAngle); }},
+        {"meshOn", [] { return (GLfloat) Reactive::read(&meshOn); }},
+        {"flashlightOn", [] { return (GLfloat) Reactive::read(&flashlightOn); }},
+        {"observerX", [] { return observer.getPosition().x; }},
+        {"observerY", [] { return observer.getPosition().y; }},
+        {"observerZ", [] { return observer.getPosition().z; }},
+        {"frontX", [] { return observer.getFrontVector().x; }},
+        {"frontY", [] { return observer.getFrontVector().y; }},
+        {"frontZ", [] { return observer.getFrontVector().z; }},
+    };
+    sceneContext.scheduler = &interactions;
 }
 
 void initializeLights() {
-    // ambient light
-    const GLfloat ambient[] = {0.1, 0.1, 0.1, 1};
-    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, ambient);
-    // point light
-    lights.emplace_back(new DirectionalLight(ColorRGBA{0.4, 0.4, 0.4, 1}, ColorRGBA{0.2, 0.2, 0.2, 1}, [] { GLfloat plusOffset = (skyboxAngle + 22) * M_PI / 180; return Coordinates3D{(GLfloat) sin(plusOffset), 1, (GLfloat) cos(plusOffset)}; }));
-    // flashlight
-    lights.emplace_back(new SpotLight(
-        ColorRGBA{1, 1, 1, 1}, ColorRGBA{1, 1, 1, 1}, [] { return observer.getPosition() - observer.getFrontVector(); }, [] { return observer.getFrontVector(); }, 20, 1, {1, 0.05, 0.025}, &flashlightOn));
+    sceneFile.createLights(sceneContext, lights);
 }
 
 void initializeShaders() {
@@ -192,405 +302,112 @@ void initializeShaders() {
         std::transform(lights.begin(), lights.end(), std::back_inserter(lightsOn), [](auto &light) { return light->isOn(); });
         return lightsOn;
     });
-    shaders.emplace("phong", Shader(readFile("res/shaders/phong.vert"), readFile("res/shaders/phong.frag"), {{"maxLights", DynamicValue<int>(lights.size())}, {"lightsOn", lightsOn}, {"solidness", DynamicValue<float>(&solidness)}}));
-    shaders.emplace("gouraud", Shader(readFile("res/shaders/gouraud.vert"), readFile("res/shaders/gouraud.frag"), {{"maxLights", DynamicValue<int>(lights.size())}, {"lightsOn", lightsOn}}));
+    phongShader = Resources::addShader(new Shader(readFile("res/shaders/phong.vert"), readFile("res/shaders/phong.frag"), {{"maxLights", DynamicValue<int>(lights.size())}, {"lightsOn", lightsOn}, {"solidness", DynamicValue<float>(&solidness)}, {"materials", DynamicValue<int>(2)}}));
+    gouraudShader = Resources::addShader(new Shader(readFile("res/shaders/gouraud.vert"), readFile("res/shaders/gouraud.frag"), {{"maxLights", DynamicValue<int>(lights.size())}, {"lightsOn", lightsOn}}));
+    // load depth pre-pass shader
+    depthShader = Resources::addShader(new Shader(readFile("res/shaders/depth.vert"), readFile("res/shaders/depth.frag")));
+    // load sky shader
+    skyboxShader = Resources::addShader(new Shader(readFile("res/shaders/skybox.vert"), readFile("res/shaders/skybox.frag")));
+    // load picking shader
+    pickShader = Resources::addShader(new Shader(readFile("res/shaders/pick.vert"), readFile("res/shaders/pick.frag")));
+    // load instancing shader, which needs buffer textures, only when something is instanced
+    if (instancedValves > 0) {
+        instancedShader = Resources::addShader(new Shader(readFile("res/shaders/instanced.vert"), readFile("res/shaders/phong.frag"),
+                                                          {{"maxLights", DynamicValue<int>(lights.size())}, {"lightsOn", lightsOn}, {"solidness", DynamicValue<float>(&solidness)},
+                                                           {"materials", DynamicValue<int>(2)}, {"keyframes", DynamicValue<int>(1)}, {"time", DynamicValue<float>(&instanceTime)}}));
+        // and its depth-only variant for the pre-pass, which places instances the same way and shades nothing
+        instancedDepthShader = Resources::addShader(new Shader(readFile("res/shaders/instanced.vert"), readFile("res/shaders/depth.frag"),
+                                                               {{"keyframes", DynamicValue<int>(1)}, {"time", DynamicValue<float>(&instanceTime)}}));
+    }
+    currentShader = phongShader;
 }
 
-void initializeShapes() {
-    skybox = std::unique_ptr<Shape>((new Sphere(1, 20))->setTexture(textures["skybox"])->rotate([](Coordinates3D &parameters) { parameters = {0, skyboxAngle, 0}; }));
-
-    // clang-format off
-    auto valve = new CompoundShape{
-        // stem
-        (new CompoundShape{
-            (new PrismWall(0.1, 1, 40))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(4)
-                ->setMaterial(WHITE_METAL),
-            (new Sphere(0.1, 20, 0, 10, 0, 20))
-                ->setMaterial(WHITE_METAL)
-                ->translate({0, 0, 0.5})
-        }),
-        // wheel
-        (new CompoundShape{
-            // ring
-            (new Donut(0.6, 0.8, 41, 10))
-                ->setMaterial(RED_METAL)
-                ->setColor({RED}),
-            // spokes
-            (new PrismWall(0.05, 0.7, 15, 0, 15))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(4)
-                ->setMaterial(YELLOW_METAL)
-                ->setColor({YELLOW})
-                ->clone(3, [](int index, Shape *spoke) {
-                    return spoke
-                        ->rotate({0, (GLfloat) index * 360 / 3, 0})
-                        ->translate({0, 0, 0.35});
-                })
-                ->rotate({-90, 0, 0})
-        })->translate({0, 0, 0.45})
-    };
-    
-    auto window = new CompoundShape{
-        // border
-        (new Ring(0.8, 1, 0.1, 40))
-            ->setMeshEnabled(&meshOn)
-            ->setMeshLevel(3)
-            ->setMaterial(DARK_GRAY_METAL)
-            ->setColor({WHITE}),
-        // bolts
-        (new Sphere(0.05, 16, 0, 8, 0, 16))
-            ->setMaterial(SILVER)
-            ->setColor({YELLOW})
-            ->clone(10, [](int index, Shape *bolt) {
-                return bolt
-                    ->rotate({0, (GLfloat) index * 360 / 10, 0})
-                    ->translate({0, 0, 0.9})
-                    ->rotate({90, 0, 0});
-            })
-            ->translate({0, 0, 0.05})
-            ->rotate({-90, 0, 0}),
-        // glass
-        (new Sphere(0.8, 40, 0, 20, 0, 40))
-            ->setMaterial(GLASS)
-            ->setColor({TRANSPARENT_BLUE})
-            ->scale({1, 1, 0.35})
-    };
-
-    auto hinge = new CompoundShape{
-        // pin
-        (new PrismWall(0.4, 1.2, 16, 0, 16))
-            ->setMaterial(RED_METAL)
-            ->setColor({RED}),
-        // pin ends
-        (new Donut(0.4, 1.2, 20, 5, 5, 16, 0, 16))
-            ->setMaterial(RED_METAL)
-            ->setColor({RED})
-            ->translate({0, 0.8, 0})
-            ->rotate({90, 90, 0})
-            ->clone(2, [](int index, Shape *pinEnd) {
-                return pinEnd
-                    ->translate({0, (GLfloat) (0.6 - (1.2 * (index == 0))), 0})
-                    ->rotate({(GLfloat) 180 * (index == 0), 0, 0});
-            }),
-        // kuckles
-        (new CompoundShape{
-            (new Ring(0.4, 0.5, 0.5, 16, 0, 16))
-                ->setMaterial(YELLOW_METAL)
-                ->setColor({YELLOW}),
-            (new Donut(0.6, 1, 20, 15, 5, 16, 0, 16))
-                ->setMaterial(YELLOW_METAL)
-                ->setColor({YELLOW})
-                ->translate({0.4, 0.8, 0})
-        })->clone(2, [](int index, Shape *knuckle) {
-            return knuckle
-                ->rotate([](Coordinates3D &parameters) { parameters = {0, 0, -doorAngle}; })
-                ->translate({0, 0, (GLfloat) (0.35 - (0.7 * (index == 0)))});
-        })
-    };
+void initializePicking() {
+    picker.initialize(pickShader);
+}
 
-    auto lock = new CompoundShape{
-        (new CompoundShape{
-            (new PrismWall(0.25, 1, 20))->setMaterial(WHITE_METAL),
-            (new Sphere(0.25, 10, 0, 5, 0, 10))
-                ->setMaterial(WHITE_METAL)
-                ->translate({0, 0, 0.5})
-        })
-            ->clone(5, [](int i, Shape *cylinder) {
-                return cylinder
-                    ->translate([i](Coordinates3D &parameters) {
-                        parameters = {0, -0.7f * i, (lockProgress >= (i + 0.) / 5) * ((lockProgress >= (i + 1.f) / 5) ? 1 : (lockProgress * 5 - i))};
-                    });
-            })
-            ->rotate({0, 90, 0})
-            ->translate({0, 1.4, -0.5})
-    };
+void initializeSkybox() {
+    skybox.initialize(skyboxTexture, skyboxShader);
+}
 
-    auto frame = new CompoundShape{
-        // side bars
-        (new CompoundShape{
-            (new Cuboid(0.26, 1.6, 0.06))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(6)
-                ->setMaterial(DARK_GRAY_METAL),
-            (new Cuboid(0.10, 1.6, 0.02))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(6)
-                ->setMaterial(DARK_GRAY_METAL)
-                ->translate({-0.18, 0, -0.02})
-        })->clone(2, [](int index, Shape *bar) {
-            return bar
-                ->translate({(0.8f - (1.6f * (index == 0))), 0, 0})
-                ->rotate({0, 0, 180.f * (index == 0)});
-        }),
-        // side bolts
-        (new Sphere(0.06, 20, 0, 10, 0, 20))
-            ->setColor({YELLOW})
-            ->setMaterial(SILVER)
-            ->clone(2, [](int i, Shape *bolt) {
-                return (Shape *) bolt
-                    ->translate({(0.8f - (1.6f * (i == 0))), 0, 0})
-                    ->clone(2 + 2 * i, [i](int j, Shape *bolt) {
-                        return bolt->translate({0, 0.65f - 1.3f * (j + (i == 0)) / 3, 0});
-                    });
-            })
-            ->translate({0, 0, 0.03}),
-        // top/bottom bars & bolts
-        (new CompoundShape{
-            // bar
-            (new Ring(0.67, 0.93, 0.06, 40, 0, 20))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(6)
-                ->setMaterial(DARK_GRAY_METAL),
-            (new Ring(0.57, 0.67, 0.02, 40, 0, 20))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(6)
-                ->setMaterial(DARK_GRAY_METAL)
-                ->translate({0, 0, -0.02}),
-            // bolts
-            (new Sphere(0.06, 20, 0, 10, 0, 20))
-                ->setColor({YELLOW})
-                ->setMaterial(SILVER)
-                ->clone(4, [](int index, Shape *bolt) {
-                    return bolt
-                        ->rotate({0, (index + 1.f) * 180 / 5 - 90, 0})
-                        ->translate({0, 0, 0.8})
-                        ->rotate({90, 0, 0});
-                })
-                ->translate({0, 0, 0.03})
-                ->rotate({-90, 0, 0})
-        })->clone(2, [](int index, Shape *bar) {
-            return bar
-                ->translate({0, (0.8f - (1.6f * (index == 0))), 0})
-                ->rotate({180.f * (index == 0), 180.f * (index == 0), 0});
-        })
-    };
+void initializeShapes() {
+    scene = std::unique_ptr<Shape>(sceneFile.createShape("scene", sceneContext));
+    if (!scene) {
+        std::cerr << "scene " << scenePath << " has no scene" << std::endl;
+        exit(1);
+    }
 
-    auto panel = new CompoundShape{
-        // middle panel
-        new CompoundShape{
-            (new Cuboid(1.28, 1.6, 0.04))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(6)
-                ->setMaterial(GRAY_METAL)
-                ->setColor({GREEN})
-                ->translate({0, 0, 0.04}),
-            (new Cuboid(1.04, 1.6, 0.17))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(6)
-                ->setMaterial(GRAY_METAL)
-                ->setColor({BLUE})
-                ->translate({0, 0, -0.065})
-        },
-        // top/bottom panels
-        (new CompoundShape{
-            (new Ring(0, 0.64, 0.04, 40, 0, 20))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(5)
-                ->setMaterial(GRAY_METAL)
-                ->setColor({GREEN})
-                ->translate({0, 0, 0.04}),
-            (new Ring(0, 0.52, 0.17, 40, 0, 20))
-                ->setMeshEnabled(&meshOn)
-                ->setMeshLevel(5)
-                ->setMaterial(GRAY_METAL)
-                ->setColor({BLUE})
-                ->translate({0, 0, -0.065})
-        })->clone(2, [](int i, Shape *panel) {
-            return panel
-                ->translate({0, (0.8f - (1.6f * (i == 0))), 0})
-                ->rotate({0, 0, 180.f * (i == 0)})
-                ;
-        })
-    };
+    // a wall of valve wheels spinning one after the other, where the cpu only ever sets when each one started
+    if (instancedValves > 0) {
+        auto wheels = new InstancedShape(new Donut(0.6, 0.8, 41, 10), instancedShader, instancedDepthShader);
+        int spin = wheels->addAnimation({KeyframeTrack(TrackKind::Rotation, {{0, {0, 0, 0}}, {2100, {0, 0, 360}, Ease::cubicInOut}}, true)});
+        int columns = std::ceil(std::sqrt(instancedValves));
+        for (int i = 0; i < instancedValves; ++i) {
+            int instance = wheels->addInstance(Matrix4::translation({(i % columns - columns / 2.f) * 2, (GLfloat) (i / columns) * 2, -12}), spin);
+            wheels->start(instance, i * 7.f);
+        }
+        scene = std::unique_ptr<Shape>(new CompoundShape{scene.release(), wheels->setMaterial(RED_METAL)->setColor({RED})});
+    }
+}
 
-    scene = std::unique_ptr<Shape>((new CompoundShape{
-        frame->translate({0, 0, 0.03}),
-        hinge
-            ->translate({-0.75, 0, 0.06})
-            ->scale({0.12, 0.12, 0.12})
-            ->translate({0, 0, 0.8})
-            ->rotate({-90, 0, 0})
-            ->clone(2, [](int i, Shape *hinge) {
-                return hinge ->translate({0, 0, 5.f - 10.f * (i == 0)});
-            }),
-        (new CompoundShape{
-            panel,
-            window
-                ->translate({0, 0.8, 0.06})
-                ->scale({0.35, 0.35, 0.35})
-                ->translate({0, 0, 0.05}),
-            valve
-                ->translate({0.4, 0, 0.06})
-                ->scale({0.3, 0.3, 0.3})
-                ->translate({0, 0, 0.5})
-                ->rotate([](Coordinates3D &parameters) { parameters = {0, 0, valveAngle}; }),
-            lock
-                ->translate({0.52, 0, -0.025})
-                ->scale({0.1, 0.1, 0.1})
-        })
-            ->translate({-0.75, 0, 0.156})
-            ->rotate([](Coordinates3D &parameters) { parameters = {0, -doorAngle, 0}; })
-            ->translate({0.75, 0, -0.156})
-    })->scale({4, 4, 4}));
-    
-    // clang-format on
+void initializeCollisions() {
+    collisions.build(*scene);
+    observer.setCollisions(&collisions, observerRadius);
 }
 
 void initializeAnimations() {
-    auto setObserverX = [](double x) { observer.setX(x); };
-    auto setObserverY = [](double y) { observer.setY(y); };
-    auto setObserverZ = [](double z) { observer.setZ(z); };
-    auto setObserverTheta = [](double theta) { observer.setTheta(theta); observer.updateVectors(); };
-    auto setObserverPhi = [](double phi) { observer.setPhi(phi); observer.updateVectors(); };
-    animations = {
-        {
-            // maintain valve unrotated
-            Animation(1050, 0, &valveAngle),
-            // maintain lock closed
-            Animation(1050, 1, &lockProgress),
-            // maintain door closed
-            Animation(15050, 0, &doorAngle),
-            // go to valve
-            Animation(1050, 0, 3.7245, Ease::quinticInOut, setObserverX),
-            Animation(1050, 0, 0.4326, Ease::quinticInOut, setObserverY),
-            Animation(1050, 14, 5.2588, Ease::quinticInOut, setObserverZ),
-            Animation(1050, 3 * M_PI_2, -2.0418 + 2 * M_PI, Ease::quinticInOut, setObserverTheta),
-            Animation(1050, 0, -0.1119, Ease::quinticInOut, setObserverPhi),
-            // maintain spectator position
-            Animation(1050, 2450, 3.7245, setObserverX),
-            Animation(1050, 2450, 0.4326, setObserverY),
-            Animation(1050, 2450, 5.2588, setObserverZ),
-            Animation(1050, 2450, -2.0418, setObserverTheta),
-            Animation(1050, 2450, -0.1119, setObserverPhi),
-            // spin valve
-            Animation(1050, 6475, 0, 5400, Ease::cubicIn, &valveAngle),
-            Animation(7525, 6475, 0, 360, Ease::cubicOut, &valveAngle),
-            // maintain valve unrotated
-            Animation(14000, 4900, 0, &valveAngle),
-            // open lock
-            Animation(1050, 12950, 1, 0, Ease::sinusoidalInOut, &lockProgress),
-            // maintain lock open
-            Animation(14000, 4900, 0, &lockProgress),
-            // go to lock
-            Animation(3500, 525, 3.7245, 5, Ease::quinticIn, setObserverX),
-            Animation(4025, 525, 5, 3.3553, Ease::quinticOut, setObserverX),
-            Animation(3500, 525, 0.4326, 0.1760, Ease::quinticIn, setObserverY),
-            Animation(4025, 525, 0.1760, -0.0807, Ease::quinticOut, setObserverY),
-            Animation(3500, 525, 5.2588, -0.1430, Ease::quinticIn, setObserverZ),
-            Animation(4025, 525, -0.1430, -3.6262, Ease::quinticOut, setObserverZ),
-            Animation(3500, 525, -2.0418, -4.3809, Ease::quinticIn, setObserverTheta),
-            Animation(3500, 525, -0.1119, -0.0318, Ease::quinticIn, setObserverPhi),
-            // maintain spectator position
-            Animation(4550, 2450, 3.3553, setObserverX),
-            Animation(4550, 2450, -0.0807, setObserverY),
-            Animation(4550, 2450, -3.6262, setObserverZ),
-            Animation(4550, 2450, -4.3809, setObserverTheta),
-            Animation(4550, 2450, -0.0318, setObserverPhi),
-            // go to top position
-            Animation(7000, 525, 3.3553, 5, Ease::quinticIn, setObserverX),
-            Animation(7525, 525, 5, 6.5451, Ease::quinticOut, setObserverX),
-            Animation(7000, 525, -0.0807, 0.1760, Ease::quinticIn, setObserverY),
-            Animation(7525, 525, 0.1760, 2.6621, Ease::quinticOut, setObserverY),
-            Animation(7000, 525, -3.6262, -0.1430, Ease::quinticIn, setObserverZ),
-            Animation(7525, 525, -0.1430, 8.3658, Ease::quinticOut, setObserverZ),
-            Animation(7000, 1050, -4.3809, -2.1264, Ease::quinticInOut, setObserverTheta),
-            Animation(7000, 1050, -0.0318, -0.1854, Ease::quinticInOut, setObserverPhi),
-            // maintain spectator position
-            Animation(8050, 5600, 6.5451, setObserverX),
-            Animation(8050, 5600, 2.6621, setObserverY),
-            Animation(8050, 5600, 8.3658, setObserverZ),
-            Animation(8050, 5600, -2.1264, setObserverTheta),
-            Animation(8050, 5600, -0.1854, setObserverPhi),
-            // go to initial position
-            Animation(13650, 1050, 6.5451, 0, Ease::quinticInOut, setObserverX),
-            Animation(13650, 1050, 2.6621, 2.6621, Ease::quinticInOut, setObserverY),
-            Animation(13650, 1050, 8.3658, 14, Ease::quinticInOut, setObserverZ),
-            Animation(13650, 1050, -2.1264, 3 * M_PI_2 - 2 * M_PI, Ease::quinticInOut, setObserverTheta),
-            Animation(13650, 1050, -0.1854, -0.1854, Ease::quinticInOut, setObserverPhi),
-            // maintain spectator position
-            Animation(14700, 4200, 0, setObserverX),
-            Animation(14700, 4200, 2.6621, setObserverY),
-            Animation(14700, 4200, 14, setObserverZ),
-            Animation(14700, 4200, 3 * M_PI_2, setObserverTheta),
-            Animation(14700, 4200, -0.1854, setObserverPhi),
-            // open door
-            Animation(15050, 1050, 0, 135, Ease::quinticInOut, &doorAngle),
-            // maintain door open
-            Animation(16100, 2800, 135, &doorAngle),
-            // go through door
-            Animation(16800, 2100, 0, 0, Ease::quinticInOut, setObserverX),
-            Animation(16800, 2100, 2.6621, 0, Ease::quinticInOut, setObserverY),
-            Animation(16800, 2100, 14, -14, Ease::quinticInOut, setObserverZ),
-            Animation(16800, 2100, 3 * M_PI_2, M_PI_2, Ease::quinticInOut, setObserverTheta),
-            Animation(16800, 2100, -0.1854, 0, Ease::quinticInOut, setObserverPhi),
-        },
-        {
-            Animation(150, 0, 14, Ease::sinusoidalOut, setObserverX),
-            Animation(150, 150, 14, 0, Ease::sinusoidalIn, setObserverX),
-            Animation(300, 150, 0, -14, Ease::sinusoidalOut, setObserverX),
-            Animation(450, 150, -14, 0, Ease::sinusoidalIn, setObserverX),
-            Animation(600, 0, setObserverY),
-            Animation(150, 14, 0, Ease::sinusoidalIn, setObserverZ),
-            Animation(150, 150, 0, -14, Ease::sinusoidalOut, setObserverZ),
-            Animation(300, 150, -14, 0, Ease::sinusoidalIn, setObserverZ),
-            Animation(450, 150, 0, 14, Ease::sinusoidalOut, setObserverZ),
-            Animation(600, 3 * M_PI_2, -M_PI_2, Ease::linear, setObserverTheta),
-            Animation(600, 0, setObserverPhi),
-        },
-        {
-            Animation(3100, 0, setObserverX),
-            Animation(3100, 0, setObserverY),
-            Animation(3100, 14, setObserverZ),
-            Animation(3100, -M_PI_2, setObserverTheta),
-            Animation(3100, 0, setObserverPhi),
-            Animation(1050, 0, 135, Ease::quinticInOut, &doorAngle),
-            Animation(1050, 1000, 135, &doorAngle),
-            Animation(2050, 1050, 135, 0, Ease::quinticInOut, &doorAngle),
-        },
-        {
-            Animation(1050, 1, 0, Ease::quinticInOut, &solidness),
-            Animation(1050, 1000, 0, &solidness),
-            Animation(2050, 1050, 0, 1, Ease::quinticInOut, &solidness),
-        },
-        {
-            Animation(5000, 0, 360, Ease::quinticInOut, &skyboxAngle),
-        }};
+    animations = sceneFile.createAnimations(sceneContext);
+
+    // compile each group into a clip, unless it was saved before
+    const std::vector<Binding> &bindings = sceneContext.bindings;
+    for (size_t i = 0; i < animations.size(); ++i) {
+        AnimationClip clip;
+        if (!clipsLoadPath.empty() && clip.load(clipsLoadPath + "/" + std::to_string(i) + ".anim")) {
+            clip.bind(bindings);
+        } else if (!clip.compile(animations[i], bindings)) {
+            std::cerr << "animation " << i << " writes to values that aren't bound, it is left out" << std::endl;
+            continue;
+        }
+        if (!clipsSavePath.empty()) clip.save(clipsSavePath + "/" + std::to_string(i) + ".anim");
+        clips.push_back(clip);
+    }
+    if (!clips.empty()) timeline.setAnimation(&clips[currentAnimation]);
 }
 
 /* KEYBOARD/MOUSE EVENT FUNCTIONS */
 
+// events are only queued here, the frame acts on them
+
 template <class T>
 void onKeyDown(T value, int x, int y) {
-    for (const auto &key : keys) {
-        if (key == value) {
-            key.down();
-            break;
-        }
-    }
+    input.keyDown(Key::getSlot(value));
 }
 
 template <class T>
 void onKeyUp(T value, int x, int y) {
-    for (const auto &key : keys) {
-        if (key == value) {
-            key.up();
-            break;
-        }
-    }
+    input.keyUp(Key::getSlot(value));
 }
 
 void onMouseMove(int x, int y) {
-    glutWarpPointer(screenCenterX, screenCenterY);
-    if (!animationPlaying) {
-        observer.moveCamera(x - screenCenterX, y - screenCenterY);
+    input.move(x, y);
+    // the pointer is only brought back once it strays halfway to the window's edge, since every warp is one more
+    // motion event
+    if (std::abs(x - screenCenterX) > screenCenterX / 2 || std::abs(y - screenCenterY) > screenCenterY / 2) {
+        glutWarpPointer(screenCenterX, screenCenterY);
+        input.warp(screenCenterX, screenCenterY);
     }
 }
 
 void onMouseClick(int button, int state, int x, int y) {
     if (state == GLUT_UP) return;
+    input.button(button, x, y);
+}
+
+void click(int button, int x, int y) {
     switch (button) {
+        case GLUT_LEFT_BUTTON:
+            picker.request(x, y);
+            break;
         case 3:
             if (fov < 179) fov++;
             break;
@@ -638,26 +455,37 @@ void drawText(const char *text, GLint x, GLint y) {
 void display() {
     // fps calculation
     currentFrameTime = std::chrono::steady_clock::now();
-    unsigned long delta = std::chrono::duration_cast<std::chrono::microseconds>(currentFrameTime - lastFrameTime).count();
+    // headless frames are a fixed step apart, however long they take to draw
+    unsigned long delta = headless ? headlessStep * 1000 : std::chrono::duration_cast<std::chrono::microseconds>(currentFrameTime - lastFrameTime).count();
     fps = 1000000.0 / delta;
     lastFrameTime = currentFrameTime;
 
+    // keys and clicks since the last frame
+    input.dispatch(click);
+
     // observer changes
     if (animationPlaying) {
-        animations[currentAnimation].tick(delta / 1000);
-        if (animations[currentAnimation].isDone()) {
-            animations[currentAnimation].reset();
-            animationPlaying = false;
-        }
+        timeline.tick(delta / 1000.);
+        if (timeline.isDone()) animationPlaying = false;
     } else {
         observer.applyForce(
             (forwardKeyPressed - backwardKeyPressed) * (rightwardKeyPressed == leftwardKeyPressed ? 1 : M_SQRT1_2),
             (rightwardKeyPressed - leftwardKeyPressed) * (forwardKeyPressed == backwardKeyPressed ? 1 : M_SQRT1_2));
+        collisions.update();
         observer.tick(delta / 1000);
     }
 
+    // object interactions
+    interactions.tick(delta / 1000);
+    instanceTime += delta / 1000.f;
+
+    // textures decoded since the last frame go up, a few levels at a time
+    Resources::update();
+    // and materials that were added or changed, to the table the phong shader reads on texture unit 2
+    Materials::upload(GL_TEXTURE2);
+
     // clear & set viewport
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     glViewport(0, 0, screenWidth, screenHeight);
 
     // enter 2D rendering
@@ -675,13 +503,18 @@ void display() {
         debugInfo
             << "FPS: " << std::fixed << std::setprecision(0) << fps << std::endl
             << "FOV: " << fov << std::endl
-            << "animation: " << currentAnimation << std::endl
+            << "animation: " << currentAnimation << " (" << std::setprecision(1) << timeline.getTime() / 1000 << " s, x" << std::setprecision(3) << timeline.getScale() << ")" << std::endl
             << "x: " << std::setprecision(4) << observer.getPosition().x << " (" << std::showpos << observer.getVelocity().x << std::noshowpos << ")" << std::endl
             << "y: " << observer.getPosition().y << " (" << std::showpos << observer.getVelocity().y << std::noshowpos << ")" << std::endl
             << "z: " << observer.getPosition().z << " (" << std::showpos << observer.getVelocity().z << std::noshowpos << ")" << std::endl
             << "theta: " << observer.getAngle().theta << std::endl
             << "phi: " << observer.getAngle().phi << std::endl
-            << "flashlight: " << flashlightOn << std::endl;
+            << "flashlight: " << flashlightOn << std::endl
+            << "input latency: " << std::setprecision(2) << input.getLatency() << " ms" << std::endl
+            << "depth pre-pass: " << depthPrepassOn << std::endl
+            << "draws: " << drawQueue.getOpaqueCount() << " opaque, " << drawQueue.getTransparentCount() << " see-through" << std::endl
+            << "materials: " << Materials::getCount() << std::endl
+            << "loading: " << Resources::getPendingCount() << std::endl;
         drawText(debugInfo.str().c_str(), 10, screenHeight - 20);
     }
 
@@ -691,12 +524,13 @@ void display() {
         instructions
             << "Controls:" << std::endl
             << "[Move mouse] Look around" << std::endl
+            << "[Left click] Use valve, lock or door" << std::endl
             << "[Scroll up] Increase FOV" << std::endl
             << "[Scroll down] Decrease FOV" << std::endl;
         for (const auto &key : keys) {
             instructions << "[" << key.getName() << "] " << key.getDescription() << std::endl;
         }
-        drawText(instructions.str().c_str(), 10, 10 + 15.5217391304 * (4 + keys.size()));
+        drawText(instructions.str().c_str(), 10, 10 + 15.5217391304 * (5 + keys.size()));
     }
 
     // leave 2D rendering
@@ -712,17 +546,15 @@ void display() {
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    // draw skybox
-    if (skyboxOn) {
-        glPushMatrix();
-        gluLookAt(0, 0, 0, observer.getFrontVector().x, observer.getFrontVector().y, observer.getFrontVector().z, 0, 1, 0);
-        glEnable(GL_TEXTURE_2D);
-        glDepthMask(GL_FALSE);
-        skybox->render();
-        glDisable(GL_TEXTURE_2D);
-        glDepthMask(GL_TRUE);
-        glPopMatrix();
+    // turn the camera by the pointer's latest motion, as close to placing it as can be
+    int motionX, motionY;
+    if (input.takeMotion(motionX, motionY) && !animationPlaying) {
+        observer.moveCamera(motionX, motionY);
+        observer.updateVectors();
     }
+    // everything that moves has moved, the camera last, so dynamic values read from here on are evaluated afresh; none
+    // are read above, where the observer's position and front vector would be polled before the turn
+    Reactive::advance();
 
     // set look at
     gluLookAt(
@@ -730,6 +562,14 @@ void display() {
         observer.getFocusPoint().x, observer.getFocusPoint().y, observer.getFocusPoint().z,
         0, 1, 0);
 
+    // draw the sky under everything while the scene is see-through and blends over it
+    bool skyLast = solidness >= 1;
+    if (skyboxOn && !skyLast) skybox.render(skyboxAngle);
+
+    // pick the clicked object, the answer arrives on a later frame
+    picker.render(*scene);
+    if (Shape *shape = picker.getPicked()) shape->click();
+
     // draw axes
     if (axesOn) drawAxes();
 
@@ -738,22 +578,69 @@ void display() {
 
     // turn on scene features
     if (lightingOn) glEnable(GL_LIGHTING);
-    if (!currentShader.empty()) shaders.at(currentShader).enable();
+    Shader *shader = Resources::getShader(currentShader);
+    if (shader) shader->enable();
     if (cullingOn) glEnable(GL_CULL_FACE);
 
     // render lights
     for (const auto &light : lights) light->render();
 
-    // render scene
-    scene->render();
+    // queue the scene, the opaque shapes to be drawn nearest first and the see-through ones farthest first
+    Matrix4 view;
+    glGetFloatv(GL_MODELVIEW_MATRIX, view.array);
+    drawQueue.clear();
+    scene->queue(drawQueue, view);
+    drawQueue.sort();
+    // only the phong shader reads the material table, the others need gl's material set for them
+    drawQueue.setFixedMaterials(currentShader != phongShader);
+
+    // render the opaque shapes; with the pre-pass, their depth goes first and costs no shading, and then they are
+    // shaded only where they are the nearest, once a pixel; while the whole scene fades everything blends, so there is
+    // nothing to lay down first
+    if (depthPrepassOn && solidness >= 1) {
+        if (Shader *depth = Resources::getShader(depthShader)) depth->enable();
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        drawQueue.drawOpaqueDepth();
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        if (shader) {
+            shader->enable();
+        } else {
+            Shader::clear();
+        }
+        // coplanar faces tie on depth and would all pass, the last drawn winning, so the first one to pass marks the
+        // pixel and the rest fail, as the first drawn wins without the pre-pass
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_EQUAL, 0, 1);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+        drawQueue.drawOpaque();
+        glDisable(GL_STENCIL_TEST);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    } else {
+        drawQueue.drawOpaque();
+    }
+
+    // otherwise the sky only where nothing opaque covers it, and under the see-through shapes, which don't write depth
+    if (skyboxOn && skyLast) {
+        skybox.render(skyboxAngle);
+        if (shader) shader->enable();
+    }
+
+    // render the see-through shapes over everything else
+    drawQueue.drawTransparent();
 
     // turn off scene features
     if (lightingOn) glDisable(GL_LIGHTING);
-    if (!currentShader.empty()) Shader::clear();
+    if (shader) Shader::clear();
     if (cullingOn) glDisable(GL_CULL_FACE);
 
+    // read the frame back for the recording, if there is one, before it is swapped away
+    recorder.capture();
+
     // swap buffers
-    glutSwapBuffers();
+    if (!headless) glutSwapBuffers();
 }
 
 /* TIMER FUNCTION */
@@ -763,24 +650,199 @@ void timer(int value) {
     glutTimerFunc(0, timer, 1);
 }
 
+/* HEADLESS FUNCTION */
+
+int runHeadless() {
+    if (headlessAnimation >= (int) clips.size()) {
+        std::cerr << "there is no animation " << headlessAnimation << std::endl;
+        return 1;
+    }
+    // frames must not depend on how long textures took to load
+    Resources::finish();
+    // shaders, caches and the driver settle on the first pose before anything is measured
+    if (benchmarking) {
+        benchmark.initialize();
+        for (int frame = 0; frame < benchmarkWarmup; ++frame) {
+            offscreen.bind();
+            display();
+        }
+    }
+
+    // an animation plays from its start and runs until it ends, unless there is a frame count
+    if (headlessAnimation >= 0) {
+        currentAnimation = headlessAnimation;
+        timeline.setAnimation(&clips[currentAnimation]);
+        animationPlaying = true;
+    }
+    // offline, every frame is waited for rather than dropped
+    if (!headlessOutput.empty() && !recorder.start(headlessOutput, screenWidth, screenHeight, 1000 / headlessStep, true)) return 1;
+    int frames = headlessFrames > 0 ? headlessFrames : 1;
+    for (int frame = 0; frame < frames || headlessFrames == 0 && animationPlaying; ++frame) {
+        offscreen.bind();
+        if (benchmarking) benchmark.begin();
+        display();
+        if (benchmarking) benchmark.end();
+    }
+    glFinish();
+    if (recorder.isRecording() && !recorder.stop()) return 1;
+    if (!benchmarking) return 0;
+
+    benchmark.finish();
+    benchmark.print(std::cout);
+    std::ostringstream step, size;
+    step << headlessStep;
+    size << screenWidth << "x" << screenHeight;
+    if (!benchmarkReport.empty()) {
+        benchmark.saveReport(benchmarkReport, {{"scene", scenePath}, {"animation", std::to_string(headlessAnimation)}, {"step", step.str()}, {"size", size.str()}, {"renderer", (const char *) glGetString(GL_RENDERER)}});
+    }
+    if (!benchmarkFrames.empty()) benchmark.saveFrames(benchmarkFrames);
+    // regressions fail the run, for scripts to notice
+    if (!benchmarkBaseline.empty() && !benchmark.compare(benchmarkBaseline, benchmarkTolerance / 100, std::cout)) return 2;
+    return 0;
+}
+
+/* CHECK FUNCTIONS */
+
+// every value the animations write to
+std::vector<GLfloat> getAnimatedValues() {
+    Coordinates3D position = observer.getPosition();
+    Angle3D angle = observer.getAngle();
+    return {valveAngle, lockProgress, doorAngle, solidness, skyboxAngle, position.x, position.y, position.z, angle.theta, angle.phi};
+}
+
+void setAnimatedValues(const std::vector<GLfloat> &values) {
+    valveAngle = values[0], lockProgress = values[1], doorAngle = values[2], solidness = values[3], skyboxAngle = values[4];
+    observer.setX(values[5]), observer.setY(values[6]), observer.setZ(values[7]), observer.setTheta(values[8]), observer.setPhi(values[9]);
+    observer.updateVectors();
+}
+
+// plays every animation as a sequence on a scheduler, and checks it leaves the values sampling the group does at each
+// millisecond
+int checkSequences() {
+    int mismatches = 0;
+    for (size_t i = 0; i < animations.size(); ++i) {
+        Scheduler scheduler;
+        scheduler.start(play(animations[i]));
+        for (unsigned long time = 0; time <= animations[i].getDuration() + 1; ++time) {
+            if (time > 0) scheduler.tick(1);
+            std::vector<GLfloat> played = getAnimatedValues();
+            animations[i].sample(time);
+            std::vector<GLfloat> sampled = getAnimatedValues();
+            if (played != sampled && mismatches++ < 10) std::cout << "animation " << i << " differs at " << time << " ms" << std::endl;
+            // the scheduler goes on from its own values
+            setAnimatedValues(played);
+        }
+    }
+    std::cout << mismatches << " mismatches" << std::endl;
+    return mismatches > 0;
+}
+
+/* OPTION FUNCTIONS */
+
+// position, normal and texture formats split by commas, such as half,octahedral,short
+bool readVertexFormat(const std::string &text, VertexFormat &format) {
+    static const std::map<std::string, PositionFormat> positions = {{"float", PositionFormat::Float}, {"half", PositionFormat::Half}, {"short", PositionFormat::Short}};
+    static const std::map<std::string, NormalFormat> normals = {{"float", NormalFormat::Float}, {"octahedral", NormalFormat::Octahedral}, {"analytic", NormalFormat::Analytic}};
+    static const std::map<std::string, TextureFormat> textures = {{"float", TextureFormat::Float}, {"short", TextureFormat::Short}};
+    std::istringstream stream(text);
+    std::string position, normal, texture;
+    std::getline(stream, position, ',');
+    std::getline(stream, normal, ',');
+    std::getline(stream, texture, ',');
+    if (!positions.count(position) || !normals.count(normal) || !textures.count(texture)) return false;
+    format = VertexFormat(positions.at(position), normals.at(normal), textures.at(texture));
+    return true;
+}
+
+// a whole argument as a number, leaving the value as it was when there is anything else in it
+template <typename T>
+bool readNumber(const std::string &text, T &value) {
+    std::istringstream stream(text);
+    T number;
+    if (!(stream >> number) || stream.peek() != EOF) return false;
+    value = number;
+    return true;
+}
+
 /* MAIN FUNCTION */
 
 int main(int argc, char **argv) {
-    // initialize glut
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
-    glutInitWindowSize(screenWidth, screenHeight);
-    glutInitWindowPosition(300, 100);
-    glutCreateWindow("uc2018280609@dei.uc.pt | Submarine Door");
+    // initialize glut, unless there is no window to open
+    benchmarking = std::find(argv + 1, argv + argc, std::string("--benchmark")) != argv + argc;
+    checkingSequences = std::find(argv + 1, argv + argc, std::string("--check-sequences")) != argv + argc;
+    headless = benchmarking || checkingSequences || std::find(argv + 1, argv + argc, std::string("--headless")) != argv + argc;
+    if (!headless) glutInit(&argc, argv);
+
+    // parse command line options (glut already removed its own)
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        // the value after the option, which must be a number
+        bool numeric = true;
+        auto number = [&](auto &value) { numeric = readNumber(argv[++i], value); };
+        if (option == "--mesh-report") SimpleShape::setMeshReport(&std::cout);
+        if (option == "--load-animations" && i + 1 < argc) clipsLoadPath = argv[++i];
+        if (option == "--save-animations" && i + 1 < argc) clipsSavePath = argv[++i];
+        if (option == "--valves" && i + 1 < argc) number(instancedValves);
+        if (option == "--scene" && i + 1 < argc) scenePath = argv[++i];
+        if (option == "--save-scene" && i + 1 < argc) sceneSavePath = argv[++i];
+        if (option == "--size" && i + 1 < argc) sscanf(argv[++i], "%dx%d", &screenWidth, &screenHeight);
+        if (option == "--frames" && i + 1 < argc) number(headlessFrames);
+        if (option == "--animation" && i + 1 < argc) number(headlessAnimation);
+        if (option == "--step" && i + 1 < argc) number(headlessStep);
+        if (option == "--output" && i + 1 < argc) headlessOutput = argv[++i];
+        if (option == "--record" && i + 1 < argc) recordingPath = argv[++i];
+        if (option == "--anisotropy" && i + 1 < argc) number(textureSampling.anisotropy);
+        if (option == "--no-mipmaps") textureSampling.mipmaps = false;
+        if (option == "--depth-prepass") depthPrepassOn = true;
+        if (option == "--vertex-format" && i + 1 < argc) {
+            VertexFormat format;
+            if (!readVertexFormat(argv[++i], format)) {
+                std::cerr << "there is no vertex format " << argv[i] << std::endl;
+                return 1;
+            }
+            SimpleShape::setDefaultVertexFormat(format);
+        }
+        // the animation to measure, unless it is given with --animation
+        if (option == "--benchmark" && i + 1 < argc && readNumber(argv[i + 1], headlessAnimation)) ++i;
+        if (option == "--warmup" && i + 1 < argc) number(benchmarkWarmup);
+        if (option == "--report" && i + 1 < argc) benchmarkReport = argv[++i];
+        if (option == "--frame-log" && i + 1 < argc) benchmarkFrames = argv[++i];
+        if (option == "--baseline" && i + 1 < argc) benchmarkBaseline = argv[++i];
+        if (option == "--tolerance" && i + 1 < argc) number(benchmarkTolerance);
+        if (!numeric) {
+            std::cerr << option << " takes a number, not " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (benchmarking && headlessAnimation < 0) {
+        std::cerr << "a benchmark plays an animation, give its index after --benchmark or with --animation" << std::endl;
+        return 1;
+    }
 
-    // initialize glew
-    glewInit();
+    // open the window and initialize glew, or make an offscreen context that does so itself; text needs glut, so
+    // headless frames go without it
+    if (headless) {
+        if (!offscreen.initialize(screenWidth, screenHeight)) return 1;
+        debugInfoOn = instructionsOn = false;
+    } else {
+        glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH | GLUT_STENCIL);
+        glutInitWindowSize(screenWidth, screenHeight);
+        glutInitWindowPosition(300, 100);
+        glutCreateWindow("uc2018280609@dei.uc.pt | Submarine Door");
+        glewInit();
+    }
+    screenCenterX = screenWidth / 2;
+    screenCenterY = screenHeight / 2;
 
     // initialize assets
+    initializeScene();
     initializeTextures();
     initializeLights();
     initializeShaders();
+    initializePicking();
+    initializeSkybox();
     initializeShapes();
+    initializeCollisions();
     initializeAnimations();
 
     // set clear color as black
@@ -795,16 +857,26 @@ int main(int argc, char **argv) {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    if (checkingSequences) return checkSequences();
+    if (headless) return runHeadless();
+
     // display functions
     glutDisplayFunc(display);
     glutReshapeFunc([](int width, int height) {
+        // a recording keeps the size it started with
+        if (recorder.isRecording() && (width != screenWidth || height != screenHeight)) {
+            recorder.stop();
+            std::cout << "the window was resized, recording stopped" << std::endl;
+        }
         screenWidth = width;
         screenHeight = height;
         screenCenterX = screenWidth / 2;
         screenCenterY = screenHeight / 2;
     });
 
-    // input functions
+    // input functions, the pointer starting at the center it is warped back to
+    input.setKeys(keys);
+    input.warp(screenCenterX, screenCenterY);
     glutKeyboardFunc(onKeyDown);
     glutSpecialFunc(onKeyDown);
     glutKeyboardUpFunc(onKeyUp);
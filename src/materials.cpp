@@ -0,0 +1,103 @@
+#include "materials.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "vertices.hpp"
+
+namespace {
+    // by their bytes, which is what the table holds
+    struct Less {
+        bool operator()(const Material &a, const Material &b) const { return std::memcmp(&a, &b, sizeof(Material)) < 0; }
+    };
+    static_assert(sizeof(Material) == 13 * sizeof(GLfloat), "materials must have no padding to compare");
+
+    std::vector<Material> materials = {{ColorRGBA{1, 1, 1, 1}, ColorRGBA{1, 1, 1, 1}, ColorRGBA{1, 1, 1, 1}, 0}};
+    std::map<Material, uint32_t, Less> interned = {{materials[0], 0}};
+    GLuint buffer = 0, texture = 0;
+    size_t capacity = 0;  // materials the buffer has room for
+    int changedFirst = 0, changedLast = 0;
+
+    void changed(uint32_t index) {
+        changedFirst = changedLast < 0 ? index : std::min(changedFirst, (int) index);
+        changedLast = std::max(changedLast, (int) index);
+    }
+}
+
+// namespace Materials
+
+uint32_t Materials::intern(const Material &material) {
+    auto existing = interned.find(material);
+    if (existing != interned.end()) return existing->second;
+    uint32_t index = create(material);
+    interned[material] = index;
+    return index;
+}
+
+uint32_t Materials::create(const Material &material) {
+    materials.push_back(material);
+    changed(materials.size() - 1);
+    return materials.size() - 1;
+}
+
+void Materials::update(uint32_t index, const Material &material) {
+    assert(index < materials.size());
+    auto existing = interned.find(materials[index]);
+    if (existing != interned.end() && existing->second == index) interned.erase(existing);
+    materials[index] = material;
+    changed(index);
+}
+
+const Material &Materials::get(uint32_t index) {
+    return materials[index];
+}
+
+uint32_t Materials::getCount() {
+    return materials.size();
+}
+
+void Materials::upload(GLenum unit) {
+    if (!buffer) {
+        glGenBuffers(1, &buffer);
+        glGenTextures(1, &texture);
+    }
+    if (changedLast >= 0) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        if (materials.size() > capacity) {
+            // room for twice as many, so materials added as the scene goes don't grow it each time, and all of them go
+            // into it
+            capacity = materials.size() * 2;
+            glBufferData(GL_TEXTURE_BUFFER, capacity * 16 * sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, texture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+            changedFirst = 0;
+            changedLast = materials.size() - 1;
+        }
+        std::vector<GLfloat> texels;
+        texels.reserve((changedLast - changedFirst + 1) * 16);
+        for (int i = changedFirst; i <= changedLast; ++i) {
+            for (const ColorRGBA *color : {&materials[i].ambient, &materials[i].diffuse, &materials[i].specular}) texels.insert(texels.end(), color->array, color->array + 4);
+            texels.insert(texels.end(), {materials[i].shininess, 0, 0, 0});
+        }
+        glBufferSubData(GL_TEXTURE_BUFFER, changedFirst * 16 * sizeof(GLfloat), texels.size() * sizeof(GLfloat), texels.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        changedLast = -1;
+    }
+    glActiveTexture(unit);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Materials::apply(uint32_t index, bool fixed) {
+    glVertexAttrib1f(VertexAttribute::materialIndex, index);
+    if (!fixed) return;
+    const Material &material = materials[index];
+    glMaterialfv(GL_FRONT, GL_AMBIENT, material.ambient.array);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE, material.diffuse.array);
+    glMaterialfv(GL_FRONT, GL_SPECULAR, material.specular.array);
+    glMaterialf(GL_FRONT, GL_SHININESS, material.shininess);
+}
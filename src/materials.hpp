@@ -0,0 +1,40 @@
+#ifndef MATERIALS_HPP
+#define MATERIALS_HPP
+
+#define _USE_MATH_DEFINES
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <cmath>
+#include <cstdint>
+
+#include "structures.hpp"
+
+struct Material {
+    ColorRGBA ambient, diffuse, specular;
+    GLfloat shininess;
+};
+
+// every material the scene draws with, once each, by index: shapes keep the index, the table goes to the gpu as a
+// buffer texture of four texels a material, ambient, diffuse, specular and shininess, and shaders fetch from it by the
+// index the draw sets in the materialIndex attribute; material 0 is the default, white and not shiny
+namespace Materials {
+    // the index of a material with these values, the same one each time
+    uint32_t intern(const Material &material);
+    // a material of its own, to be changed with update
+    uint32_t create(const Material &material);
+    // changes a material for everything drawn with it, from the next upload; an interned one stops being shared
+    void update(uint32_t index, const Material &material);
+    const Material &get(uint32_t index);
+    uint32_t getCount();
+    // sends the materials added or changed since the last upload and binds the table to the texture unit, once a
+    // frame, before drawing
+    void upload(GLenum unit);
+    // sets the material to draw with: its index for shaders and, when asked for the fixed pipeline and shaders that
+    // read gl_FrontMaterial, its values
+    void apply(uint32_t index, bool fixed);
+}
+
+#endif
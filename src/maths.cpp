@@ -0,0 +1,140 @@
+#include "maths.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "simd.hpp"
+
+using namespace Simd;
+
+// class Matrix4
+
+Matrix4 Matrix4::rotation(GLfloat degrees, const Vector3 &axis) {
+    // same matrix glRotatef builds
+    Vector3 u = axis.normalize();
+    GLfloat s, c;
+    Maths::sinCos(degrees * (GLfloat) M_PI / 180, s, c);
+    GLfloat t = 1 - c;
+    Matrix4 matrix = identity();
+    matrix.array[0] = u.x * u.x * t + c;
+    matrix.array[1] = u.y * u.x * t + u.z * s;
+    matrix.array[2] = u.x * u.z * t - u.y * s;
+    matrix.array[4] = u.x * u.y * t - u.z * s;
+    matrix.array[5] = u.y * u.y * t + c;
+    matrix.array[6] = u.y * u.z * t + u.x * s;
+    matrix.array[8] = u.x * u.z * t + u.y * s;
+    matrix.array[9] = u.y * u.z * t - u.x * s;
+    matrix.array[10] = u.z * u.z * t + c;
+    return matrix;
+}
+
+Matrix4 Matrix4::inverse() const {
+    // cofactor expansion, using 2x2 sub-determinants shared between the cofactors
+    const GLfloat *m = array;
+    GLfloat s0 = m[0] * m[5] - m[4] * m[1], s1 = m[0] * m[6] - m[4] * m[2], s2 = m[0] * m[7] - m[4] * m[3];
+    GLfloat s3 = m[1] * m[6] - m[5] * m[2], s4 = m[1] * m[7] - m[5] * m[3], s5 = m[2] * m[7] - m[6] * m[3];
+    GLfloat c5 = m[10] * m[15] - m[14] * m[11], c4 = m[9] * m[15] - m[13] * m[11], c3 = m[9] * m[14] - m[13] * m[10];
+    GLfloat c2 = m[8] * m[15] - m[12] * m[11], c1 = m[8] * m[14] - m[12] * m[10], c0 = m[8] * m[13] - m[12] * m[9];
+    GLfloat determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    Matrix4 result;
+    if (determinant == 0) return result;
+    GLfloat d = 1 / determinant;
+    GLfloat *r = result.array;
+    r[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * d;
+    r[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * d;
+    r[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * d;
+    r[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * d;
+    r[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * d;
+    r[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * d;
+    r[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * d;
+    r[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * d;
+    r[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * d;
+    r[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * d;
+    r[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * d;
+    r[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * d;
+    r[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * d;
+    r[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * d;
+    r[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * d;
+    r[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * d;
+    return result;
+}
+
+// namespace Maths
+
+void Maths::exp(const GLfloat *input, GLfloat *output, int count) {
+    int i = 0;
+    for (; i + lanes <= count; i += lanes) store(output + i, expLanes(load(input + i)));
+    // pad the tail to a full register
+    if (i < count) {
+        GLfloat in[lanes] = {0}, out[lanes];
+        std::copy(input + i, input + count, in);
+        store(out, expLanes(load(in)));
+        std::copy(out, out + count - i, output + i);
+    }
+}
+
+void Maths::sinCos(const GLfloat *input, GLfloat *sines, GLfloat *cosines, int count) {
+    int i = 0;
+    Floats s, c;
+    for (; i + lanes <= count; i += lanes) {
+        sinCosLanes(load(input + i), s, c);
+        store(sines + i, s);
+        store(cosines + i, c);
+    }
+    if (i < count) {
+        GLfloat in[lanes] = {0}, outSines[lanes], outCosines[lanes];
+        std::copy(input + i, input + count, in);
+        sinCosLanes(load(in), s, c);
+        store(outSines, s);
+        store(outCosines, c);
+        std::copy(outSines, outSines + count - i, sines + i);
+        std::copy(outCosines, outCosines + count - i, cosines + i);
+    }
+}
+
+void Maths::sinCos(GLfloat x, GLfloat &sine, GLfloat &cosine) {
+    GLfloat sines[lanes], cosines[lanes];
+    Floats s, c;
+    sinCosLanes(set(x), s, c);
+    store(sines, s);
+    store(cosines, c);
+    sine = sines[0];
+    cosine = cosines[0];
+}
+
+GLfloat Maths::sin(GLfloat x) {
+    GLfloat s, c;
+    sinCos(x, s, c);
+    return s;
+}
+
+GLfloat Maths::cos(GLfloat x) {
+    GLfloat s, c;
+    sinCos(x, s, c);
+    return c;
+}
+
+void Maths::transformPoints(const Matrix4 &matrix, const GLfloat *input, GLfloat *output, int count) {
+#ifdef MATHS_SSE
+    __m128 columns[4] = {_mm_load_ps(matrix.array), _mm_load_ps(matrix.array + 4), _mm_load_ps(matrix.array + 8), _mm_load_ps(matrix.array + 12)};
+    alignas(16) GLfloat result[4];
+    for (int i = 0; i < count; ++i) {
+        const GLfloat *p = input + i * 3;
+        __m128 sum = _mm_add_ps(columns[3], _mm_mul_ps(columns[0], _mm_set1_ps(p[0])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(columns[1], _mm_set1_ps(p[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(columns[2], _mm_set1_ps(p[2])));
+        // every point but the last can spill its w into the next point
+        if (i + 1 < count) {
+            _mm_storeu_ps(output + i * 3, sum);
+        } else {
+            _mm_store_ps(result, sum);
+            std::copy(result, result + 3, output + i * 3);
+        }
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        Vector3 point = matrix.transformPoint({input[i * 3], input[i * 3 + 1], input[i * 3 + 2]});
+        std::copy(point.array, point.array + 3, output + i * 3);
+    }
+#endif
+}
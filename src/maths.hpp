@@ -0,0 +1,201 @@
+#ifndef MATHS_HPP
+#define MATHS_HPP
+
+#define _USE_MATH_DEFINES
+
+#include <GL/freeglut.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "structures.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MATHS_SSE
+#include <immintrin.h>
+#endif
+
+struct alignas(16) Vector3 {
+    union {
+        struct {
+            GLfloat x, y, z, padding;
+        };
+        struct {
+            GLfloat array[4];
+        };
+#ifdef MATHS_SSE
+        __m128 simd;
+#endif
+    };
+
+    Vector3() : Vector3(0, 0, 0) {}
+    Vector3(const Coordinates3D &coordinates) : Vector3(coordinates.x, coordinates.y, coordinates.z) {}
+#ifdef MATHS_SSE
+    Vector3(GLfloat x, GLfloat y, GLfloat z) : simd(_mm_set_ps(0, z, y, x)) {}
+    Vector3(__m128 simd) : simd(simd) {}
+    Vector3 operator+(const Vector3 &addend) const { return _mm_add_ps(simd, addend.simd); }
+    Vector3 operator-(const Vector3 &addend) const { return _mm_sub_ps(simd, addend.simd); }
+    Vector3 operator*(const Vector3 &factor) const { return _mm_mul_ps(simd, factor.simd); }
+    Vector3 operator*(GLfloat factor) const { return _mm_mul_ps(simd, _mm_set1_ps(factor)); }
+    Vector3 operator/(GLfloat divisor) const { return _mm_div_ps(simd, _mm_set1_ps(divisor)); }
+    GLfloat dot(const Vector3 &other) const {
+        __m128 product = _mm_mul_ps(simd, other.simd);
+        __m128 sum = _mm_add_ps(product, _mm_movehl_ps(product, product));
+        return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+    }
+    static Vector3 min(const Vector3 &a, const Vector3 &b) { return _mm_min_ps(a.simd, b.simd); }
+    static Vector3 max(const Vector3 &a, const Vector3 &b) { return _mm_max_ps(a.simd, b.simd); }
+    Vector3 cross(const Vector3 &other) const {
+        __m128 a = _mm_shuffle_ps(simd, simd, _MM_SHUFFLE(3, 0, 2, 1)), b = _mm_shuffle_ps(other.simd, other.simd, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 difference = _mm_sub_ps(_mm_mul_ps(simd, b), _mm_mul_ps(a, other.simd));
+        return _mm_shuffle_ps(difference, difference, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+#else
+    Vector3(GLfloat x, GLfloat y, GLfloat z) : x(x), y(y), z(z), padding(0) {}
+    Vector3 operator+(const Vector3 &addend) const { return {x + addend.x, y + addend.y, z + addend.z}; }
+    Vector3 operator-(const Vector3 &addend) const { return {x - addend.x, y - addend.y, z - addend.z}; }
+    Vector3 operator*(const Vector3 &factor) const { return {x * factor.x, y * factor.y, z * factor.z}; }
+    Vector3 operator*(GLfloat factor) const { return {x * factor, y * factor, z * factor}; }
+    Vector3 operator/(GLfloat divisor) const { return {x / divisor, y / divisor, z / divisor}; }
+    GLfloat dot(const Vector3 &other) const { return x * other.x + y * other.y + z * other.z; }
+    static Vector3 min(const Vector3 &a, const Vector3 &b) { return {std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)}; }
+    static Vector3 max(const Vector3 &a, const Vector3 &b) { return {std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)}; }
+    Vector3 cross(const Vector3 &other) const { return {y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x}; }
+#endif
+    GLfloat length() const { return std::sqrt(dot(*this)); }
+    Vector3 normalize() const { return *this / length(); }
+    operator Coordinates3D() const { return {x, y, z}; }
+};
+
+struct alignas(16) Vector4 {
+    union {
+        struct {
+            GLfloat x, y, z, w;
+        };
+        struct {
+            GLfloat array[4];
+        };
+#ifdef MATHS_SSE
+        __m128 simd;
+#endif
+    };
+
+    Vector4() : Vector4(0, 0, 0, 0) {}
+    Vector4(const Coordinates4D &coordinates) : Vector4(coordinates.x, coordinates.y, coordinates.z, coordinates.w) {}
+    Vector4(const Vector3 &vector, GLfloat w) : Vector4(vector.x, vector.y, vector.z, w) {}
+#ifdef MATHS_SSE
+    Vector4(GLfloat x, GLfloat y, GLfloat z, GLfloat w) : simd(_mm_set_ps(w, z, y, x)) {}
+    Vector4(__m128 simd) : simd(simd) {}
+    Vector4 operator+(const Vector4 &addend) const { return _mm_add_ps(simd, addend.simd); }
+    Vector4 operator-(const Vector4 &addend) const { return _mm_sub_ps(simd, addend.simd); }
+    Vector4 operator*(GLfloat factor) const { return _mm_mul_ps(simd, _mm_set1_ps(factor)); }
+#else
+    Vector4(GLfloat x, GLfloat y, GLfloat z, GLfloat w) : x(x), y(y), z(z), w(w) {}
+    Vector4 operator+(const Vector4 &addend) const { return {x + addend.x, y + addend.y, z + addend.z, w + addend.w}; }
+    Vector4 operator-(const Vector4 &addend) const { return {x - addend.x, y - addend.y, z - addend.z, w - addend.w}; }
+    Vector4 operator*(GLfloat factor) const { return {x * factor, y * factor, z * factor, w * factor}; }
+#endif
+    Vector3 toVector3() const { return {x, y, z}; }
+    operator Coordinates4D() const { return {x, y, z, w}; }
+};
+
+// column-major, same layout as glMultMatrixf/glLoadMatrixf expect
+struct alignas(16) Matrix4 {
+    GLfloat array[16];
+
+    Matrix4() : array{0} {}
+    Matrix4(const GLfloat *array) { std::copy(array, array + 16, this->array); }
+
+    static Matrix4 identity() {
+        Matrix4 matrix;
+        matrix.array[0] = matrix.array[5] = matrix.array[10] = matrix.array[15] = 1;
+        return matrix;
+    }
+
+    static Matrix4 translation(const Vector3 &offset) {
+        Matrix4 matrix = identity();
+        matrix.array[12] = offset.x;
+        matrix.array[13] = offset.y;
+        matrix.array[14] = offset.z;
+        return matrix;
+    }
+
+    static Matrix4 scaling(const Vector3 &factors) {
+        Matrix4 matrix;
+        matrix.array[0] = factors.x;
+        matrix.array[5] = factors.y;
+        matrix.array[10] = factors.z;
+        matrix.array[15] = 1;
+        return matrix;
+    }
+
+    static Matrix4 rotation(GLfloat degrees, const Vector3 &axis);
+
+#ifdef MATHS_SSE
+    Vector4 operator*(const Vector4 &vector) const {
+        __m128 sum = _mm_mul_ps(_mm_load_ps(array), _mm_set1_ps(vector.x));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(array + 4), _mm_set1_ps(vector.y)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(array + 8), _mm_set1_ps(vector.z)));
+        return _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(array + 12), _mm_set1_ps(vector.w)));
+    }
+
+    Matrix4 operator*(const Matrix4 &other) const {
+        Matrix4 result;
+        for (int i = 0; i < 4; ++i) {
+            _mm_store_ps(result.array + i * 4, (*this * Vector4(_mm_load_ps(other.array + i * 4))).simd);
+        }
+        return result;
+    }
+#else
+    Vector4 operator*(const Vector4 &vector) const {
+        Vector4 result;
+        for (int j = 0; j < 4; ++j) {
+            for (int k = 0; k < 4; ++k) result.array[j] += array[k * 4 + j] * vector.array[k];
+        }
+        return result;
+    }
+
+    Matrix4 operator*(const Matrix4 &other) const {
+        Matrix4 result;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                for (int k = 0; k < 4; ++k) result.array[i * 4 + j] += array[k * 4 + j] * other.array[i * 4 + k];
+            }
+        }
+        return result;
+    }
+#endif
+
+    Vector3 transformPoint(const Vector3 &point) const { return (*this * Vector4(point, 1)).toVector3(); }
+    Vector3 transformVector(const Vector3 &vector) const { return (*this * Vector4(vector, 0)).toVector3(); }
+    Matrix4 inverse() const;
+};
+
+namespace Maths {
+    // polynomial approximations (Cephes), vectorized over 4 (SSE2) or 8 (AVX2) lanes
+    void exp(const GLfloat *input, GLfloat *output, int count);
+    void sinCos(const GLfloat *input, GLfloat *sines, GLfloat *cosines, int count);
+    void sinCos(GLfloat x, GLfloat &sine, GLfloat &cosine);
+    GLfloat sin(GLfloat x);
+    GLfloat cos(GLfloat x);
+    // transform tightly packed xyz points (output must not overlap input)
+    void transformPoints(const Matrix4 &matrix, const GLfloat *input, GLfloat *output, int count);
+
+    // single value version of the exp kernel, inline since it sits in per-frame code
+    inline GLfloat exp(GLfloat x) {
+        x = std::min(std::max(x, -88.3762626647949f), 88.3762626647949f);
+        GLfloat t = x * 1.44269504088896341f + 0.5f;
+        int32_t n = (int32_t) t;
+        if (n > t) n--;
+        x = x - n * 0.693359375f - n * -2.12194440e-4f;
+        GLfloat y = ((((1.9875691500e-4f * x + 1.3981999507e-3f) * x + 8.3334519073e-3f) * x + 4.1665795894e-2f) * x + 1.6666665459e-1f) * x + 5.0000001201e-1f;
+        int32_t bits = (n + 0x7f) << 23;
+        GLfloat power;
+        std::memcpy(&power, &bits, sizeof power);
+        return (y * x * x + x + 1) * power;
+    }
+}
+
+#endif
@@ -0,0 +1,251 @@
+#include "meshes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <numeric>
+
+// namespace Mesh
+
+std::vector<GLuint> Mesh::weld(std::vector<GLfloat> &vertices, std::vector<GLfloat> &normals, std::vector<GLfloat> &textureVertices) {
+    int count = vertices.size() / 3;
+    bool textured = textureVertices.size() >= count * 2;
+    std::map<std::array<GLfloat, 8>, GLuint> unique;
+    std::vector<GLfloat> weldedVertices, weldedNormals, weldedTextureVertices;
+    std::vector<GLuint> remap(count), indices;
+    indices.reserve(count / 4 * 6);
+
+    // merge vertices with identical attributes
+    for (int i = 0; i < count; ++i) {
+        std::array<GLfloat, 8> key = {
+            vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2],
+            normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2],
+            textured ? textureVertices[i * 2] : 0, textured ? textureVertices[i * 2 + 1] : 0};
+        auto [entry, inserted] = unique.emplace(key, unique.size());
+        if (inserted) {
+            weldedVertices.insert(weldedVertices.end(), key.begin(), key.begin() + 3);
+            weldedNormals.insert(weldedNormals.end(), key.begin() + 3, key.begin() + 6);
+            weldedTextureVertices.insert(weldedTextureVertices.end(), key.begin() + 6, key.end());
+        }
+        remap[i] = entry->second;
+    }
+
+    // split every quad in two triangles that both end on the quad's last (provoking) vertex
+    for (int i = 0; i + 3 < count; i += 4) {
+        for (int corner : {0, 1, 3, 1, 2, 3}) indices.push_back(remap[i + corner]);
+    }
+
+    vertices = std::move(weldedVertices);
+    normals = std::move(weldedNormals);
+    textureVertices = std::move(weldedTextureVertices);
+    return indices;
+}
+
+void Mesh::optimizeVertexCache(std::vector<GLuint> &indices, int vertexCount) {
+    // Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+    auto score = [](int position, int remaining) {
+        if (remaining == 0) return -1.f;
+        GLfloat value = 0;
+        if (position >= 0) {
+            value = position < 3 ? 0.75f : std::pow(1 - (position - 3.f) / (optimizerCacheSize - 3), 1.5f);
+        }
+        return value + 2 / std::sqrt((GLfloat) remaining);
+    };
+
+    int triangleCount = indices.size() / 3;
+    // triangles using each vertex, as ranges into a single array
+    std::vector<int> remaining(vertexCount, 0), offsets(vertexCount + 1, 0), adjacency(indices.size());
+    for (GLuint index : indices) remaining[index]++;
+    std::partial_sum(remaining.begin(), remaining.end(), offsets.begin() + 1);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = t;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<GLfloat> vertexScore(vertexCount), triangleScore(triangleCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    for (int v = 0; v < vertexCount; ++v) vertexScore[v] = score(-1, remaining[v]);
+    for (int t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) triangleScore[t] += vertexScore[indices[t * 3 + k]];
+    }
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    std::vector<int> cache, nextCache;
+    int best = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin(), cursor = 0;
+    for (int n = 0; n < triangleCount; ++n) {
+        // nothing left next to the cache, restart from the first unused triangle
+        if (best < 0) {
+            while (emitted[cursor]) cursor++;
+            best = cursor;
+        }
+        emitted[best] = true;
+
+        // emit the triangle and detach it from its vertices
+        nextCache.clear();
+        for (int k = 0; k < 3; ++k) {
+            GLuint v = indices[best * 3 + k];
+            result.push_back(v);
+            nextCache.push_back(v);
+            int *begin = &adjacency[offsets[v]], *end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, best), end - 1);
+            remaining[v]--;
+        }
+        // move its vertices to the front of the cache
+        for (int v : cache) {
+            if (std::find(nextCache.begin(), nextCache.begin() + 3, v) == nextCache.begin() + 3) nextCache.push_back(v);
+        }
+
+        // rescore everything that entered, moved within or left the cache
+        for (int i = 0; i < (int) nextCache.size(); ++i) {
+            int v = nextCache[i];
+            cachePosition[v] = i < optimizerCacheSize ? i : -1;
+            GLfloat updated = score(cachePosition[v], remaining[v]);
+            for (int j = offsets[v]; j < offsets[v] + remaining[v]; ++j) triangleScore[adjacency[j]] += updated - vertexScore[v];
+            vertexScore[v] = updated;
+        }
+        if ((int) nextCache.size() > optimizerCacheSize) nextCache.resize(optimizerCacheSize);
+        std::swap(cache, nextCache);
+
+        // pick the best triangle touching the cache
+        best = -1;
+        GLfloat bestScore = -1;
+        for (int v : cache) {
+            for (int j = offsets[v]; j < offsets[v] + remaining[v]; ++j) {
+                if (triangleScore[adjacency[j]] > bestScore) {
+                    best = adjacency[j];
+                    bestScore = triangleScore[best];
+                }
+            }
+        }
+    }
+    indices = std::move(result);
+}
+
+void Mesh::optimizeOverdraw(std::vector<GLuint> &indices, const std::vector<GLfloat> &vertices, GLfloat threshold) {
+    // Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+    int triangleCount = indices.size() / 3, vertexCount = vertices.size() / 3;
+    if (triangleCount == 0) return;
+    GLfloat meshAcmr = analyze(indices, vertexCount).acmr;
+
+    // split into clusters where the cache would be cold anyway (all three vertices missed)
+    // or where cutting keeps the cluster within the threshold of the mesh acmr
+    std::vector<int> clusters = {0};
+    std::vector<int> timestamp(vertexCount, -statisticsCacheSize);
+    int time = 0, clusterMisses = 0;
+    for (int t = 0; t < triangleCount; ++t) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            GLuint v = indices[t * 3 + k];
+            if (time - timestamp[v] >= statisticsCacheSize) {
+                timestamp[v] = time++;
+                misses++;
+            }
+        }
+        int clusterSize = t - clusters.back();
+        if (clusterSize > 0 && (misses == 3 || misses >= 2 && clusterMisses <= threshold * meshAcmr * clusterSize)) {
+            clusters.push_back(t);
+            clusterMisses = 0;
+        }
+        clusterMisses += misses;
+    }
+    clusters.push_back(triangleCount);
+
+    // area weighted centroid and normal of every cluster
+    auto corner = [&](int t, int k) { return &vertices[indices[t * 3 + k] * 3]; };
+    std::vector<std::array<GLfloat, 3>> centroids(clusters.size() - 1), clusterNormals(clusters.size() - 1);
+    std::array<GLfloat, 3> meshCentroid = {0, 0, 0};
+    GLfloat meshArea = 0;
+    for (int c = 0; c + 1 < (int) clusters.size(); ++c) {
+        std::array<GLfloat, 3> centroid = {0, 0, 0}, normal = {0, 0, 0};
+        GLfloat clusterArea = 0;
+        for (int t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const GLfloat *a = corner(t, 0), *b = corner(t, 1), *d = corner(t, 2);
+            GLfloat u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]}, w[3] = {d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+            GLfloat cross[3] = {u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0]};
+            GLfloat area = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) / 2;
+            for (int k = 0; k < 3; ++k) {
+                centroid[k] += area * (a[k] + b[k] + d[k]) / 3;
+                normal[k] += cross[k];
+            }
+            clusterArea += area;
+        }
+        for (int k = 0; k < 3; ++k) {
+            meshCentroid[k] += centroid[k];
+            centroids[c][k] = clusterArea > 0 ? centroid[k] / clusterArea : 0;
+        }
+        meshArea += clusterArea;
+        GLfloat length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (int k = 0; k < 3; ++k) clusterNormals[c][k] = length > 0 ? normal[k] / length : 0;
+    }
+    for (int k = 0; k < 3; ++k) meshCentroid[k] = meshArea > 0 ? meshCentroid[k] / meshArea : 0;
+
+    // draw outward facing clusters first so they occlude the rest
+    std::vector<GLfloat> sortKeys(clusters.size() - 1);
+    for (int c = 0; c < (int) sortKeys.size(); ++c) {
+        sortKeys[c] = 0;
+        for (int k = 0; k < 3; ++k) sortKeys[c] += (centroids[c][k] - meshCentroid[k]) * clusterNormals[c][k];
+    }
+    std::vector<int> order(sortKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](int a, int b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    for (int c : order) result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    indices = std::move(result);
+}
+
+void Mesh::optimizeVertexFetch(std::vector<GLuint> &indices, std::vector<GLfloat> &vertices, std::vector<GLfloat> &normals, std::vector<GLfloat> &textureVertices) {
+    // renumber vertices in the order they are first used
+    int vertexCount = vertices.size() / 3;
+    std::vector<GLint> remap(vertexCount, -1);
+    std::vector<GLfloat> fetchedVertices(vertices.size()), fetchedNormals(normals.size()), fetchedTextureVertices(textureVertices.size());
+    GLint next = 0;
+    for (GLuint &index : indices) {
+        if (remap[index] < 0) {
+            remap[index] = next;
+            std::copy(&vertices[index * 3], &vertices[index * 3] + 3, &fetchedVertices[next * 3]);
+            std::copy(&normals[index * 3], &normals[index * 3] + 3, &fetchedNormals[next * 3]);
+            std::copy(&textureVertices[index * 2], &textureVertices[index * 2] + 2, &fetchedTextureVertices[next * 2]);
+            next++;
+        }
+        index = remap[index];
+    }
+    // unreferenced vertices are dropped
+    fetchedVertices.resize(next * 3);
+    fetchedNormals.resize(next * 3);
+    fetchedTextureVertices.resize(next * 2);
+    vertices = std::move(fetchedVertices);
+    normals = std::move(fetchedNormals);
+    textureVertices = std::move(fetchedTextureVertices);
+}
+
+MeshStatistics Mesh::analyze(const std::vector<GLuint> &indices, int vertexCount) {
+    // simulate a fifo post-transform cache
+    std::vector<int> timestamp(vertexCount, -statisticsCacheSize);
+    int time = 0;
+    for (GLuint index : indices) {
+        if (time - timestamp[index] >= statisticsCacheSize) timestamp[index] = time++;
+    }
+    return {indices.empty() ? 0 : time / (indices.size() / 3.f), vertexCount == 0 ? 0 : time / (GLfloat) vertexCount};
+}
+
+std::vector<GLuint> Mesh::optimize(std::vector<GLfloat> &vertices, std::vector<GLfloat> &normals, std::vector<GLfloat> &textureVertices, std::ostream *report, const std::string &name) {
+    std::vector<GLuint> indices = weld(vertices, normals, textureVertices);
+    MeshStatistics before = analyze(indices, vertices.size() / 3);
+    optimizeVertexCache(indices, vertices.size() / 3);
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(indices, vertices, normals, textureVertices);
+    if (report) {
+        MeshStatistics after = analyze(indices, vertices.size() / 3);
+        *report << std::fixed << std::setprecision(3)
+                << name << ": " << indices.size() / 3 << " triangles, " << vertices.size() / 3 << " vertices, "
+                << "acmr " << before.acmr << " -> " << after.acmr << ", "
+                << "atvr " << before.atvr << " -> " << after.atvr << std::endl;
+    }
+    return indices;
+}
@@ -0,0 +1,28 @@
+#ifndef MESHES_HPP
+#define MESHES_HPP
+
+#include <GL/freeglut.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct MeshStatistics {
+    GLfloat acmr;  // average cache miss ratio (transformed vertices per triangle)
+    GLfloat atvr;  // average transformed vertex ratio (transformed vertices per unique vertex)
+};
+
+namespace Mesh {
+    // cache size targeted by the optimizer (lru) and simulated by the statistics (fifo)
+    const int optimizerCacheSize = 32;
+    const int statisticsCacheSize = 16;
+
+    std::vector<GLuint> weld(std::vector<GLfloat> &vertices, std::vector<GLfloat> &normals, std::vector<GLfloat> &textureVertices);
+    void optimizeVertexCache(std::vector<GLuint> &indices, int vertexCount);
+    void optimizeOverdraw(std::vector<GLuint> &indices, const std::vector<GLfloat> &vertices, GLfloat threshold = 1.05);
+    void optimizeVertexFetch(std::vector<GLuint> &indices, std::vector<GLfloat> &vertices, std::vector<GLfloat> &normals, std::vector<GLfloat> &textureVertices);
+    MeshStatistics analyze(const std::vector<GLuint> &indices, int vertexCount);
+    std::vector<GLuint> optimize(std::vector<GLfloat> &vertices, std::vector<GLfloat> &normals, std::vector<GLfloat> &textureVertices, std::ostream *report = nullptr, const std::string &name = "");
+}
+
+#endif
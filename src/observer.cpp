@@ -3,13 +3,13 @@
 // class Observer
 
 Observer::Observer(GLfloat x, GLfloat y, GLfloat z, GLfloat theta, GLfloat phi, GLfloat sensitivity, GLfloat mass, GLfloat forceCoefficient, GLfloat dragCoefficient)
-    : position{x, y, z}, angle{theta, phi}, sensitivity(sensitivity), mass(mass), forceCoefficient(forceCoefficient), dragCoefficient(dragCoefficient) {}
+    : position{x, y, z}, angle{theta, phi}, sensitivity(sensitivity), mass(mass), forceCoefficient(forceCoefficient), dragCoefficient(dragCoefficient), radius(0), collisions(nullptr) {}
 
-Coordinates3D Observer::getPosition() { return position; }
+Coordinates3D Observer::getPosition() { return Reactive::read(&position); }
 
 Coordinates3D Observer::getVelocity() { return velocity; }
 
-Coordinates3D Observer::getFrontVector() { return frontVector; }
+Coordinates3D Observer::getFrontVector() { return Reactive::read(&frontVector); }
 
 Coordinates3D Observer::getFocusPoint() { return {position.x + frontVector.x, position.y + frontVector.y, position.z + frontVector.z}; }
 
@@ -27,6 +27,11 @@ void Observer::setPhi(GLfloat phi) { angle.phi = phi; }
 
 void Observer::setVelocity(GLfloat x, GLfloat y, GLfloat z) { velocity = {x, y, z}; }
 
+void Observer::setCollisions(const CollisionScene *collisions, GLfloat radius) {
+    this->collisions = collisions;
+    this->radius = radius;
+}
+
 void Observer::moveCamera(GLfloat x, GLfloat y) {
     angle.theta = std::fmod(angle.theta + x * sensitivity, 2 * M_PI);
     angle.phi -= y * sensitivity;
@@ -55,20 +60,23 @@ void Observer::updateVectors() {
 }
 
 void Observer::updatePosition(unsigned long delta) {
-    position = {
-        position.x + (force.x / dragCoefficient) * delta + (force.x / dragCoefficient - velocity.x) * (mass / dragCoefficient) * (GLfloat) exp(-(dragCoefficient / mass) * delta) - (force.x / dragCoefficient - velocity.x) * (mass / dragCoefficient),
-        position.y + (force.y / dragCoefficient) * delta + (force.y / dragCoefficient - velocity.y) * (mass / dragCoefficient) * (GLfloat) exp(-(dragCoefficient / mass) * delta) - (force.y / dragCoefficient - velocity.y) * (mass / dragCoefficient),
-        position.z + (force.z / dragCoefficient) * delta + (force.z / dragCoefficient - velocity.z) * (mass / dragCoefficient) * (GLfloat) exp(-(dragCoefficient / mass) * delta) - (force.z / dragCoefficient - velocity.z) * (mass / dragCoefficient),
-    };
-    velocity = {
-        (force.x / dragCoefficient) - (GLfloat) exp(-(dragCoefficient / mass) * delta) * (force.x / dragCoefficient - velocity.x),
-        (force.y / dragCoefficient) - (GLfloat) exp(-(dragCoefficient / mass) * delta) * (force.y / dragCoefficient - velocity.y),
-        (force.z / dragCoefficient) - (GLfloat) exp(-(dragCoefficient / mass) * delta) * (force.z / dragCoefficient - velocity.z),
-    };
+    // closed form of m * dv/dt = F - k * v, the decay term is shared by every axis
+    GLfloat decay = Maths::exp(-(dragCoefficient / mass) * delta);
+    Vector3 terminalVelocity = Vector3(force) / dragCoefficient;
+    Vector3 difference = terminalVelocity - velocity;
+    position = Vector3(position) + terminalVelocity * (GLfloat) delta + difference * ((mass / dragCoefficient) * (decay - 1));
+    velocity = terminalVelocity - difference * decay;
     force.x = force.y = force.z = 0;
 }
 
 void Observer::tick(unsigned long delta) {
     updateVectors();
+    Vector3 start = position;
     updatePosition(delta);
+    // the observer is a sphere swept along the integrated move
+    if (collisions) {
+        Vector3 clipped = velocity;
+        position = collisions->slide(start, Vector3(position) - start, radius, clipped);
+        velocity = clipped;
+    }
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include <cmath>
 
+#include "collisions.hpp"
+#include "maths.hpp"
 #include "structures.hpp"
 
 class Observer {
@@ -12,7 +14,8 @@ class Observer {
     Coordinates3D position, velocity, force, drag, frontVector;
     Angle3D angle;
     Coordinates2D rightVector;
-    GLfloat sensitivity, mass, forceCoefficient, dragCoefficient;
+    GLfloat sensitivity, mass, forceCoefficient, dragCoefficient, radius;
+    const CollisionScene *collisions;
 
     public:
     Observer(GLfloat x, GLfloat y, GLfloat z, GLfloat theta, GLfloat phi, GLfloat sensitivity, GLfloat mass, GLfloat forceCoefficient, GLfloat dragCoefficient);
@@ -27,6 +30,7 @@ class Observer {
     void setTheta(GLfloat theta);
     void setPhi(GLfloat phi);
     void setVelocity(GLfloat x, GLfloat y, GLfloat z);
+    void setCollisions(const CollisionScene *collisions, GLfloat radius);
     void moveCamera(GLfloat x, GLfloat y);
     void applyForce(GLfloat front, GLfloat right);
     void updateVectors();
@@ -0,0 +1,86 @@
+#include "offscreen.hpp"
+
+#include <iostream>
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// class Offscreen
+
+Offscreen::Offscreen() : display(nullptr), context(nullptr), framebuffer(0), colorBuffer(0), depthBuffer(0), width(0), height(0) {}
+
+Offscreen::~Offscreen() {
+    if (framebuffer) {
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        glDeleteFramebuffers(1, &framebuffer);
+    }
+#ifndef _WIN32
+    if (context) eglDestroyContext(display, context);
+    if (display) eglTerminate(display);
+#endif
+}
+
+bool Offscreen::initialize(GLint width, GLint height) {
+#ifdef _WIN32
+    std::cerr << "offscreen rendering needs egl" << std::endl;
+    return false;
+#else
+    this->width = width;
+    this->height = height;
+
+    // the surfaceless platform needs no window system at all, the default display is tried where it is missing
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay display = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : EGL_NO_DISPLAY;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+            std::cerr << "couldn't open an egl display" << std::endl;
+            return false;
+        }
+    }
+    this->display = display;
+
+    // a desktop gl context with no version asked for is a compatibility one, which the fixed pipeline needs
+    const EGLint configAttributes[] = {EGL_SURFACE_TYPE, 0, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configs = 0;
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configs) || configs == 0) {
+        std::cerr << "couldn't find an egl config for opengl" << std::endl;
+        return false;
+    }
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "couldn't make a surfaceless egl context current" << std::endl;
+        return false;
+    }
+    this->context = context;
+    glewInit();
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    // with stencil, which the depth pre-pass breaks depth ties with
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "couldn't make a " << width << "x" << height << " framebuffer" << std::endl;
+        return false;
+    }
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    return true;
+#endif
+}
+
+void Offscreen::bind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
@@ -0,0 +1,25 @@
+#ifndef OFFSCREEN_HPP
+#define OFFSCREEN_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+// a gl context with no window behind it, drawing into a framebuffer of its own, for machines without a display; made
+// with surfaceless egl, so mesa's llvmpipe can run it without a gpu
+class Offscreen {
+    private:
+    void *display, *context;
+    GLuint framebuffer, colorBuffer, depthBuffer;
+    GLint width, height;
+
+    public:
+    Offscreen();
+    ~Offscreen();
+    // leaves the context current on the calling thread and its framebuffer bound; false where there is no egl
+    bool initialize(GLint width, GLint height);
+    // binds the framebuffer again, for a frame that follows passes drawing elsewhere
+    void bind();
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "picking.hpp"
+
+#include <map>
+
+#include "shaders.hpp"
+
+// class Picker
+
+Picker::Picker() : framebuffer(0), colorBuffer(0), depthBuffer(0), pixelBuffer(0), fence(0), idLocation(-1), requested(false), x(0), y(0), picked(nullptr) {}
+
+Picker::~Picker() {
+    if (fence) glDeleteSync(fence);
+    if (!framebuffer) return;
+    glDeleteBuffers(1, &pixelBuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void Picker::initialize(ShaderHandle shader) {
+    this->shader = shader;
+    idLocation = Resources::getShader(shader)->getUniformLocation("id");
+
+    // a single pixel is all the pass ever draws
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, 1, 1);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1, 1);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenBuffers(1, &pixelBuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint), NULL, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void Picker::request(GLint x, GLint y) {
+    this->x = x;
+    this->y = y;
+    requested = true;
+}
+
+void Picker::readBack() {
+    // never wait, a pass that is not done yet is simply collected on a later frame
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return;
+    glDeleteSync(fence);
+    fence = 0;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+    const GLuint *id = (const GLuint *) glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (id) {
+        picked = *id > 0 && *id <= pendingShapes.size() ? pendingShapes[*id - 1] : nullptr;
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void Picker::render(Shape &scene) {
+    if (fence) readBack();
+    // one pass in flight at a time, a request made meanwhile waits for it
+    if (!requested || fence) return;
+    requested = false;
+
+    GLint viewport[4], boundFramebuffer;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer);
+    glPushAttrib(GL_ENABLE_BIT | GL_VIEWPORT_BIT | GL_POLYGON_BIT | GL_DEPTH_BUFFER_BIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, 1, 1);
+    const GLuint none[] = {0, 0, 0, 0};
+    glClearBufferuiv(GL_COLOR, 0, none);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_BLEND);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    // narrow the current projection down to the pixel under the cursor
+    GLfloat projection[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluPickMatrix(x, viewport[3] - y - 1, 1, 1, viewport);
+    glMultMatrixf(projection);
+    glMatrixMode(GL_MODELVIEW);
+
+    shapes.clear();
+    ids.clear();
+    Resources::getShader(shader)->enable();
+    glUniform1ui(idLocation, 0);
+    scene.pick(*this);
+    Shader::clear();
+
+    // the copy lands in the pixel buffer without stalling, it is mapped once the fence passes
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+    glReadPixels(0, 0, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pendingShapes.swap(shapes);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFramebuffer);
+    glPopAttrib();
+}
+
+Shape *Picker::getPicked() {
+    Shape *shape = picked;
+    picked = nullptr;
+    return shape;
+}
+
+void Picker::push(Shape *shape) {
+    shapes.push_back(shape);
+    ids.push_back(shapes.size());
+    glUniform1ui(idLocation, ids.back());
+}
+
+void Picker::pop() {
+    ids.pop_back();
+    glUniform1ui(idLocation, ids.empty() ? 0 : ids.back());
+}
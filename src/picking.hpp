@@ -0,0 +1,40 @@
+#ifndef PICKING_HPP
+#define PICKING_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <vector>
+
+#include "resources.hpp"
+#include "shapes.hpp"
+
+class Picker {
+    private:
+    GLuint framebuffer, colorBuffer, depthBuffer, pixelBuffer;
+    GLsync fence;
+    ShaderHandle shader;
+    GLint idLocation;
+    bool requested;
+    GLint x, y;
+    std::vector<Shape *> shapes, pendingShapes;  // shapes by id - 1, for the pass being drawn and the one being read back
+    std::vector<GLuint> ids;
+    Shape *picked;
+    void readBack();
+
+    public:
+    Picker();
+    ~Picker();
+    void initialize(ShaderHandle shader);
+    // picks the pixel at window coordinates (origin at the top left, like glut) on the next render
+    void request(GLint x, GLint y);
+    // draws ids for the requested pixel only and queues an asynchronous read, collecting the previous one if ready
+    void render(Shape &scene);
+    // the shape hit by the last completed pick, returned once
+    Shape *getPicked();
+    void push(Shape *shape);
+    void pop();
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "queues.hpp"
+
+#include <cstring>
+#include <utility>
+
+// class DrawQueue
+
+void DrawQueue::clear() {
+    opaque.clear();
+    transparent.clear();
+}
+
+void DrawQueue::setFixedMaterials(bool fixedMaterials) {
+    this->fixedMaterials = fixedMaterials;
+}
+
+void DrawQueue::push(const DrawItem &item) {
+    bool seeThrough = item.color.array[3] < 1 || Materials::get(item.material).diffuse.array[3] < 1;
+    (seeThrough ? transparent : opaque).push_back(item);
+}
+
+void DrawQueue::sort() {
+    sort(opaque, false, opaqueOrder);
+    sort(transparent, true, transparentOrder);
+}
+
+void DrawQueue::sort(const std::vector<DrawItem> &items, bool farthestFirst, std::vector<uint32_t> &order) {
+    // the key above the item's index, which comes along for free
+    entries.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        uint32_t key = getDepthKey(items[i].depth);
+        entries[i] = (uint64_t) (farthestFirst ? ~key : key) << 32 | i;
+    }
+    radixSort(entries);
+    order.resize(items.size());
+    for (size_t i = 0; i < entries.size(); ++i) order[i] = (uint32_t) entries[i];
+}
+
+void DrawQueue::draw(const std::vector<DrawItem> &items, const std::vector<uint32_t> &order, bool depthOnly) {
+    glPushMatrix();
+    // materials are only set when they change, which shapes next to each other often share, and not at all for depth
+    uint32_t material = UINT32_MAX;
+    for (uint32_t index : order) {
+        const DrawItem &item = items[index];
+        glLoadMatrixf(item.matrix.array);
+        if (depthOnly) {
+            item.shape->renderDepthRaw();
+            continue;
+        }
+        glColor4fv(item.color.array);
+        if (item.material != material) Materials::apply(material = item.material, fixedMaterials);
+        item.shape->renderRaw();
+    }
+    glPopMatrix();
+}
+
+void DrawQueue::drawOpaque() {
+    draw(opaque, opaqueOrder);
+}
+
+void DrawQueue::drawOpaqueDepth() {
+    draw(opaque, opaqueOrder, true);
+}
+
+void DrawQueue::drawTransparent() {
+    // they still test against the opaque ones, but not against each other
+    glDepthMask(GL_FALSE);
+    draw(transparent, transparentOrder);
+    glDepthMask(GL_TRUE);
+}
+
+size_t DrawQueue::getOpaqueCount() const {
+    return opaque.size();
+}
+
+size_t DrawQueue::getTransparentCount() const {
+    return transparent.size();
+}
+
+void DrawQueue::radixSort(std::vector<uint64_t> &entries) {
+    size_t count = entries.size();
+    if (count < 2) return;
+    // every pass's counts in one read of the entries
+    size_t counts[4][256] = {};
+    for (uint64_t entry : entries) {
+        for (int pass = 0; pass < 4; ++pass) ++counts[pass][entry >> (32 + pass * 8) & 0xff];
+    }
+    scratch.resize(count);
+    for (int pass = 0; pass < 4; ++pass) {
+        int shift = 32 + pass * 8;
+        // a byte all keys share would move nothing
+        if (counts[pass][entries[0] >> shift & 0xff] == count) continue;
+        size_t offsets[256], offset = 0;
+        for (int byte = 0; byte < 256; ++byte) {
+            offsets[byte] = offset;
+            offset += counts[pass][byte];
+        }
+        for (uint64_t entry : entries) scratch[offsets[entry >> shift & 0xff]++] = entry;
+        std::swap(entries, scratch);
+    }
+}
+
+uint32_t DrawQueue::getDepthKey(GLfloat depth) {
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    // negative floats grow with their bits the wrong way, so they are flipped whole, and positive ones go above them
+    return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
@@ -0,0 +1,60 @@
+#ifndef QUEUES_HPP
+#define QUEUES_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "maths.hpp"
+#include "shapes.hpp"
+#include "structures.hpp"
+
+// a simple shape to draw, with the modelview matrix and material it had where the scene put it
+struct DrawItem {
+    Shape *shape;
+    Matrix4 matrix;
+    ColorRGBA color;
+    uint32_t material;
+    GLfloat depth;  // of its center, along the view direction
+};
+
+// the shapes of a frame in two buckets, the opaque ones drawn nearest first so that what they hide fails the depth test
+// before it is shaded, and the see-through ones farthest first, without writing depth, so each blends over what is
+// behind it; both are ordered by radix sorting their depths. coplanar faces of different shapes tie on depth and go to
+// whichever is drawn first, which is the one with the nearer center rather than the one first in the scene, so a pixel
+// or two where the scene has such faces differs from drawing it in scene order
+class DrawQueue {
+    private:
+    std::vector<DrawItem> opaque, transparent;
+    std::vector<uint32_t> opaqueOrder, transparentOrder;
+    std::vector<uint64_t> entries, scratch;
+    bool fixedMaterials = true;
+    void sort(const std::vector<DrawItem> &items, bool farthestFirst, std::vector<uint32_t> &order);
+    void draw(const std::vector<DrawItem> &items, const std::vector<uint32_t> &order, bool depthOnly = false);
+
+    public:
+    void clear();
+    // whether what draws reads materials the fixed pipeline's way, from gl_FrontMaterial, rather than from the table
+    void setFixedMaterials(bool fixedMaterials);
+    // into the transparent bucket when its color or material is see-through
+    void push(const DrawItem &item);
+    // orders both buckets, after everything is pushed
+    void sort();
+    // with the modelview matrix the queue was made with, which the draws go back to
+    void drawOpaque();
+    // only the depth of the opaque shapes, with a depth-only shader bound, for the pre-pass
+    void drawOpaqueDepth();
+    void drawTransparent();
+    size_t getOpaqueCount() const;
+    size_t getTransparentCount() const;
+    // sorts the entries by their upper 32 bits, keeping equal keys in the order they came, a byte a pass and only the
+    // bytes that differ between keys
+    void radixSort(std::vector<uint64_t> &entries);
+    // a key that orders as the depth does, negative ones included
+    static uint32_t getDepthKey(GLfloat depth);
+};
+
+#endif
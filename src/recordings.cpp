@@ -0,0 +1,242 @@
+#include "recordings.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// class Recorder
+
+Recorder::Recorder()
+    : video(false), keepAll(false), recording(false), asynchronous(false), failed(false), width(0), height(0), readbacks{}, next(0), frames(0), dropped(0), stopping(false) {}
+
+Recorder::~Recorder() {
+    // the gl context may be gone by now, so whatever is still on the gpu is given up
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queued.notify_one();
+    if (writer.joinable()) writer.join();
+}
+
+bool Recorder::start(std::string path, GLint width, GLint height, double fps, bool keepAll) {
+    assert(!recording);
+    this->path = path;
+    this->width = width;
+    this->height = height;
+    this->keepAll = keepAll;
+    video = path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+    if (video) {
+        // frames are written whole, through a buffer large enough to take a few at once
+        streamBuffer.resize(1 << 22);
+        stream.rdbuf()->pubsetbuf(streamBuffer.data(), streamBuffer.size());
+        stream.open(path, std::ios::binary);
+        if (!stream) {
+            std::cerr << "couldn't open " << path << std::endl;
+            return false;
+        }
+        // 4:4:4 keeps the color of every pixel, and the range is full since the frames come straight from rgb
+        stream << "YUV4MPEG2 W" << width << " H" << height << " F" << std::lround(fps * 1000) << ":1000 Ip A1:1 C444 XCOLORRANGE=FULL\n";
+    } else {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (!std::filesystem::is_directory(path)) {
+            std::cerr << "couldn't make the directory " << path << std::endl;
+            return false;
+        }
+    }
+
+    // without pixel buffer objects every frame is read back as it is drawn
+    asynchronous = GLEW_ARB_pixel_buffer_object;
+    if (asynchronous) {
+        for (auto &readback : readbacks) {
+            glGenBuffers(1, &readback.buffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, nullptr, GL_STREAM_READ);
+            readback.fence = nullptr;
+            readback.pending = false;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    spare.assign(capacity, std::vector<unsigned char>(width * height * 4));
+    queue.clear();
+    next = 0;
+    frames = dropped = 0;
+    failed = stopping = false;
+    writer = std::thread(&Recorder::write, this);
+    recording = true;
+    return true;
+}
+
+std::vector<unsigned char> Recorder::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (keepAll) released.wait(lock, [this] { return !spare.empty(); });
+    if (spare.empty()) return {};
+    std::vector<unsigned char> pixels = std::move(spare.back());
+    spare.pop_back();
+    return pixels;
+}
+
+void Recorder::submit(unsigned long number, std::vector<unsigned char> pixels) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back({number, std::move(pixels)});
+    }
+    queued.notify_one();
+}
+
+void Recorder::collect(Readback &readback) {
+    readback.pending = false;
+    if (readback.fence) {
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+    }
+    std::vector<unsigned char> pixels = acquire();
+    if (pixels.empty()) {
+        ++dropped;
+        return;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    if (const void *mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY)) {
+        std::memcpy(pixels.data(), mapped, pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        submit(readback.frame, std::move(pixels));
+    } else {
+        std::lock_guard<std::mutex> lock(mutex);
+        spare.push_back(std::move(pixels));
+        ++dropped;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void Recorder::capture() {
+    if (!recording) return;
+    unsigned long frame = frames++;
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    if (!asynchronous) {
+        std::vector<unsigned char> pixels = acquire();
+        if (pixels.empty()) {
+            ++dropped;
+            return;
+        }
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        submit(frame, std::move(pixels));
+        return;
+    }
+
+    // the readback about to be reused is the one made latency frames ago, normally long done
+    Readback &readback = readbacks[next];
+    if (readback.pending) {
+        bool done = !readback.fence || glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) != GL_TIMEOUT_EXPIRED;
+        if (!done && !keepAll) {
+            ++dropped;
+            return;
+        }
+        collect(readback);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    // without fences a readback is taken to be done once its buffer comes round again
+    if (GLEW_ARB_sync) readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.pending = true;
+    readback.frame = frame;
+    next = (next + 1) % latency;
+}
+
+bool Recorder::stop() {
+    if (!recording) return false;
+    // the frames in flight are drawn already, so they are kept whatever the writer's backlog
+    keepAll = true;
+    if (asynchronous) {
+        for (int i = 0; i < latency; ++i) {
+            Readback &readback = readbacks[(next + i) % latency];
+            if (readback.pending) collect(readback);
+            glDeleteBuffers(1, &readback.buffer);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queued.notify_one();
+    writer.join();
+    if (video) stream.close();
+    spare.clear();
+    recording = false;
+    return !failed;
+}
+
+void Recorder::write() {
+    std::vector<unsigned char> data;
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queued.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        bool written = video ? writeVideo(frame, data) : writeImage(frame, data);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!written && !failed) std::cerr << "couldn't write frame " << frame.number << " to " << path << std::endl;
+            failed = failed || !written;
+            spare.push_back(std::move(frame.pixels));
+        }
+        released.notify_one();
+    }
+}
+
+bool Recorder::writeImage(const Frame &frame, std::vector<unsigned char> &data) {
+    std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    data.resize(header.size() + width * height * 3);
+    std::copy(header.begin(), header.end(), data.begin());
+    unsigned char *out = data.data() + header.size();
+    // top down and without alpha
+    for (int row = height - 1; row >= 0; --row) {
+        const unsigned char *in = frame.pixels.data() + row * width * 4;
+        for (int column = 0; column < width; ++column, in += 4, out += 3) {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+        }
+    }
+    std::ostringstream name;
+    name << path << "/frame-" << std::setfill('0') << std::setw(5) << frame.number << ".ppm";
+    std::ofstream file(name.str(), std::ios::binary);
+    file.write((const char *) data.data(), data.size());
+    return file.good();
+}
+
+bool Recorder::writeVideo(const Frame &frame, std::vector<unsigned char> &data) {
+    const char tag[] = "FRAME\n";
+    size_t plane = (size_t) width * height;
+    data.resize(sizeof(tag) - 1 + plane * 3);
+    std::copy(tag, tag + sizeof(tag) - 1, data.begin());
+    unsigned char *y = data.data() + sizeof(tag) - 1, *u = y + plane, *v = u + plane;
+    // full range bt.601 in 8.8 fixed point, top down
+    for (int row = height - 1; row >= 0; --row) {
+        const unsigned char *in = frame.pixels.data() + row * width * 4;
+        for (int column = 0; column < width; ++column, in += 4) {
+            int r = in[0], g = in[1], b = in[2];
+            *y++ = (77 * r + 150 * g + 29 * b + 128) >> 8;
+            *u++ = std::min((-43 * r - 85 * g + 128 * b + 32896) >> 8, 255);
+            *v++ = std::min((128 * r - 107 * g - 21 * b + 32896) >> 8, 255);
+        }
+    }
+    stream.write((const char *) data.data(), data.size());
+    return stream.good();
+}
+
+bool Recorder::isRecording() const { return recording; }
+
+unsigned long Recorder::getFrameCount() const { return frames; }
+
+unsigned long Recorder::getDroppedCount() const { return dropped; }
@@ -0,0 +1,71 @@
+#ifndef RECORDINGS_HPP
+#define RECORDINGS_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// records the frames drawn into a sequence of ppm images or a y4m video, reading each one back into a pixel buffer
+// object and mapping it a few frames later, once the gpu has long finished it, so the renderer never waits on a
+// readback; a thread of its own converts and writes the frames, and when it falls behind (or the gpu does) frames are
+// dropped instead of waited for, unless every frame is wanted, as when rendering offline
+class Recorder {
+    private:
+    static const int latency = 3;  // readbacks in flight before the oldest is mapped
+    static const int capacity = 8;  // frames the writer may fall behind by
+    struct Readback {
+        GLuint buffer;
+        GLsync fence;
+        bool pending;
+        unsigned long frame;
+    };
+    struct Frame {
+        unsigned long number;
+        std::vector<unsigned char> pixels;  // rgba, bottom up as gl reads them
+    };
+    std::string path;
+    bool video, keepAll, recording, asynchronous, failed;
+    GLint width, height;
+    Readback readbacks[latency];
+    int next;
+    unsigned long frames, dropped;
+    std::ofstream stream;
+    std::vector<char> streamBuffer;
+    std::vector<std::vector<unsigned char>> spare;
+    std::deque<Frame> queue;
+    std::mutex mutex;
+    std::condition_variable queued, released;
+    std::thread writer;
+    bool stopping;
+    // a buffer for the writer to take, empty when there is none and frames may be dropped
+    std::vector<unsigned char> acquire();
+    void submit(unsigned long number, std::vector<unsigned char> pixels);
+    void collect(Readback &readback);
+    void write();
+    bool writeImage(const Frame &frame, std::vector<unsigned char> &data);
+    bool writeVideo(const Frame &frame, std::vector<unsigned char> &data);
+
+    public:
+    Recorder();
+    ~Recorder();
+    // a path ending in .y4m is written as one video at the given frame rate, any other is a directory the frames go
+    // into as frame-00000.ppm and on, numbered by when they were drawn so dropped ones leave gaps
+    bool start(std::string path, GLint width, GLint height, double fps, bool keepAll);
+    // reads back the framebuffer bound for reading, once the frame has been drawn
+    void capture();
+    // waits for the frames still in flight to be written, false if any couldn't be
+    bool stop();
+    bool isRecording() const;
+    unsigned long getFrameCount() const;
+    unsigned long getDroppedCount() const;
+};
+
+#endif
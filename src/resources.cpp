@@ -0,0 +1,306 @@
+#define _USE_MATH_DEFINES
+
+#include "resources.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "shaders.hpp"
+
+namespace {
+    struct TextureSlot {
+        uint32_t generation = 0;
+        bool used = false, ready = false, failed = false;
+        std::string path;
+        GLenum target = GL_TEXTURE_2D;
+        GLuint texture = 0;
+    };
+
+    struct ShaderSlot {
+        uint32_t generation = 0;
+        std::unique_ptr<Shader> shader;
+    };
+
+    struct Job {
+        TextureHandle handle;
+        GLenum target;
+        std::vector<std::string> paths;  // a cube map's faces in gl's order
+    };
+
+    // a texture the workers are done with, no faces when one couldn't be decoded, and then how far its upload got
+    struct Decoded {
+        TextureHandle handle;
+        GLenum target;
+        std::vector<DecodedTexture> faces;
+        GLuint id = 0;
+        size_t face = 0, level = 0;
+    };
+
+    // what the workers share with the gl thread; going out of scope stops them, whatever they had left
+    struct Workers {
+        std::mutex mutex;
+        std::condition_variable queued, decoded;
+        std::deque<Job> jobs;
+        std::deque<Decoded> results;
+        std::vector<std::thread> threads;
+        bool stopping = false;
+
+        ~Workers() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            queued.notify_all();
+            for (auto &thread : threads) thread.join();
+        }
+    };
+
+    TextureSampling sampling;
+    std::vector<TextureSlot> textures;
+    std::vector<ShaderSlot> shaders;
+    std::vector<uint32_t> freeTextures, freeShaders;
+    std::map<std::string, uint32_t> texturePaths;
+    std::deque<Decoded> uploads;
+    int pending = 0;
+    GLuint placeholder = 0, cubePlaceholder = 0, unpackBuffer = 0;
+    Workers workers;
+
+    void work() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(workers.mutex);
+                workers.queued.wait(lock, [] { return workers.stopping || !workers.jobs.empty(); });
+                if (workers.stopping) return;
+                job = std::move(workers.jobs.front());
+                workers.jobs.pop_front();
+            }
+            std::vector<DecodedTexture> faces(job.paths.size());
+            bool decoded = true;
+            for (size_t i = 0; i < faces.size() && decoded; ++i) decoded = faces[i].decode(job.paths[i], sampling.mipmaps);
+            // a cube map's faces are squares of one size and format
+            for (auto &face : faces) {
+                if (!decoded) break;
+                const DecodedTexture::Level &level = face.levels[0], &first = faces[0].levels[0];
+                bool matches = face.internalFormat == faces[0].internalFormat && face.levels.size() == faces[0].levels.size() && level.width == first.width && level.height == first.height;
+                decoded = job.target != GL_TEXTURE_CUBE_MAP || matches && level.width == level.height;
+                if (!decoded) std::cerr << "the faces of cube map " << job.paths[0] << " and on differ in size or format" << std::endl;
+            }
+            if (!decoded) faces.clear();
+            {
+                std::lock_guard<std::mutex> lock(workers.mutex);
+                workers.results.push_back({job.handle, job.target, std::move(faces)});
+            }
+            workers.decoded.notify_all();
+        }
+    }
+
+    TextureSlot *find(TextureHandle handle) {
+        if (!handle || handle.index >= textures.size()) return nullptr;
+        TextureSlot &slot = textures[handle.index];
+        return slot.used && slot.generation == handle.generation ? &slot : nullptr;
+    }
+
+    // copies a level into the unpack buffer and has gl take it from there, so the driver can return before the copy to
+    // the texture is done
+    void uploadLevel(Decoded &upload) {
+        const DecodedTexture &face = upload.faces[upload.face];
+        const DecodedTexture::Level &level = face.levels[upload.level];
+        GLenum target = upload.target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + upload.face : upload.target;
+        glBindTexture(upload.target, upload.id);
+        void *mapped = nullptr;
+        if (unpackBuffer) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+            // orphaned first, so the copy out of the previous level needn't be waited for
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, level.size, nullptr, GL_STREAM_DRAW);
+            mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+        }
+        if (mapped) {
+            std::memcpy(mapped, level.data, level.size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            Textures::uploadLevel(target, face, upload.level, nullptr);
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            Textures::uploadLevel(target, face, upload.level, level.data);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(upload.target, 0);
+        // every level of a face before the next face
+        if (++upload.level == face.levels.size()) {
+            upload.level = 0;
+            ++upload.face;
+        }
+    }
+
+    TextureHandle load(GLenum target, std::vector<std::string> paths) {
+        assert(!workers.threads.empty());
+        // cube maps go by their faces together
+        std::string key;
+        for (auto &path : paths) key += (key.empty() ? "" : "\n") + path;
+        auto existing = texturePaths.find(key);
+        if (existing != texturePaths.end()) return {existing->second, textures[existing->second].generation};
+
+        uint32_t index = textures.size();
+        if (freeTextures.empty()) {
+            textures.emplace_back();
+        } else {
+            index = freeTextures.back();
+            freeTextures.pop_back();
+        }
+        TextureSlot &slot = textures[index];
+        slot.used = true;
+        slot.ready = slot.failed = false;
+        slot.path = key;
+        slot.target = target;
+        TextureHandle handle = {index, ++slot.generation};
+        texturePaths[key] = index;
+        ++pending;
+        {
+            std::lock_guard<std::mutex> lock(workers.mutex);
+            workers.jobs.push_back({handle, target, paths});
+        }
+        workers.queued.notify_one();
+        return handle;
+    }
+}
+
+// namespace Resources
+
+void Resources::initialize(TextureSampling sampling, int count) {
+    assert(workers.threads.empty());
+    ::sampling = sampling;
+    // a mid gray texel, which neither flashes nor hides the color it modulates while the real texture loads, on its own
+    // and on every face of a cube map
+    const unsigned char gray[] = {128, 128, 128};
+    glGenTextures(1, &placeholder);
+    glGenTextures(1, &cubePlaceholder);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (GLenum target : {GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP}) {
+        glBindTexture(target, target == GL_TEXTURE_2D ? placeholder : cubePlaceholder);
+        for (int face = 0; face < (target == GL_TEXTURE_2D ? 1 : 6); ++face) {
+            glTexImage2D(target == GL_TEXTURE_2D ? target : GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, gray);
+        }
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(target, 0);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (GLEW_ARB_pixel_buffer_object) glGenBuffers(1, &unpackBuffer);
+    for (int i = 0; i < std::max(count, 1); ++i) workers.threads.emplace_back(work);
+}
+
+TextureHandle Resources::loadTexture(std::string path) {
+    return load(GL_TEXTURE_2D, {path});
+}
+
+TextureHandle Resources::loadCubeMap(std::vector<std::string> faces) {
+    assert(faces.size() == 6);
+    return load(GL_TEXTURE_CUBE_MAP, faces);
+}
+
+GLuint Resources::getTexture(TextureHandle texture, GLenum target) {
+    TextureSlot *slot = find(texture);
+    if (slot && slot->failed) return 0;
+    return slot && slot->ready ? slot->texture : target == GL_TEXTURE_CUBE_MAP ? cubePlaceholder : placeholder;
+}
+
+bool Resources::isReady(TextureHandle texture) {
+    TextureSlot *slot = find(texture);
+    return slot && slot->ready;
+}
+
+void Resources::release(TextureHandle texture) {
+    TextureSlot *slot = find(texture);
+    if (!slot) return;
+    // one still loading is dropped when it comes back, the generation no longer matching
+    if (slot->texture) glDeleteTextures(1, &slot->texture);
+    texturePaths.erase(slot->path);
+    *slot = {slot->generation};
+    freeTextures.push_back(texture.index);
+}
+
+ShaderHandle Resources::addShader(Shader *shader) {
+    uint32_t index = shaders.size();
+    if (freeShaders.empty()) {
+        shaders.emplace_back();
+    } else {
+        index = freeShaders.back();
+        freeShaders.pop_back();
+    }
+    ShaderSlot &slot = shaders[index];
+    slot.shader.reset(shader);
+    return {index, ++slot.generation};
+}
+
+Shader *Resources::getShader(ShaderHandle shader) {
+    if (!shader || shader.index >= shaders.size() || shaders[shader.index].generation != shader.generation) return nullptr;
+    return shaders[shader.index].shader.get();
+}
+
+void Resources::release(ShaderHandle shader) {
+    if (!getShader(shader)) return;
+    shaders[shader.index].shader.reset();
+    ++shaders[shader.index].generation;
+    freeShaders.push_back(shader.index);
+}
+
+void Resources::update(size_t budget) {
+    {
+        std::lock_guard<std::mutex> lock(workers.mutex);
+        while (!workers.results.empty()) {
+            uploads.push_back(std::move(workers.results.front()));
+            workers.results.pop_front();
+        }
+    }
+
+    size_t uploaded = 0;
+    while (!uploads.empty() && uploaded < budget) {
+        Decoded &upload = uploads.front();
+        TextureSlot *slot = find(upload.handle);
+        if (!slot || upload.faces.empty()) {
+            // released meanwhile, or not decodable, in which case it is drawn untextured
+            if (slot) slot->failed = true;
+            if (upload.id) glDeleteTextures(1, &upload.id);
+            uploads.pop_front();
+            --pending;
+            continue;
+        }
+        if (!upload.id) glGenTextures(1, &upload.id);
+        uploaded += upload.faces[upload.face].levels[upload.level].size;
+        uploadLevel(upload);
+        if (upload.face < upload.faces.size()) continue;
+
+        // complete, so it is sampled from the next draw on
+        glBindTexture(upload.target, upload.id);
+        Textures::setSampling(upload.target, upload.faces[0].levels.size(), sampling);
+        glBindTexture(upload.target, 0);
+        slot->texture = upload.id;
+        slot->ready = true;
+        uploads.pop_front();
+        --pending;
+    }
+}
+
+void Resources::finish() {
+    while (true) {
+        update(SIZE_MAX);
+        if (pending == 0) return;
+        std::unique_lock<std::mutex> lock(workers.mutex);
+        workers.decoded.wait(lock, [] { return !workers.results.empty(); });
+    }
+}
+
+int Resources::getPendingCount() {
+    return pending;
+}
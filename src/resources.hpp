@@ -0,0 +1,60 @@
+#ifndef RESOURCES_HPP
+#define RESOURCES_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "textures.hpp"
+
+class Shader;
+
+// a slot in one of the resource tables and the generation it was filled in, so a handle kept past its resource's
+// release never reaches whatever fills the slot next
+template <typename T>
+struct Handle {
+    uint32_t index = 0, generation = 0;  // generations start at 1, the default handle names nothing
+
+    explicit operator bool() const { return generation != 0; }
+    bool operator==(const Handle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle &other) const { return !(*this == other); }
+};
+
+using TextureHandle = Handle<struct TextureTag>;
+using ShaderHandle = Handle<Shader>;
+
+// the textures and shaders drawing refers to by handle; textures are decoded by worker threads and uploaded on the gl
+// thread a few levels a frame, through a pixel unpack buffer, and until a texture is in a placeholder is drawn instead
+namespace Resources {
+    // makes the placeholder and starts the workers, once there is a gl context; the workers stop at exit
+    void initialize(TextureSampling sampling, int workers = 2);
+
+    // queues a texture, the same handle for the same path while it is held
+    TextureHandle loadTexture(std::string path);
+    // queues a cube map from its six faces, +x, -x, +y, -y, +z and -z, all squares of one size
+    TextureHandle loadCubeMap(std::vector<std::string> faces);
+    // the texture to bind to the target: the placeholder while it loads and once it is released, 0 if it couldn't be
+    // loaded
+    GLuint getTexture(TextureHandle texture, GLenum target = GL_TEXTURE_2D);
+    bool isReady(TextureHandle texture);
+    void release(TextureHandle texture);
+
+    // takes ownership of a compiled shader
+    ShaderHandle addShader(Shader *shader);
+    // nullptr for released shaders and the default handle
+    Shader *getShader(ShaderHandle shader);
+    void release(ShaderHandle shader);
+
+    // uploads decoded textures until about budget bytes went through, always at least a level; once a frame
+    void update(size_t budget = 4 << 20);
+    // waits until every texture queued so far is uploaded, for frames that must not change with load times
+    void finish();
+    // textures queued and not uploaded yet
+    int getPendingCount();
+}
+
+#endif
@@ -0,0 +1,1024 @@
+#include "scenes.hpp"
+
+#include <assert.h>
+
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "files.hpp"
+#include "sequences.hpp"
+
+namespace {
+    enum class Code : uint32_t { Constant, Index, Variable, Negate, Add, Subtract, Multiply, Divide, Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual, Select, Sin, Cos, Sqrt, Abs, Min, Max, Count };
+    enum class NodeKind : uint32_t { Cuboid, Prism, Sphere, Donut, Ring, Group, Clone, Count };
+    enum class PropertyKind : uint32_t { Translate, Rotate, Scale, Material, Color, Texture, Mesh, Click, Count };
+    enum class LightKind : uint32_t { Ambient, Directional, Point, Spot, Count };
+
+    const uint32_t none = 0xffffffff;
+    const uint32_t readsVariables = 1, readsIndices = 2;  // expression flags
+    const int maxStack = 32, maxDepth = 32;
+
+    // in the order Ease::byIndex numbers them
+    const char *easeNames[] = {
+        "linear",
+        "quadraticIn", "quadraticOut", "quadraticInOut", "cubicIn", "cubicOut", "cubicInOut",
+        "quarticIn", "quarticOut", "quarticInOut", "quinticIn", "quinticOut", "quinticInOut",
+        "sinusoidalIn", "sinusoidalOut", "sinusoidalInOut", "exponentialIn", "exponentialOut", "exponentialInOut",
+        "circularIn", "circularOut", "circularInOut",
+    };
+    const int easeCount = sizeof easeNames / sizeof *easeNames;
+
+    // how deep the stack must be for an op, and how it changes
+    int needed(Code code) {
+        switch (code) {
+            case Code::Constant: case Code::Index: case Code::Variable: return 0;
+            case Code::Negate: case Code::Sin: case Code::Cos: case Code::Sqrt: case Code::Abs: return 1;
+            case Code::Select: return 3;
+            default: return 2;
+        }
+    }
+    int change(Code code) { return code <= Code::Variable ? 1 : 1 - needed(code); }
+
+    // primitives take one of two argument counts
+    bool validArguments(NodeKind kind, uint32_t count) {
+        switch (kind) {
+            case NodeKind::Cuboid: return count == 3;
+            case NodeKind::Prism: return count == 3 || count == 5;
+            case NodeKind::Sphere: return count == 2 || count == 6;
+            case NodeKind::Donut: return count == 4 || count == 8;
+            case NodeKind::Ring: return count == 4 || count == 6;
+            case NodeKind::Clone: return count == 1;
+            default: return count == 0;
+        }
+    }
+
+    GLfloat bitsToFloat(uint32_t bits) {
+        GLfloat value;
+        std::memcpy(&value, &bits, sizeof value);
+        return value;
+    }
+
+    uint32_t floatToBits(GLfloat value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        return bits;
+    }
+}
+
+// class SceneFile::Compiler
+
+// turns the text form into records, one statement at a time; a use of a definition parses the definition again where
+// it is used, so clone indices in it refer to the clones around the use
+class SceneFile::Compiler {
+    public:
+    struct Token {
+        enum Type { Number, Name, Symbol, End } type;
+        std::string text;
+        GLfloat value;
+        int line;
+    };
+    struct Error {
+        std::string message;
+        int line;
+    };
+    std::vector<Token> tokens;
+    size_t cursor = 0;
+    // records
+    std::vector<Name> nameRecords;
+    std::string nameData;
+    std::vector<Op> opRecords;
+    std::vector<Expression> expressionRecords;
+    std::vector<uint32_t> argumentRecords;
+    std::vector<Property> propertyRecords;
+    std::vector<Node> nodeRecords;
+    std::vector<Material> materialRecords;
+    std::vector<LightRecord> lightRecords;
+    std::vector<AnimationRecord> animationRecords;
+    std::vector<Track> trackRecords;
+    std::vector<Root> rootRecords;
+    // what only exists while compiling
+    std::map<std::string, uint32_t> nameIndices, materialIndices;
+    std::map<std::string, std::array<GLfloat, 4>> colors;
+    std::map<std::string, size_t> definitions;
+    std::vector<std::string> scope;  // clone indices, innermost last
+    int uses = 0;
+
+    void tokenize(const std::string &text) {
+        int line = 1;
+        for (size_t i = 0; i < text.size();) {
+            char c = text[i];
+            if (c == '\n') ++line;
+            if (std::isspace((unsigned char) c)) {
+                ++i;
+            } else if (c == '#') {
+                while (i < text.size() && text[i] != '\n') ++i;
+            } else if (std::isdigit((unsigned char) c) || c == '.' && i + 1 < text.size() && std::isdigit((unsigned char) text[i + 1])) {
+                char *end;
+                GLfloat value = std::strtof(text.c_str() + i, &end);
+                size_t length = end - (text.c_str() + i);
+                tokens.push_back({Token::Number, text.substr(i, length), value, line});
+                i += length;
+            } else if (std::isalpha((unsigned char) c) || c == '_') {
+                size_t start = i;
+                while (i < text.size() && (std::isalnum((unsigned char) text[i]) || text[i] == '_')) ++i;
+                tokens.push_back({Token::Name, text.substr(start, i - start), 0, line});
+            } else if (i + 1 < text.size() && std::strchr("<>=!", c) && text[i + 1] == '=') {
+                tokens.push_back({Token::Symbol, text.substr(i, 2), 0, line});
+                i += 2;
+            } else if (std::strchr("(){},;+-*/?:<>", c)) {
+                tokens.push_back({Token::Symbol, std::string(1, c), 0, line});
+                ++i;
+            } else {
+                throw Error{std::string("unexpected character '") + c + "'", line};
+            }
+        }
+        tokens.push_back({Token::End, "end of file", 0, line});
+    }
+
+    [[noreturn]] void fail(std::string message) { throw Error{message, peek().line}; }
+    const Token &peek() { return tokens[cursor]; }
+    const Token &next() { return tokens[cursor < tokens.size() - 1 ? cursor++ : cursor]; }
+    bool isSymbol(const char *symbol) { return peek().type == Token::Symbol && peek().text == symbol; }
+    bool isName(const char *name) { return peek().type == Token::Name && peek().text == name; }
+    bool accept(const char *text) {
+        if (!isSymbol(text) && !isName(text)) return false;
+        ++cursor;
+        return true;
+    }
+    void expect(const char *text) {
+        if (!accept(text)) fail(std::string("expected '") + text + "' instead of '" + peek().text + "'");
+    }
+    std::string expectName() {
+        if (peek().type != Token::Name) fail("expected a name instead of '" + peek().text + "'");
+        return next().text;
+    }
+
+    uint32_t name(const std::string &text) {
+        auto found = nameIndices.find(text);
+        if (found != nameIndices.end()) return found->second;
+        nameRecords.push_back({(uint32_t) nameData.size(), (uint32_t) text.size()});
+        nameData += text;
+        return nameIndices[text] = nameRecords.size() - 1;
+    }
+
+    int ease() {
+        std::string name = expectName();
+        for (int i = 0; i < easeCount; ++i) {
+            if (name == easeNames[i]) return i;
+        }
+        fail("unknown easing '" + name + "'");
+    }
+
+    // expressions, compiled to a postfix program
+
+    void push(std::vector<Op> &ops, Code code, uint32_t operand = 0) { ops.push_back({(uint32_t) code, operand}); }
+
+    void primary(std::vector<Op> &ops, uint32_t &flags) {
+        if (accept("(")) {
+            ternary(ops, flags);
+            expect(")");
+        } else if (accept("-")) {
+            primary(ops, flags);
+            push(ops, Code::Negate);
+        } else if (peek().type == Token::Number) {
+            push(ops, Code::Constant, floatToBits(next().value));
+        } else {
+            std::string identifier = expectName();
+            if (accept("(")) {
+                static const std::map<std::string, Code> functions = {{"sin", Code::Sin}, {"cos", Code::Cos}, {"sqrt", Code::Sqrt}, {"abs", Code::Abs}, {"min", Code::Min}, {"max", Code::Max}};
+                auto function = functions.find(identifier);
+                if (function == functions.end()) fail("unknown function '" + identifier + "'");
+                for (int i = 0; i < needed(function->second); ++i) {
+                    if (i > 0) expect(",");
+                    ternary(ops, flags);
+                }
+                expect(")");
+                push(ops, function->second);
+            } else if (identifier == "pi") {
+                push(ops, Code::Constant, floatToBits(M_PI));
+            } else {
+                auto index = std::find(scope.rbegin(), scope.rend(), identifier);
+                if (index != scope.rend()) {
+                    push(ops, Code::Index, index - scope.rbegin());
+                    flags |= readsIndices;
+                } else {
+                    push(ops, Code::Variable, name(identifier));
+                    flags |= readsVariables;
+                }
+            }
+        }
+    }
+
+    void product(std::vector<Op> &ops, uint32_t &flags) {
+        primary(ops, flags);
+        while (isSymbol("*") || isSymbol("/")) {
+            Code code = next().text == "*" ? Code::Multiply : Code::Divide;
+            primary(ops, flags);
+            push(ops, code);
+        }
+    }
+
+    void sum(std::vector<Op> &ops, uint32_t &flags) {
+        product(ops, flags);
+        while (isSymbol("+") || isSymbol("-")) {
+            Code code = next().text == "+" ? Code::Add : Code::Subtract;
+            product(ops, flags);
+            push(ops, code);
+        }
+    }
+
+    void comparison(std::vector<Op> &ops, uint32_t &flags) {
+        static const std::map<std::string, Code> comparisons = {{"<", Code::Less}, {"<=", Code::LessEqual}, {">", Code::Greater}, {">=", Code::GreaterEqual}, {"==", Code::Equal}, {"!=", Code::NotEqual}};
+        sum(ops, flags);
+        while (peek().type == Token::Symbol && comparisons.count(peek().text)) {
+            Code code = comparisons.at(next().text);
+            sum(ops, flags);
+            push(ops, code);
+        }
+    }
+
+    void ternary(std::vector<Op> &ops, uint32_t &flags) {
+        comparison(ops, flags);
+        if (accept("?")) {
+            ternary(ops, flags);
+            expect(":");
+            ternary(ops, flags);
+            push(ops, Code::Select);
+        }
+    }
+
+    uint32_t record(std::vector<Op> &ops, uint32_t flags) {
+        // anything that reads neither indices nor variables is folded into a constant
+        if (flags == 0 && ops.size() > 1) {
+            GLfloat value = SceneFile::run(ops.data(), ops.size(), nullptr, 0, nullptr);
+            ops = {{(uint32_t) Code::Constant, floatToBits(value)}};
+        }
+        expressionRecords.push_back({(uint32_t) opRecords.size(), (uint32_t) ops.size(), flags});
+        opRecords.insert(opRecords.end(), ops.begin(), ops.end());
+        return expressionRecords.size() - 1;
+    }
+
+    // a full expression, as in parentheses and shape arguments
+    uint32_t expression() {
+        std::vector<Op> ops;
+        uint32_t flags = 0;
+        ternary(ops, flags);
+        return record(ops, flags);
+    }
+
+    // a single number of a statement
+    uint32_t term() {
+        std::vector<Op> ops;
+        uint32_t flags = 0;
+        primary(ops, flags);
+        return record(ops, flags);
+    }
+
+    uint32_t constant(GLfloat value) {
+        std::vector<Op> ops = {{(uint32_t) Code::Constant, floatToBits(value)}};
+        return record(ops, 0);
+    }
+
+    GLfloat constantTerm() {
+        uint32_t expression = term();
+        if (expressionRecords[expression].flags) fail("expected a constant");
+        return bitsToFloat(opRecords[expressionRecords[expression].firstOp].operand);
+    }
+
+    bool startsColor() { return peek().type == Token::Name && colors.count(peek().text); }
+
+    std::array<GLfloat, 4> constantColor() {
+        if (startsColor()) return colors.at(next().text);
+        std::array<GLfloat, 4> color;
+        for (auto &channel : color) channel = constantTerm();
+        return color;
+    }
+
+    void color(uint32_t *expressions) {
+        if (startsColor()) {
+            for (GLfloat channel : colors.at(next().text)) *expressions++ = constant(channel);
+        } else {
+            for (int i = 0; i < 4; ++i) expressions[i] = term();
+        }
+    }
+
+    // nodes
+
+    bool isPropertyKeyword() {
+        static const char *keywords[] = {"translate", "rotate", "scale", "material", "color", "texture", "mesh", "click"};
+        return peek().type == Token::Name && std::any_of(std::begin(keywords), std::end(keywords), [this](const char *keyword) { return peek().text == keyword; });
+    }
+
+    // parses what a node is and the properties given with it, leaving the properties to the caller
+    NodeKind head(std::vector<Property> &properties) {
+        static const std::map<std::string, NodeKind> primitives = {{"cuboid", NodeKind::Cuboid}, {"prism", NodeKind::Prism}, {"sphere", NodeKind::Sphere}, {"donut", NodeKind::Donut}, {"ring", NodeKind::Ring}};
+        int line = peek().line;
+        std::string keyword = expectName();
+        if (keyword == "use") {
+            std::string definition = expectName();
+            auto found = definitions.find(definition);
+            if (found == definitions.end()) fail("unknown definition '" + definition + "'");
+            if (++uses > 64) fail("definitions use each other endlessly");
+            size_t resume = cursor;
+            cursor = found->second;
+            NodeKind kind = head(properties);
+            nodeProperties(kind, properties);
+            cursor = resume;
+            --uses;
+            return kind;
+        }
+
+        size_t index = nodeRecords.size();
+        nodeRecords.push_back({});
+        Node node = {0, (uint32_t) argumentRecords.size(), 0, 0, 0, 0, 0};
+        if (primitives.count(keyword)) {
+            node.kind = (uint32_t) primitives.at(keyword);
+            std::vector<uint32_t> values;
+            expect("(");
+            do {
+                uint32_t value = expression();
+                if (expressionRecords[value].flags & readsVariables) fail("shape parameters can't read variables");
+                values.push_back(value);
+            } while (accept(","));
+            expect(")");
+            argumentRecords.insert(argumentRecords.end(), values.begin(), values.end());
+            node.argumentCount = values.size();
+            if (!validArguments((NodeKind) node.kind, node.argumentCount)) throw Error{"wrong number of arguments for " + keyword, line};
+        } else if (keyword == "group") {
+            node.kind = (uint32_t) NodeKind::Group;
+            expect("{");
+            while (!accept("}")) {
+                if (peek().type == Token::End) fail("unclosed group");
+                child();
+                ++node.childCount;
+            }
+        } else if (keyword == "clone") {
+            node.kind = (uint32_t) NodeKind::Clone;
+            std::string index = expectName();
+            uint32_t count = term();
+            if (expressionRecords[count].flags & readsVariables) fail("clone counts can't read variables");
+            argumentRecords.push_back(count);
+            node.argumentCount = 1;
+            scope.push_back(index);
+            expect("{");
+            child();
+            expect("}");
+            scope.pop_back();
+            node.childCount = 1;
+        } else {
+            throw Error{"expected a shape instead of '" + keyword + "'", line};
+        }
+        node.size = nodeRecords.size() - index;
+        nodeRecords[index] = node;
+        return (NodeKind) node.kind;
+    }
+
+    void nodeProperties(NodeKind kind, std::vector<Property> &properties) {
+        bool simple = kind < NodeKind::Group;
+        while (isPropertyKeyword()) {
+            std::string keyword = next().text;
+            Property property = {0, {none, none, none, none}};
+            if (keyword == "translate" || keyword == "rotate" || keyword == "scale") {
+                property.kind = (uint32_t) (keyword == "translate" ? PropertyKind::Translate : keyword == "rotate" ? PropertyKind::Rotate : PropertyKind::Scale);
+                for (int i = 0; i < 3; ++i) property.operands[i] = term();
+            } else if (keyword == "material") {
+                property.kind = (uint32_t) PropertyKind::Material;
+                std::string material = expectName();
+                if (!materialIndices.count(material)) fail("unknown material '" + material + "'");
+                property.operands[0] = materialIndices.at(material);
+            } else if (keyword == "color") {
+                property.kind = (uint32_t) PropertyKind::Color;
+                color(property.operands);
+                for (uint32_t channel : property.operands) {
+                    if (expressionRecords[channel].flags & readsVariables) fail("shape colors can't read variables");
+                }
+            } else if (keyword == "texture") {
+                if (!simple) fail("only shapes can be textured, not groups");
+                property.kind = (uint32_t) PropertyKind::Texture;
+                property.operands[0] = name(expectName());
+            } else if (keyword == "mesh") {
+                if (!simple) fail("only shapes have meshes, not groups");
+                property.kind = (uint32_t) PropertyKind::Mesh;
+                property.operands[0] = term();
+                if (expressionRecords[property.operands[0]].flags & readsVariables) fail("mesh levels can't read variables");
+                if (!isPropertyKeyword() && !isSymbol(";") && !isSymbol("}") && peek().type != Token::End && !startsNode()) property.operands[1] = term();
+            } else {
+                property.kind = (uint32_t) PropertyKind::Click;
+                expect("tween");
+                property.operands[0] = name(expectName());
+                property.operands[1] = term();
+                property.operands[2] = term();
+                property.operands[3] = ease();
+            }
+            properties.push_back(property);
+        }
+    }
+
+    bool startsNode() {
+        static const char *keywords[] = {"cuboid", "prism", "sphere", "donut", "ring", "group", "clone", "use"};
+        return peek().type == Token::Name && std::any_of(std::begin(keywords), std::end(keywords), [this](const char *keyword) { return peek().text == keyword; });
+    }
+
+    // a node with everything given for it, its properties stored after its children's
+    uint32_t child() {
+        uint32_t index = nodeRecords.size();
+        std::vector<Property> properties;
+        NodeKind kind = head(properties);
+        nodeProperties(kind, properties);
+        nodeRecords[index].firstProperty = propertyRecords.size();
+        nodeRecords[index].propertyCount = properties.size();
+        propertyRecords.insert(propertyRecords.end(), properties.begin(), properties.end());
+        return index;
+    }
+
+    // statements
+
+    void light() {
+        static const std::map<std::string, LightKind> kinds = {{"ambient", LightKind::Ambient}, {"directional", LightKind::Directional}, {"point", LightKind::Point}, {"spot", LightKind::Spot}};
+        std::string kind = expectName();
+        if (!kinds.count(kind)) fail("unknown light '" + kind + "'");
+        LightRecord light;
+        light.kind = (uint32_t) kinds.at(kind);
+        std::fill(std::begin(light.expressions), std::end(light.expressions), none);
+        if (light.kind == (uint32_t) LightKind::Ambient) {
+            color(light.expressions);
+        } else {
+            if (accept("ambient")) color(light.expressions);
+            expect("diffuse");
+            color(light.expressions + 4);
+            expect("specular");
+            color(light.expressions + 8);
+            expect(light.kind == (uint32_t) LightKind::Directional ? "direction" : "position");
+            for (int i = 12; i < 15; ++i) light.expressions[i] = term();
+            if (light.kind == (uint32_t) LightKind::Spot) {
+                expect("direction");
+                for (int i = 15; i < 18; ++i) light.expressions[i] = term();
+                expect("cutoff");
+                light.expressions[18] = constant(constantTerm());
+                expect("exponent");
+                light.expressions[19] = constant(constantTerm());
+            }
+            if (light.kind != (uint32_t) LightKind::Directional && accept("attenuation")) {
+                for (int i = 20; i < 23; ++i) light.expressions[i] = constant(constantTerm());
+            }
+            if (accept("on")) light.expressions[23] = term();
+        }
+        for (uint32_t expression : light.expressions) {
+            if (expression != none && expressionRecords[expression].flags & readsIndices) fail("lights are outside clones");
+        }
+        lightRecords.push_back(light);
+    }
+
+    void animation() {
+        AnimationRecord animation = {name(expectName()), (uint32_t) trackRecords.size(), 0};
+        expect("{");
+        while (!accept("}")) {
+            Track track;
+            track.target = name(expectName());
+            GLfloat start = constantTerm(), duration = constantTerm();
+            if (start < 0 || duration < 0) fail("tracks can't start or last less than nothing");
+            track.start = start;
+            track.duration = duration;
+            track.first = track.last = constantTerm();
+            track.easing = 0;
+            if (!isSymbol(";")) {
+                track.last = constantTerm();
+                track.easing = ease();
+            }
+            expect(";");
+            trackRecords.push_back(track);
+            ++animation.trackCount;
+        }
+        animationRecords.push_back(animation);
+    }
+
+    void statement() {
+        std::string keyword = expectName();
+        if (keyword == "color") {
+            std::string color = expectName();
+            colors[color] = constantColor();
+        } else if (keyword == "material") {
+            Material material;
+            std::string materialName = expectName();
+            material.name = name(materialName);
+            for (auto [channel, values] : {std::pair{"ambient", material.ambient}, {"diffuse", material.diffuse}, {"specular", material.specular}}) {
+                expect(channel);
+                std::array<GLfloat, 4> color = constantColor();
+                std::copy(color.begin(), color.end(), values);
+            }
+            expect("shininess");
+            material.shininess = constantTerm();
+            materialIndices[materialName] = materialRecords.size();
+            materialRecords.push_back(material);
+        } else if (keyword == "light") {
+            light();
+        } else if (keyword == "define") {
+            std::string definition = expectName();
+            definitions[definition] = cursor;
+            // skipped for now, it is parsed where it is used
+            int depth = 0;
+            while (!(depth == 0 && isSymbol(";"))) {
+                if (peek().type == Token::End) fail("unfinished definition");
+                if (isSymbol("(") || isSymbol("{")) ++depth;
+                if (isSymbol(")") || isSymbol("}")) --depth;
+                next();
+            }
+        } else if (keyword == "root") {
+            uint32_t root = name(expectName());
+            rootRecords.push_back({root, child()});
+        } else if (keyword == "animation") {
+            animation();
+        } else {
+            fail("unknown statement '" + keyword + "'");
+        }
+        expect(";");
+    }
+
+    // lays the records out the way they are stored on disk
+    std::shared_ptr<const char> layout(size_t &bytes) {
+        Header header = {{'S', 'C', 'N', 'E'}, SceneFile::version, (uint32_t) nameRecords.size(), (uint32_t) nameData.size(), (uint32_t) opRecords.size(), (uint32_t) expressionRecords.size(),
+                         (uint32_t) argumentRecords.size(), (uint32_t) propertyRecords.size(), (uint32_t) nodeRecords.size(), (uint32_t) materialRecords.size(), (uint32_t) lightRecords.size(),
+                         (uint32_t) animationRecords.size(), (uint32_t) trackRecords.size(), (uint32_t) rootRecords.size()};
+        auto size = [](const auto &records) { return records.size() * sizeof(records[0]); };
+        bytes = sizeof(Header) + size(nameRecords) + size(opRecords) + size(expressionRecords) + size(argumentRecords) + size(propertyRecords) + size(nodeRecords) + size(materialRecords) +
+                size(lightRecords) + size(animationRecords) + size(trackRecords) + size(rootRecords) + nameData.size();
+        char *buffer = new char[bytes];
+        char *cursor = buffer;
+        auto write = [&cursor](const void *source, size_t length) {
+            if (length) std::memcpy(cursor, source, length);
+            cursor += length;
+        };
+        write(&header, sizeof header);
+        write(nameRecords.data(), size(nameRecords));
+        write(opRecords.data(), size(opRecords));
+        write(expressionRecords.data(), size(expressionRecords));
+        write(argumentRecords.data(), size(argumentRecords));
+        write(propertyRecords.data(), size(propertyRecords));
+        write(nodeRecords.data(), size(nodeRecords));
+        write(materialRecords.data(), size(materialRecords));
+        write(lightRecords.data(), size(lightRecords));
+        write(animationRecords.data(), size(animationRecords));
+        write(trackRecords.data(), size(trackRecords));
+        write(rootRecords.data(), size(rootRecords));
+        write(nameData.data(), nameData.size());
+        return std::shared_ptr<const char>(buffer, std::default_delete<const char[]>());
+    }
+};
+
+// class SceneFile
+
+SceneFile::SceneFile()
+    : size(0), header(nullptr), names(nullptr), ops(nullptr), expressions(nullptr), arguments(nullptr), properties(nullptr), nodes(nullptr), materials(nullptr), lights(nullptr),
+      animationRecords(nullptr), tracks(nullptr), roots(nullptr), nameData(nullptr) {}
+
+bool SceneFile::compile(std::string text) {
+    Compiler compiler;
+    try {
+        compiler.tokenize(text);
+        while (compiler.peek().type != Compiler::Token::End) compiler.statement();
+    } catch (const Compiler::Error &error) {
+        std::cerr << "scene line " << error.line << ": " << error.message << std::endl;
+        return false;
+    }
+    size_t bytes;
+    std::shared_ptr<const char> data = compiler.layout(bytes);
+    return attach(data, bytes);
+}
+
+bool SceneFile::attach(std::shared_ptr<const char> data, size_t size) {
+    if (size < sizeof(Header)) return false;
+    const Header *header = (const Header *) data.get();
+    if (std::memcmp(header->magic, "SCNE", 4) != 0 || header->version != version) return false;
+    size_t expected = sizeof(Header) + (size_t) header->nameCount * sizeof(Name) + (size_t) header->opCount * sizeof(Op) + (size_t) header->expressionCount * sizeof(Expression) +
+                      (size_t) header->argumentCount * sizeof(uint32_t) + (size_t) header->propertyCount * sizeof(Property) + (size_t) header->nodeCount * sizeof(Node) +
+                      (size_t) header->materialCount * sizeof(Material) + (size_t) header->lightCount * sizeof(LightRecord) + (size_t) header->animationCount * sizeof(AnimationRecord) +
+                      (size_t) header->trackCount * sizeof(Track) + (size_t) header->rootCount * sizeof(Root) + header->nameBytes;
+    if (size != expected) return false;
+
+    SceneFile scene;
+    scene.data = data;
+    scene.size = size;
+    scene.header = header;
+    scene.names = (const Name *) (header + 1);
+    scene.ops = (const Op *) (scene.names + header->nameCount);
+    scene.expressions = (const Expression *) (scene.ops + header->opCount);
+    scene.arguments = (const uint32_t *) (scene.expressions + header->expressionCount);
+    scene.properties = (const Property *) (scene.arguments + header->argumentCount);
+    scene.nodes = (const Node *) (scene.properties + header->propertyCount);
+    scene.materials = (const Material *) (scene.nodes + header->nodeCount);
+    scene.lights = (const LightRecord *) (scene.materials + header->materialCount);
+    scene.animationRecords = (const AnimationRecord *) (scene.lights + header->lightCount);
+    scene.tracks = (const Track *) (scene.animationRecords + header->animationCount);
+    scene.roots = (const Root *) (scene.tracks + header->trackCount);
+    scene.nameData = (const char *) (scene.roots + header->rootCount);
+    if (!scene.validate()) return false;
+    *this = scene;
+    return true;
+}
+
+bool SceneFile::validate() const {
+    // every index is checked once here, and every rule the compiler holds the text to, so nothing made from the records
+    // has to
+    auto expression = [this](uint32_t index) { return index < header->expressionCount; };
+    auto optional = [&](uint32_t index) { return index == none || expression(index); };
+    auto unused = [](uint32_t index) { return index == none; };
+    auto fixed = [&](uint32_t index) { return expression(index) && !(expressions[index].flags & readsVariables); };
+    for (uint32_t i = 0; i < header->nameCount; ++i) {
+        if ((uint64_t) names[i].offset + names[i].length > header->nameBytes) return false;
+    }
+    for (uint32_t i = 0; i < header->expressionCount; ++i) {
+        const Expression &record = expressions[i];
+        if (record.opCount == 0 || (uint64_t) record.firstOp + record.opCount > header->opCount) return false;
+        int depth = 0;
+        uint32_t flags = 0;
+        for (const Op *op = ops + record.firstOp; op < ops + record.firstOp + record.opCount; ++op) {
+            if (op->code >= (uint32_t) Code::Count || depth < needed((Code) op->code)) return false;
+            if (op->code == (uint32_t) Code::Index && op->operand >= maxDepth) return false;
+            if (op->code == (uint32_t) Code::Variable && op->operand >= header->nameCount) return false;
+            flags |= op->code == (uint32_t) Code::Index ? readsIndices : op->code == (uint32_t) Code::Variable ? readsVariables : 0;
+            depth += change((Code) op->code);
+            if (depth > maxStack) return false;
+        }
+        // the checks below go by the flags
+        if (depth != 1 || record.flags != flags) return false;
+    }
+    for (uint32_t i = 0; i < header->argumentCount; ++i) {
+        if (!expression(arguments[i])) return false;
+    }
+    for (uint32_t i = 0; i < header->propertyCount; ++i) {
+        const Property &property = properties[i];
+        const uint32_t *operands = property.operands;
+        switch ((PropertyKind) property.kind) {
+            case PropertyKind::Translate: case PropertyKind::Rotate: case PropertyKind::Scale:
+                if (!std::all_of(operands, operands + 3, expression) || !unused(operands[3])) return false;
+                break;
+            case PropertyKind::Material:
+                if (operands[0] >= header->materialCount || !std::all_of(operands + 1, operands + 4, unused)) return false;
+                break;
+            case PropertyKind::Color:
+                if (!std::all_of(operands, operands + 4, fixed)) return false;
+                break;
+            case PropertyKind::Texture:
+                if (operands[0] >= header->nameCount || !std::all_of(operands + 1, operands + 4, unused)) return false;
+                break;
+            case PropertyKind::Mesh:
+                if (!fixed(operands[0]) || !optional(operands[1]) || !unused(operands[2]) || !unused(operands[3])) return false;
+                break;
+            case PropertyKind::Click:
+                if (operands[0] >= header->nameCount || !expression(operands[1]) || !expression(operands[2]) || operands[3] >= (uint32_t) easeCount) return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->nodeCount; ++i) {
+        const Node &node = nodes[i];
+        if (node.kind >= (uint32_t) NodeKind::Count || !validArguments((NodeKind) node.kind, node.argumentCount)) return false;
+        if ((uint64_t) node.firstArgument + node.argumentCount > header->argumentCount || (uint64_t) node.firstProperty + node.propertyCount > header->propertyCount) return false;
+        if (node.size == 0 || (uint64_t) i + node.size > header->nodeCount) return false;
+        if (node.kind < (uint32_t) NodeKind::Group && node.childCount != 0 || node.kind == (uint32_t) NodeKind::Clone && node.childCount != 1) return false;
+        // shape parameters and clone counts are evaluated once, and only shapes have textures and meshes
+        if (!std::all_of(arguments + node.firstArgument, arguments + node.firstArgument + node.argumentCount, fixed)) return false;
+        bool simple = node.kind < (uint32_t) NodeKind::Group;
+        for (const Property *property = properties + node.firstProperty; property < properties + node.firstProperty + node.propertyCount; ++property) {
+            if (!simple && (property->kind == (uint32_t) PropertyKind::Texture || property->kind == (uint32_t) PropertyKind::Mesh)) return false;
+        }
+        // children follow their parent and fill its subtree exactly
+        uint64_t child = i + 1;
+        for (uint32_t j = 0; j < node.childCount; ++j) {
+            if (child >= (uint64_t) i + node.size) return false;
+            child += nodes[child].size;
+        }
+        if (child != (uint64_t) i + node.size) return false;
+    }
+    for (uint32_t i = 0; i < header->materialCount; ++i) {
+        if (materials[i].name >= header->nameCount) return false;
+    }
+    for (uint32_t i = 0; i < header->lightCount; ++i) {
+        const uint32_t *slots = lights[i].expressions;
+        if (lights[i].kind >= (uint32_t) LightKind::Count || !std::all_of(slots, slots + 24, optional)) return false;
+        if (std::any_of(slots, slots + 24, [&](uint32_t index) { return index != none && expressions[index].flags & readsIndices; })) return false;
+        // the slots each kind of light reads, a color's or the attenuation's given whole or not at all
+        auto given = [&](int first, int count) { return std::all_of(slots + first, slots + first + count, expression); };
+        auto omitted = [&](int first, int count) { return std::all_of(slots + first, slots + first + count, unused); };
+        LightKind kind = (LightKind) lights[i].kind;
+        if (kind == LightKind::Ambient) {
+            if (!given(0, 4) || !omitted(4, 20)) return false;
+            continue;
+        }
+        if (!given(0, 4) && !omitted(0, 4) || !given(4, 11)) return false;
+        if (kind == LightKind::Spot ? !given(15, 5) : !omitted(15, 5)) return false;
+        if (kind == LightKind::Directional ? !omitted(20, 3) : !given(20, 3) && !omitted(20, 3)) return false;
+    }
+    for (uint32_t i = 0; i < header->animationCount; ++i) {
+        const AnimationRecord &animation = animationRecords[i];
+        if (animation.name >= header->nameCount || (uint64_t) animation.firstTrack + animation.trackCount > header->trackCount) return false;
+    }
+    for (uint32_t i = 0; i < header->trackCount; ++i) {
+        if (tracks[i].target >= header->nameCount || tracks[i].easing < 0 || tracks[i].easing >= easeCount) return false;
+    }
+    for (uint32_t i = 0; i < header->rootCount; ++i) {
+        if (roots[i].name >= header->nameCount || roots[i].node >= header->nodeCount) return false;
+    }
+    return true;
+}
+
+bool SceneFile::save(std::string path) const {
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.get(), size);
+    return file.good();
+}
+
+bool SceneFile::load(std::string path) {
+    // little endian and packed the same on every platform the scene runs on, so the mapping is used as is
+    size_t size = 0;
+    std::shared_ptr<const char> data = Files::map(path, size);
+    if (!data) return false;
+    return attach(data, size);
+}
+
+size_t SceneFile::getSize() const { return size; }
+
+std::vector<std::string> SceneFile::getTextureNames() const {
+    std::vector<std::string> textures;
+    if (!header) return textures;
+    for (const Property *property = properties; property < properties + header->propertyCount; ++property) {
+        if (property->kind != (uint32_t) PropertyKind::Texture) continue;
+        std::string name = getName(property->operands[0]);
+        if (std::find(textures.begin(), textures.end(), name) == textures.end()) textures.push_back(name);
+    }
+    return textures;
+}
+
+std::string SceneFile::getName(uint32_t name) const { return std::string(nameData + names[name].offset, names[name].length); }
+
+GLfloat SceneFile::run(const Op *ops, uint32_t count, const GLfloat *indices, int indexCount, const std::function<GLfloat()> *variables) {
+    GLfloat stack[maxStack];
+    int top = 0;
+    for (const Op *op = ops; op < ops + count; ++op) {
+        GLfloat *operands = stack + top - needed((Code) op->code);
+        switch ((Code) op->code) {
+            case Code::Constant: stack[top] = bitsToFloat(op->operand); break;
+            case Code::Index: stack[top] = (int) op->operand < indexCount ? indices[indexCount - 1 - op->operand] : 0; break;
+            case Code::Variable: stack[top] = variables && variables[op->operand] ? variables[op->operand]() : 0; break;
+            case Code::Negate: operands[0] = -operands[0]; break;
+            case Code::Add: operands[0] += operands[1]; break;
+            case Code::Subtract: operands[0] -= operands[1]; break;
+            case Code::Multiply: operands[0] *= operands[1]; break;
+            case Code::Divide: operands[0] /= operands[1]; break;
+            case Code::Less: operands[0] = operands[0] < operands[1]; break;
+            case Code::LessEqual: operands[0] = operands[0] <= operands[1]; break;
+            case Code::Greater: operands[0] = operands[0] > operands[1]; break;
+            case Code::GreaterEqual: operands[0] = operands[0] >= operands[1]; break;
+            case Code::Equal: operands[0] = operands[0] == operands[1]; break;
+            case Code::NotEqual: operands[0] = operands[0] != operands[1]; break;
+            case Code::Select: operands[0] = operands[0] != 0 ? operands[1] : operands[2]; break;
+            case Code::Sin: operands[0] = std::sin(operands[0]); break;
+            case Code::Cos: operands[0] = std::cos(operands[0]); break;
+            case Code::Sqrt: operands[0] = std::sqrt(operands[0]); break;
+            case Code::Abs: operands[0] = std::abs(operands[0]); break;
+            case Code::Min: operands[0] = std::min(operands[0], operands[1]); break;
+            case Code::Max: operands[0] = std::max(operands[0], operands[1]); break;
+            default: break;
+        }
+        top += change((Code) op->code);
+    }
+    return stack[0];
+}
+
+GLfloat SceneFile::evaluate(uint32_t expression, const GLfloat *indices, int indexCount, const std::vector<std::function<GLfloat()>> &variables) const {
+    return run(ops + expressions[expression].firstOp, expressions[expression].opCount, indices, indexCount, variables.data());
+}
+
+std::shared_ptr<std::vector<std::function<GLfloat()>>> SceneFile::resolve(const SceneContext &context) const {
+    // variables by name, for the names expressions read
+    auto variables = std::make_shared<std::vector<std::function<GLfloat()>>>(header->nameCount);
+    bool resolved = true;
+    for (uint32_t i = 0; i < header->opCount; ++i) {
+        if (ops[i].code != (uint32_t) Code::Variable || (*variables)[ops[i].operand]) continue;
+        std::string name = getName(ops[i].operand);
+        auto variable = context.variables.find(name);
+        if (variable == context.variables.end()) {
+            std::cerr << "scene reads unknown variable " << name << std::endl;
+            resolved = false;
+        } else {
+            (*variables)[ops[i].operand] = variable->second;
+        }
+    }
+    return resolved ? variables : nullptr;
+}
+
+Shape *SceneFile::createNode(uint32_t index, std::vector<GLfloat> &indices, const SceneContext &context, std::shared_ptr<std::vector<std::function<GLfloat()>>> variables) const {
+    const Node &node = nodes[index];
+    auto value = [&](uint32_t expression) { return evaluate(expression, indices.data(), indices.size(), *variables); };
+    auto argument = [&](int i) { return value(arguments[node.firstArgument + i]); };
+    auto integer = [&](int i) { return (int) std::lround(argument(i)); };
+    bool full = node.argumentCount > 4 || node.kind == (uint32_t) NodeKind::Prism && node.argumentCount > 3;
+
+    Shape *shape = nullptr;
+    switch ((NodeKind) node.kind) {
+        case NodeKind::Cuboid:
+            shape = new Cuboid(argument(0), argument(1), argument(2));
+            break;
+        case NodeKind::Prism:
+            shape = full ? new PrismWall(argument(0), argument(1), integer(2), argument(3), integer(4)) : new PrismWall(argument(0), argument(1), integer(2));
+            break;
+        case NodeKind::Sphere:
+            shape = full ? new Sphere(argument(0), integer(1), argument(2), integer(3), argument(4), integer(5)) : new Sphere(argument(0), integer(1));
+            break;
+        case NodeKind::Donut:
+            shape = full ? new Donut(argument(0), argument(1), integer(2), argument(3), integer(4), integer(5), argument(6), integer(7)) : new Donut(argument(0), argument(1), integer(2), integer(3));
+            break;
+        case NodeKind::Ring:
+            shape = full ? new Ring(argument(0), argument(1), argument(2), integer(3), argument(4), integer(5)) : new Ring(argument(0), argument(1), argument(2), integer(3));
+            break;
+        case NodeKind::Group: {
+            std::vector<Shape *> children;
+            for (uint32_t child = index + 1; child < index + node.size; child += nodes[child].size) children.push_back(createNode(child, indices, context, variables));
+            shape = new CompoundShape(children);
+            break;
+        }
+        case NodeKind::Clone: {
+            std::vector<Shape *> clones;
+            for (int i = 0, count = integer(0); i < count; ++i) {
+                indices.push_back(i);
+                clones.push_back(createNode(index + 1, indices, context, variables));
+                indices.pop_back();
+            }
+            shape = new CompoundShape(clones);
+            break;
+        }
+        default:
+            break;
+    }
+
+    for (const Property *property = properties + node.firstProperty; property < properties + node.firstProperty + node.propertyCount; ++property) {
+        const uint32_t *operands = property->operands;
+        bool dynamic = false;
+        for (int i = 0; i < 4; ++i) dynamic = dynamic || operands[i] != none && property->kind != (uint32_t) PropertyKind::Material && property->kind != (uint32_t) PropertyKind::Texture &&
+                                                        property->kind != (uint32_t) PropertyKind::Click && (expressions[operands[i]].flags & readsVariables);
+        switch ((PropertyKind) property->kind) {
+            case PropertyKind::Translate: case PropertyKind::Rotate: case PropertyKind::Scale: {
+                PropertyKind kind = (PropertyKind) property->kind;
+                auto apply = [&](auto parameters) {
+                    if (kind == PropertyKind::Translate) {
+                        shape->translate(parameters);
+                    } else if (kind == PropertyKind::Rotate) {
+                        shape->rotate(parameters);
+                    } else {
+                        shape->scale(parameters);
+                    }
+                };
+                if (dynamic) {
+                    // keeps the scene mapped and the clone indices it was made at
+                    apply(std::function<void(Coordinates3D &)>([scene = *this, operands, indices = indices, variables](Coordinates3D &parameters) {
+                        for (int i = 0; i < 3; ++i) parameters.array[i] = scene.evaluate(operands[i], indices.data(), indices.size(), *variables);
+                    }));
+                } else {
+                    apply(Coordinates3D{value(operands[0]), value(operands[1]), value(operands[2])});
+                }
+                break;
+            }
+            case PropertyKind::Material: {
+                const Material &material = materials[operands[0]];
+                auto color = [](const float *channels) { return ColorRGBA{channels[0], channels[1], channels[2], channels[3]}; };
+                shape->setMaterial(color(material.ambient), color(material.diffuse), color(material.specular), material.shininess);
+                break;
+            }
+            case PropertyKind::Color:
+                shape->setColor({value(operands[0]), value(operands[1]), value(operands[2]), value(operands[3])});
+                break;
+            case PropertyKind::Texture:
+                ((SimpleShape *) shape)->setTexture(context.textures.at(getName(operands[0])));
+                break;
+            case PropertyKind::Mesh:
+                ((SimpleShape *) shape)->setMeshLevel(std::lround(value(operands[0])));
+                if (dynamic) {
+                    ((SimpleShape *) shape)->setMeshEnabled([scene = *this, enabled = operands[1], indices = indices, variables] { return scene.evaluate(enabled, indices.data(), indices.size(), *variables) != 0; });
+                } else if (operands[1] != none) {
+                    ((SimpleShape *) shape)->setMeshEnabled(value(operands[1]) != 0);
+                }
+                break;
+            case PropertyKind::Click: {
+                const Binding &binding = *std::find_if(context.bindings.begin(), context.bindings.end(), [&](const Binding &binding) { return binding.name == getName(operands[0]); });
+                std::function<GLfloat()> current = context.variables.at(binding.name);
+                shape->setOnClick([scene = *this, operands, indices = indices, variables, binding, current, scheduler = context.scheduler] {
+                    GLfloat duration = scene.evaluate(operands[1], indices.data(), indices.size(), *variables), to = scene.evaluate(operands[2], indices.data(), indices.size(), *variables);
+                    GLfloat (*ease)(GLfloat) = Ease::byIndex(operands[3]);
+                    if (binding.value) {
+                        scheduler->start(animate(tween(std::max(duration, 0.f), current(), to, ease, binding.value)));
+                    } else {
+                        scheduler->start(animate(tween(std::max(duration, 0.f), current(), to, ease, binding.setter)));
+                    }
+                });
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return shape;
+}
+
+Shape *SceneFile::createShape(std::string root, const SceneContext &context) const {
+    if (!header) return nullptr;
+    const Root *found = std::find_if(roots, roots + header->rootCount, [&](const Root &record) { return getName(record.name) == root; });
+    if (found == roots + header->rootCount) return nullptr;
+    auto variables = resolve(context);
+    if (!variables) return nullptr;
+
+    // everything below the root has to be in the context before anything is made
+    bool complete = true;
+    const Node &node = nodes[found->node];
+    for (const Node *below = &node; below < &node + node.size; ++below) {
+        for (const Property *property = properties + below->firstProperty; property < properties + below->firstProperty + below->propertyCount; ++property) {
+            std::string name = property->kind == (uint32_t) PropertyKind::Texture || property->kind == (uint32_t) PropertyKind::Click ? getName(property->operands[0]) : "";
+            bool missing = property->kind == (uint32_t) PropertyKind::Texture && !context.textures.count(name) ||
+                           property->kind == (uint32_t) PropertyKind::Click && (!context.scheduler || !context.variables.count(name) ||
+                                                                                std::none_of(context.bindings.begin(), context.bindings.end(), [&](const Binding &binding) { return binding.name == name; }));
+            if (missing) std::cerr << "scene uses unknown " << (property->kind == (uint32_t) PropertyKind::Texture ? "texture " : "click target ") << name << std::endl;
+            complete = complete && !missing;
+        }
+    }
+    if (!complete) return nullptr;
+    std::vector<GLfloat> indices;
+    return createNode(found->node, indices, context, variables);
+}
+
+void SceneFile::createLights(const SceneContext &context, std::vector<std::unique_ptr<Light>> &lights) const {
+    if (!header) return;
+    auto variables = resolve(context);
+    if (!variables) return;
+    for (const LightRecord *light = this->lights; light < this->lights + header->lightCount; ++light) {
+        const uint32_t *expressions = light->expressions;
+        auto dynamic = [&](const uint32_t *first, int count) { return std::any_of(first, first + count, [&](uint32_t expression) { return expression != none && this->expressions[expression].flags & readsVariables; }); };
+        auto value = [&](uint32_t expression) { return evaluate(expression, nullptr, 0, *variables); };
+        auto color = [&](const uint32_t *channels) -> DynamicValue<ColorRGBA> {
+            if (channels[0] == none) return ColorRGBA{0, 0, 0, 1};
+            if (!dynamic(channels, 4)) return ColorRGBA{value(channels[0]), value(channels[1]), value(channels[2]), value(channels[3])};
+            return [scene = *this, channels, variables] { return ColorRGBA{scene.evaluate(channels[0], nullptr, 0, *variables), scene.evaluate(channels[1], nullptr, 0, *variables), scene.evaluate(channels[2], nullptr, 0, *variables), scene.evaluate(channels[3], nullptr, 0, *variables)}; };
+        };
+        auto vector = [&](const uint32_t *axes) -> DynamicValue<Coordinates3D> {
+            if (!dynamic(axes, 3)) return Coordinates3D{value(axes[0]), value(axes[1]), value(axes[2])};
+            return [scene = *this, axes, variables] { return Coordinates3D{scene.evaluate(axes[0], nullptr, 0, *variables), scene.evaluate(axes[1], nullptr, 0, *variables), scene.evaluate(axes[2], nullptr, 0, *variables)}; };
+        };
+        DynamicValue<bool> on = true;
+        if (expressions[23] != none) {
+            if (dynamic(expressions + 23, 1)) {
+                on = [scene = *this, expression = expressions[23], variables] { return scene.evaluate(expression, nullptr, 0, *variables) != 0; };
+            } else {
+                on = value(expressions[23]) != 0;
+            }
+        }
+        QuadraticAttenuation attenuation = expressions[20] == none ? QuadraticAttenuation(1, 0, 0) : QuadraticAttenuation(value(expressions[20]), value(expressions[21]), value(expressions[22]));
+
+        switch ((LightKind) light->kind) {
+            case LightKind::Ambient: {
+                // the light model's, set once
+                GLfloat ambient[] = {value(expressions[0]), value(expressions[1]), value(expressions[2]), value(expressions[3])};
+                glLightModelfv(GL_LIGHT_MODEL_AMBIENT, ambient);
+                break;
+            }
+            case LightKind::Directional:
+                lights.emplace_back(new DirectionalLight(color(expressions), color(expressions + 4), color(expressions + 8), vector(expressions + 12), on));
+                break;
+            case LightKind::Point:
+                lights.emplace_back(new PointLight(color(expressions), color(expressions + 4), color(expressions + 8), vector(expressions + 12), attenuation, on));
+                break;
+            case LightKind::Spot:
+                lights.emplace_back(new SpotLight(color(expressions), color(expressions + 4), color(expressions + 8), vector(expressions + 12), vector(expressions + 15), value(expressions[18]), value(expressions[19]), attenuation, on));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::vector<AnimationGroup> SceneFile::createAnimations(const SceneContext &context) const {
+    std::vector<AnimationGroup> groups;
+    if (!header) return groups;
+    for (const AnimationRecord *animation = animationRecords; animation < animationRecords + header->animationCount; ++animation) {
+        std::vector<Animation> group;
+        for (const Track *track = tracks + animation->firstTrack; track < tracks + animation->firstTrack + animation->trackCount; ++track) {
+            std::string target = getName(track->target);
+            auto binding = std::find_if(context.bindings.begin(), context.bindings.end(), [&](const Binding &binding) { return binding.name == target; });
+            if (binding == context.bindings.end()) {
+                std::cerr << "scene animates unknown value " << target << std::endl;
+                continue;
+            }
+            GLfloat (*ease)(GLfloat) = Ease::byIndex(track->easing);
+            if (binding->value) {
+                group.emplace_back(track->start, track->duration, track->first, track->last, ease, binding->value);
+            } else {
+                group.emplace_back(track->start, track->duration, track->first, track->last, ease, binding->setter);
+            }
+            group.back().setBinding(binding - context.bindings.begin());
+        }
+        groups.emplace_back(group);
+    }
+    return groups;
+}
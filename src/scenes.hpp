@@ -0,0 +1,136 @@
+#ifndef SCENES_HPP
+#define SCENES_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "animations.hpp"
+#include "clips.hpp"
+#include "lights.hpp"
+#include "resources.hpp"
+#include "shapes.hpp"
+
+class Scheduler;
+
+// what a scene is instantiated against: the values it animates, the ones its expressions read, its textures, and
+// the scheduler clicks start their tweens on
+struct SceneContext {
+    std::vector<Binding> bindings;
+    std::map<std::string, std::function<GLfloat()>> variables;
+    std::map<std::string, TextureHandle> textures;
+    Scheduler *scheduler = nullptr;
+};
+
+// a scene compiled from its text form, kept in the same layout in memory and on disk so a saved one is used straight
+// from a mapping of its file; loading only validates the records in place, shapes, lights and animations are made
+// when asked for
+//
+// the text form is a list of statements, each ending with a semicolon, with # starting a comment:
+//   color NAME r g b a
+//   material NAME ambient COLOR diffuse COLOR specular COLOR shininess s
+//   light ambient COLOR
+//   light directional [ambient COLOR] diffuse COLOR specular COLOR direction x y z [on e]
+//   light point [ambient COLOR] diffuse COLOR specular COLOR position x y z [attenuation c l q] [on e]
+//   light spot [ambient COLOR] diffuse COLOR specular COLOR position x y z direction x y z cutoff c exponent e [attenuation c l q] [on e]
+//   define NAME NODE
+//   root NAME NODE
+//   animation NAME { TARGET start duration first last EASE; | TARGET start duration value; ... }
+// where COLOR is a color name or r g b a, EASE the name of one of the Ease functions, and a node is one of
+//   cuboid(width, height, length)  prism(radius, height, sides[, offset, span])
+//   sphere(radius, detail[, offsetX, spanX, offsetY, spanY])  donut(inner, outer, detailXY[, offsetXY, spanXY], detailZ[, offsetZ, spanZ])
+//   ring(inner, outer, height, detail[, offset, span])  group { NODE ... }  clone INDEX count { NODE }  use NAME
+// followed by any of
+//   translate x y z  rotate x y z  scale x y z  material NAME  color COLOR  texture NAME  mesh level [enabled]
+//   click tween TARGET duration to EASE
+// numbers in statements are single terms: a number, a name, a call like sin(x) or an expression in parentheses, with
+// + - * / < <= > >= == != ?: and pi, sin, cos, sqrt, abs, min and max; names are clone indices or context variables,
+// and transformations, mesh switches and click targets that read variables follow them on every frame
+class SceneFile {
+    private:
+    struct Header {
+        char magic[4];
+        uint32_t version, nameCount, nameBytes, opCount, expressionCount, argumentCount, propertyCount, nodeCount, materialCount, lightCount, animationCount, trackCount, rootCount;
+    };
+    struct Name {
+        uint32_t offset, length;
+    };
+    struct Op {
+        uint32_t code, operand;  // a constant's bits, a clone index depth or a variable's name
+    };
+    struct Expression {
+        uint32_t firstOp, opCount, flags;
+    };
+    struct Property {
+        uint32_t kind, operands[4];
+    };
+    struct Node {
+        uint32_t kind, firstArgument, argumentCount, firstProperty, propertyCount, childCount, size;
+    };
+    struct Material {
+        uint32_t name;
+        float ambient[4], diffuse[4], specular[4], shininess;
+    };
+    struct LightRecord {
+        uint32_t kind, expressions[24];  // ambient, diffuse, specular, position or direction, spot direction, cutoff, exponent, attenuation, on
+    };
+    struct AnimationRecord {
+        uint32_t name, firstTrack, trackCount;
+    };
+    struct Track {
+        uint32_t target, start, duration;
+        float first, last;
+        int32_t easing;
+    };
+    struct Root {
+        uint32_t name, node;
+    };
+    class Compiler;
+    static const uint32_t version = 1;
+    std::shared_ptr<const char> data;
+    size_t size;
+    const Header *header;
+    const Name *names;
+    const Op *ops;
+    const Expression *expressions;
+    const uint32_t *arguments;
+    const Property *properties;
+    const Node *nodes;
+    const Material *materials;
+    const LightRecord *lights;
+    const AnimationRecord *animationRecords;
+    const Track *tracks;
+    const Root *roots;
+    const char *nameData;
+    bool attach(std::shared_ptr<const char> data, size_t size);
+    bool validate() const;
+    std::string getName(uint32_t name) const;
+    static GLfloat run(const Op *ops, uint32_t count, const GLfloat *indices, int indexCount, const std::function<GLfloat()> *variables);
+    GLfloat evaluate(uint32_t expression, const GLfloat *indices, int indexCount, const std::vector<std::function<GLfloat()>> &variables) const;
+    std::shared_ptr<std::vector<std::function<GLfloat()>>> resolve(const SceneContext &context) const;
+    Shape *createNode(uint32_t node, std::vector<GLfloat> &indices, const SceneContext &context, std::shared_ptr<std::vector<std::function<GLfloat()>>> variables) const;
+
+    public:
+    SceneFile();
+    // reports the first error with its line to std::cerr
+    bool compile(std::string text);
+    bool save(std::string path) const;
+    // maps a compiled scene
+    bool load(std::string path);
+    size_t getSize() const;
+    // every texture shapes refer to, for the context to have before they are made
+    std::vector<std::string> getTextureNames() const;
+    // nullptr when there is no such root or something it uses is missing from the context
+    Shape *createShape(std::string root, const SceneContext &context) const;
+    void createLights(const SceneContext &context, std::vector<std::unique_ptr<Light>> &lights) const;
+    std::vector<AnimationGroup> createAnimations(const SceneContext &context) const;
+};
+
+#endif
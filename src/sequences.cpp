@@ -0,0 +1,191 @@
+#include "sequences.hpp"
+
+#include <assert.h>
+
+#include <algorithm>
+
+// class Sequence
+
+Sequence::Sequence(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+Sequence::Sequence(Sequence &&other) : handle(other.handle) { other.handle = nullptr; }
+
+Sequence &Sequence::operator=(Sequence &&other) {
+    if (this != &other) {
+        if (handle) handle.destroy();
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+Sequence::~Sequence() {
+    if (handle) handle.destroy();
+}
+
+bool Sequence::isDone() const { return !handle || handle.done(); }
+
+// class Scheduler
+
+Scheduler::Scheduler() : time(0), timers(0) {}
+
+Scheduler::~Scheduler() { clear(); }
+
+unsigned long Scheduler::getTime() { return time; }
+
+void Scheduler::start(Sequence sequence) {
+    if (sequence.isDone()) return;
+    sequence.handle.promise().scheduler = this;
+    sequence.handle.resume();
+    if (!sequence.isDone()) sequences.push_back(std::move(sequence));
+}
+
+void Scheduler::clear() {
+    for (auto &level : wheel) {
+        for (auto &slot : level) slot.clear();
+    }
+    timers = 0;
+    tweens.clear();
+    // destroying a sequence destroys the ones it awaits too
+    sequences.clear();
+}
+
+void Scheduler::insert(Timer timer) {
+    unsigned long delta = timer.wake - time;
+    int level = 0;
+    while (level < levels - 1 && delta >= 1ul << bits * (level + 1)) ++level;
+    // beyond the last level the timer is filed at the furthest slot and filed again when that slot cascades
+    unsigned long wake = std::min(timer.wake, time + (1ul << bits * levels) - 1);
+    wheel[level][wake >> bits * level & (slots - 1)].push_back(timer);
+}
+
+void Scheduler::cascade(int level) {
+    std::vector<Timer> due;
+    due.swap(wheel[level][time >> bits * level & (slots - 1)]);
+    for (auto &timer : due) insert(timer);
+}
+
+void Scheduler::schedule(std::coroutine_handle<> handle, unsigned long wake) {
+    assert(wake > time);
+    insert({wake, handle});
+    ++timers;
+}
+
+void Scheduler::write(const Running &tween, GLfloat value) {
+    if (tween.target) {
+        *tween.target = value;
+    } else {
+        tween.callback(value);
+    }
+}
+
+void Scheduler::tween(unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *target, std::function<void(GLfloat)> callback, int priority) {
+    auto after = std::upper_bound(tweens.begin(), tweens.end(), priority, [](int priority, const Running &tween) { return priority < tween.priority; });
+    auto tween = tweens.insert(after, {time, time + duration, first, last, ease, target, callback, priority});
+    write(*tween, duration ? first : last);
+}
+
+void Scheduler::finishTweens() {
+    // the ones that ended before are done, and the ones ending now go on to the end of the tick
+    tweens.erase(std::remove_if(tweens.begin(), tweens.end(), [this](const Running &tween) { return tween.end < time; }), tweens.end());
+    for (auto &tween : tweens) {
+        if (tween.end == time) write(tween, tween.last);
+    }
+}
+
+void Scheduler::tick(unsigned long delta) {
+    unsigned long end = time + delta;
+    bool resumed = false;
+    while (time < end) {
+        // every tween has a sequence waiting on it, so with no timers there is nothing to do until the end
+        if (timers == 0) {
+            time = end;
+            break;
+        }
+        ++time;
+        for (int level = levels - 1; level > 0; --level) {
+            if ((time & ((1ul << bits * level) - 1)) == 0) cascade(level);
+        }
+        std::vector<Timer> &slot = wheel[0][time & (slots - 1)];
+        if (slot.empty()) continue;
+        // tweens end on the values the sequences waking up now continue from
+        finishTweens();
+        std::vector<Timer> due;
+        due.swap(slot);
+        timers -= due.size();
+        resumed = true;
+        for (auto &timer : due) timer.handle.resume();
+        // and again over what the sequences wrote as they started, for the ones ending now to win by priority, unless
+        // the writes at the end of the tick do it
+        if (time < end) finishTweens();
+    }
+
+    tweens.erase(std::remove_if(tweens.begin(), tweens.end(), [this](const Running &tween) { return tween.end < time; }), tweens.end());
+    for (auto &tween : tweens) {
+        if (tween.end == time) {
+            write(tween, tween.last);
+            continue;
+        }
+        GLfloat progress = (GLfloat) (time - tween.start) / (tween.end - tween.start);
+        write(tween, tween.first + tween.ease(progress) * (tween.last - tween.first));
+    }
+    // sequences only finish when resumed
+    if (resumed) sequences.erase(std::remove_if(sequences.begin(), sequences.end(), [](const Sequence &sequence) { return sequence.isDone(); }), sequences.end());
+}
+
+// awaitables
+
+void Delay::await_suspend(std::coroutine_handle<Sequence::promise_type> handle) {
+    Scheduler *scheduler = handle.promise().scheduler;
+    scheduler->schedule(handle, scheduler->getTime() + duration);
+}
+
+bool Tween::await_suspend(std::coroutine_handle<Sequence::promise_type> handle) {
+    Scheduler *scheduler = handle.promise().scheduler;
+    scheduler->tween(duration, first, last, ease, target, callback, priority);
+    if (duration == 0) return false;
+    scheduler->schedule(handle, scheduler->getTime() + duration);
+    return true;
+}
+
+std::coroutine_handle<> All::await_suspend(std::coroutine_handle<Sequence::promise_type> handle) {
+    // one more than there are sequences, so none that finishes while they are being started resumes the awaiting one early
+    remaining = std::make_shared<int>(sequences.size() + 1);
+    for (auto &sequence : sequences) {
+        Sequence::promise_type &promise = sequence.handle.promise();
+        promise.scheduler = handle.promise().scheduler;
+        promise.continuation = handle;
+        promise.remaining = remaining;
+        sequence.handle.resume();
+    }
+    return --*remaining == 0 ? (std::coroutine_handle<>) handle : std::noop_coroutine();
+}
+
+Delay delay(unsigned long duration) { return {duration}; }
+
+Tween tween(unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *value) { return {duration, first, last, ease, value, nullptr, 0}; }
+
+Tween tween(unsigned long duration, GLfloat first, GLfloat last, Easing ease, std::function<void(GLfloat)> callback) { return {duration, first, last, ease, nullptr, callback, 0}; }
+
+All all(std::vector<Sequence> sequences) { return {std::move(sequences), nullptr}; }
+
+Sequence animate(Tween tween) { co_await tween; }
+
+namespace {
+    Sequence track(unsigned long start, Tween tween) {
+        co_await delay(start);
+        co_await tween;
+    }
+
+    Sequence together(std::vector<Sequence> sequences) { co_await all(std::move(sequences)); }
+}
+
+Sequence play(const AnimationGroup &group) {
+    std::vector<Sequence> tracks;
+    for (size_t i = 0; i < group.starts.size(); ++i) {
+        GLfloat *target = group.targets[i];
+        std::function<void(GLfloat)> callback = target ? nullptr : group.functions[group.callbacks[i]];
+        tracks.push_back(track(group.starts[i], {group.ends[i] - group.starts[i], group.firsts[i], group.lasts[i], group.eases[group.easings[i]], target, callback, group.orders[i]}));
+    }
+    return together(std::move(tracks));
+}
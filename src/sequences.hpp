@@ -0,0 +1,164 @@
+#ifndef SEQUENCES_HPP
+#define SEQUENCES_HPP
+
+#include <GL/freeglut.h>
+
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "animations.hpp"
+
+class Scheduler;
+
+// a coroutine that animates, waiting on tweens, delays and other sequences with co_await; it does nothing until it is
+// either started on a scheduler or awaited by another sequence, and is destroyed with the object that owns it
+class Sequence {
+    public:
+    struct promise_type {
+        Scheduler *scheduler = nullptr;
+        std::coroutine_handle<> continuation;  // resumed when the sequence finishes
+        std::shared_ptr<int> remaining;        // set when finishing is one of several a continuation waits for
+
+        Sequence get_return_object() { return Sequence(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct Finish {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    promise_type &promise = handle.promise();
+                    if (promise.remaining && --*promise.remaining > 0) return std::noop_coroutine();
+                    return promise.continuation ? promise.continuation : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return Finish{};
+        }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    private:
+    std::coroutine_handle<promise_type> handle;
+    explicit Sequence(std::coroutine_handle<promise_type> handle);
+    friend class Scheduler;
+    friend struct All;
+
+    public:
+    Sequence(Sequence &&other);
+    Sequence &operator=(Sequence &&other);
+    ~Sequence();
+    bool isDone() const;
+    // runs the sequence in the awaiting one's place, resuming it once done
+    auto operator co_await() && {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+            bool await_ready() { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> awaiting) {
+                handle.promise().scheduler = awaiting.promise().scheduler;
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            void await_resume() {}
+        };
+        return Awaiter{handle};
+    }
+};
+
+// wakes sequences up at the millisecond they wait for, keeping the ones waiting in a hierarchical timer wheel where
+// a tick only visits the slots it passes, so a sequence costs nothing between the moments it is due
+class Scheduler {
+    private:
+    static const int levels = 4, bits = 6, slots = 1 << bits;  // 64 ms per slot of the second level, about 4.6 hours in all
+    struct Timer {
+        unsigned long wake;
+        std::coroutine_handle<> handle;
+    };
+    struct Running {
+        unsigned long start, end;
+        GLfloat first, last;
+        Easing ease;
+        GLfloat *target;
+        std::function<void(GLfloat)> callback;
+        int priority;
+    };
+    std::vector<Timer> wheel[levels][slots];
+    unsigned long time;
+    int timers;
+    // in progress, each ends when the sequence awaiting it wakes up; by priority, and in the order they started within
+    // one, which is the order they write in, so on a value several write to the last of them wins
+    std::vector<Running> tweens;
+    std::vector<Sequence> sequences;
+    void insert(Timer timer);
+    void cascade(int level);
+    void write(const Running &tween, GLfloat value);
+    void finishTweens();
+
+    public:
+    Scheduler();
+    ~Scheduler();
+    unsigned long getTime();
+    // runs a sequence up to its first wait, keeping it until it finishes
+    void start(Sequence sequence);
+    // stops and destroys every sequence, leaving values where they are
+    void clear();
+    // resumes a coroutine once the time reaches wake, which is at least a millisecond away
+    void schedule(std::coroutine_handle<> handle, unsigned long wake);
+    // writes first now and eases towards last on every tick, finishing right before the sequence that waits on it resumes;
+    // on its last millisecond it still writes last after the tweens below its priority, so it wins over them, as an
+    // animation group lets tracks in progress up to their end included win by the order they were declared in
+    void tween(unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *target, std::function<void(GLfloat)> callback, int priority = 0);
+    void tick(unsigned long delta);
+};
+
+// what sequences await
+struct Delay {
+    unsigned long duration;
+    bool await_ready() { return duration == 0; }
+    void await_suspend(std::coroutine_handle<Sequence::promise_type> handle);
+    void await_resume() {}
+};
+
+struct Tween {
+    unsigned long duration;
+    GLfloat first, last;
+    Easing ease;
+    GLfloat *target;
+    std::function<void(GLfloat)> callback;
+    int priority;
+    bool await_ready() { return false; }
+    // one that takes no time still goes through the scheduler, so it writes in order with the others
+    bool await_suspend(std::coroutine_handle<Sequence::promise_type> handle);
+    void await_resume() {}
+};
+
+struct All {
+    std::vector<Sequence> sequences;
+    std::shared_ptr<int> remaining;
+    bool await_ready() { return sequences.empty(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Sequence::promise_type> handle);
+    void await_resume() {}
+};
+
+Delay delay(unsigned long duration);
+Tween tween(unsigned long duration, GLfloat first, GLfloat last, Easing ease, GLfloat *value);
+Tween tween(unsigned long duration, GLfloat first, GLfloat last, Easing ease, std::function<void(GLfloat)> callback);
+// runs sequences side by side, done once all of them are
+All all(std::vector<Sequence> sequences);
+template <class... Sequences>
+    requires(std::is_same_v<std::remove_cvref_t<Sequences>, Sequence> && ...)
+All all(Sequences &&...sequences) {
+    std::vector<Sequence> list;
+    (list.push_back(std::move(sequences)), ...);
+    return all(std::move(list));
+}
+
+// a single tween as a sequence of its own
+Sequence animate(Tween tween);
+// an animation group as a sequence, every track a delay followed by a tween with the priority of its place in the
+// group, so every tick leaves the values where sampling the group at the same time would
+Sequence play(const AnimationGroup &group);
+
+#endif
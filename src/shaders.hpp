@@ -6,6 +6,7 @@
 #include <type_traits>
 
 #include "structures.hpp"
+#include "vertices.hpp"
 
 using UniformType = std::variant<DynamicValue<int>, DynamicValue<float>, DynamicValue<std::vector<int>>>;
 
@@ -13,6 +14,7 @@ class UniformVariable {
     private:
     UniformType value;
     int location;
+    unsigned long uploaded = 0;  // epoch of the last upload
 
     public:
     UniformVariable(DynamicValue<int> value, int location) : value(value), location(location) {}
@@ -20,7 +22,10 @@ class UniformVariable {
     UniformVariable(DynamicValue<std::vector<int>> value, int location) : value(value), location(location) {}
 
     void upload() {
+        // program uniforms keep their values, so only the ones that changed since are sent again
         std::visit([this](auto&& value) {
+            if (!value.changedSince(uploaded)) return;
+            uploaded = Reactive::epoch;
             using T = std::decay_t<decltype(value)>;
             if constexpr (std::is_same_v<T, DynamicValue<int>>) {
                 glUniform1i(location, value());
@@ -39,6 +44,8 @@ class Shader {
     private:
     GLuint vertId, fragId, id;
     std::vector<UniformVariable> uniforms;
+    // the program in use, kept here so draws can tell without asking gl, which would wait on it
+    inline static Shader *bound = nullptr;
 
     void log(std::string name, GLuint id) {
         GLint logLength;
@@ -75,6 +82,13 @@ class Shader {
         id = glCreateProgramObjectARB();
         glAttachShader(id, vertId);
         glAttachShader(id, fragId);
+        // bind compact vertex attributes to the locations used by VertexArray
+        glBindAttribLocation(id, VertexAttribute::octahedralNormal, "octahedralNormal");
+        glBindAttribLocation(id, VertexAttribute::vertexDecode, "vertexDecode");
+        glBindAttribLocation(id, VertexAttribute::normalEncoding, "normalEncoding");
+        glBindAttribLocation(id, VertexAttribute::materialIndex, "materialIndex");
+        glBindAttribLocation(id, VertexAttribute::instanceAnimation, "instanceAnimation");
+        glBindAttribLocation(id, VertexAttribute::instanceMatrix, "instanceMatrix");
         glLinkProgram(id);
         // populate uniforms vector
         for (const auto& [name, variant] : uniforms) {
@@ -91,10 +105,19 @@ class Shader {
 
     void enable() {
         glUseProgramObjectARB(id);
-        for (auto uniform : uniforms) {
+        bound = this;
+        for (auto &uniform : uniforms) {
             uniform.upload();
         }
     }
 
-    static void clear() { glUseProgramObjectARB(0); }
+    GLint getUniformLocation(std::string name) const { return glGetUniformLocation(id, name.c_str()); }
+
+    static void clear() {
+        glUseProgramObjectARB(0);
+        bound = nullptr;
+    }
+
+    // null while the fixed pipeline draws
+    static Shader *getBound() { return bound; }
 };
\ No newline at end of file
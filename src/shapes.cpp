@@ -1,9 +1,12 @@
 #include "shapes.hpp"
 
+#include "picking.hpp"
+#include "queues.hpp"
+
 // class Shape
 
 Shape::Shape()
-    : color(ColorRGBA{1, 1, 1, 1}), ambient(ColorRGBA{1, 1, 1, 1}), diffuse(ColorRGBA{1, 1, 1, 1}), specular(ColorRGBA{1, 1, 1, 1}), shininess((GLfloat) 0) {}
+    : color(ColorRGBA{1, 1, 1, 1}), material(0) {}
 
 CompoundShape *Shape::clone(int times, std::function<Shape *(int, Shape *)> transform) {
     std::vector<Shape *> clones(times);
@@ -18,11 +21,12 @@ Shape *Shape::setColor(ColorRGBA color) {
     return this;
 }
 
-Shape *Shape::setMaterial(DynamicValue<ColorRGBA> ambient, DynamicValue<ColorRGBA> diffuse, DynamicValue<ColorRGBA> specular, DynamicValue<GLfloat> shininess) {
-    this->ambient = ambient;
-    this->diffuse = diffuse;
-    this->specular = specular;
-    this->shininess = shininess;
+Shape *Shape::setMaterial(ColorRGBA ambient, ColorRGBA diffuse, ColorRGBA specular, GLfloat shininess) {
+    return setMaterial(Materials::intern({ambient, diffuse, specular, shininess}));
+}
+
+Shape *Shape::setMaterial(uint32_t material) {
+    this->material = material;
     return this;
 }
 
@@ -56,15 +60,31 @@ Shape *Shape::scale(std::function<void(Coordinates3D &)> getParameters) {
     return this;
 }
 
+Shape *Shape::setOnClick(std::function<void()> onClick) {
+    this->onClick = onClick;
+    return this;
+}
+
+void Shape::click() {
+    if (onClick) onClick();
+}
+
+Matrix4 Shape::updateMatrix() {
+    // compose every transformation on the cpu and hand gl a single matrix
+    Matrix4 matrix = Matrix4::identity();
+    for (auto &transformation : transformations) {
+        transformation->update();
+        matrix = matrix * transformation->getMatrix();
+    }
+    return matrix;
+}
+
 void Shape::render() {
-    glColor4f(color().r, color().g, color().b, color().a);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, ambient().array);
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse().array);
-    glMaterialfv(GL_FRONT, GL_SPECULAR, specular().array);
-    glMaterialf(GL_FRONT, GL_SHININESS, shininess());
+    glColor4fv(color().array);
+    Materials::apply(material, true);
     if (transformations.size() > 0) {
         glPushMatrix();
-        for (auto &transformation : transformations) transformation->execute();
+        glMultMatrixf(updateMatrix().array);
         renderRaw();
         glPopMatrix();
     } else {
@@ -72,8 +92,41 @@ void Shape::render() {
     }
 }
 
+void Shape::pick(Picker &picker) {
+    // clickable shapes hand their id down to everything drawn below them
+    if (onClick) picker.push(this);
+    if (transformations.size() > 0) {
+        glPushMatrix();
+        glMultMatrixf(updateMatrix().array);
+        pickRaw(picker);
+        glPopMatrix();
+    } else {
+        pickRaw(picker);
+    }
+    if (onClick) picker.pop();
+}
+
+void Shape::collect(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain) {
+    chain.insert(chain.end(), transformations.begin(), transformations.end());
+    collectRaw(colliders, chain);
+    chain.resize(chain.size() - transformations.size());
+}
+
+void Shape::queue(DrawQueue &queue, const Matrix4 &matrix) {
+    queueRaw(queue, transformations.size() > 0 ? matrix * updateMatrix() : matrix);
+}
+
+void Shape::queueRaw(DrawQueue &queue, const Matrix4 &matrix) {
+    // the distance along the view direction, which looks down -z
+    GLfloat depth = -matrix.transformPoint(getCenter()).z;
+    queue.push({this, matrix, color(), material, depth});
+}
+
 // class SimpleShape : public Shape
 
+std::ostream *SimpleShape::meshReport = nullptr;
+VertexFormat SimpleShape::defaultVertexFormat;
+
 void SimpleShape::createMesh(int level) {
     std::vector<GLfloat> mesh, textureMesh;
     mesh.resize(meshVertices.size() * 4);
@@ -162,41 +215,71 @@ void SimpleShape::createMesh(int level) {
     if (level > 2) createMesh(level - 1);
 }
 
-void SimpleShape::renderRaw() {
-    if (vertices.size() == 0) {
-        vertices.resize(12 * getQuadCount());
-        normals.resize(12 * getQuadCount());
-        textureVertices.resize(8 * getQuadCount());
-        generate();
+void SimpleShape::build() {
+    if (vertexFormat.normal == NormalFormat::Analytic && !hasAnalyticNormals()) vertexFormat.normal = NormalFormat::Octahedral;
+    vertices.resize(12 * getQuadCount());
+    normals.resize(12 * getQuadCount());
+    textureVertices.resize(8 * getQuadCount());
+    generate();
+    if (meshLevel > 1) {
         meshVertices = vertices;
         meshNormals = normals;
         meshTextureVertices = textureVertices;
-        if (meshLevel > 1) createMesh(meshLevel);
-    };
-
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(3, GL_FLOAT, 0, &(meshEnabled() ? meshVertices : vertices)[0]);
-    glEnableClientState(GL_NORMAL_ARRAY);
-    glNormalPointer(GL_FLOAT, 0, &(meshEnabled() ? meshNormals : normals)[0]);
-    if (texture > 0) {
-        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexCoordPointer(2, GL_FLOAT, 0, &textureVertices[0]);
+        createMesh(meshLevel);
+        std::vector<GLuint> meshIndices = Mesh::optimize(meshVertices, meshNormals, meshTextureVertices, meshReport, getName() + " (mesh level " + std::to_string(meshLevel) + ")");
+        meshVertexArray = VertexArray(vertexFormat, meshVertices, meshNormals, meshTextureVertices, meshIndices);
     }
-
-    glDrawArrays(GL_QUADS, 0, (meshEnabled() ? meshVertices : vertices).size() / 3);
-
-    glDisableClientState(GL_VERTEX_ARRAY);
-    glDisableClientState(GL_NORMAL_ARRAY);
-    if (texture > 0) {
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    std::vector<GLuint> indices = Mesh::optimize(vertices, normals, textureVertices, meshReport, getName());
+    vertexArray = VertexArray(vertexFormat, vertices, normals, textureVertices, indices);
+    // collisions only need the welded positions
+    collisionVertices = vertices;
+    collisionIndices = indices;
+    Vector3 low(INFINITY, INFINITY, INFINITY), high(-INFINITY, -INFINITY, -INFINITY);
+    for (size_t i = 0; i + 2 < collisionVertices.size(); i += 3) {
+        Vector3 vertex(collisionVertices[i], collisionVertices[i + 1], collisionVertices[i + 2]);
+        low = Vector3::min(low, vertex);
+        high = Vector3::max(high, vertex);
+    }
+    if (!collisionVertices.empty()) center = (low + high) * 0.5f;
+    // the interleaved arrays are all that is drawn from now on
+    for (auto *array : {&vertices, &normals, &textureVertices, &meshVertices, &meshNormals, &meshTextureVertices}) {
+        array->clear();
+        array->shrink_to_fit();
     }
+}
+
+void SimpleShape::renderRaw() {
+    if (vertexArray.getCount() == 0) build();
+    const VertexArray &array = meshEnabled() && meshLevel > 1 ? meshVertexArray : vertexArray;
+
+    if (texture) glBindTexture(GL_TEXTURE_2D, Resources::getTexture(texture));
+    array.enable((bool) texture);
+    array.draw();
+    array.disable((bool) texture);
+    if (texture) glBindTexture(GL_TEXTURE_2D, 0);
 };
 
-SimpleShape::SimpleShape() : texture(0), meshLevel(1), meshEnabled(true) {}
+Vector3 SimpleShape::getCenter() {
+    if (vertexArray.getCount() == 0) build();
+    return center;
+}
+
+void SimpleShape::pickRaw(Picker &picker) {
+    if (vertexArray.getCount() == 0) build();
+    const VertexArray &array = meshEnabled() && meshLevel > 1 ? meshVertexArray : vertexArray;
+    array.enable(false);
+    array.draw();
+    array.disable(false);
+}
 
-SimpleShape *SimpleShape::setTexture(GLuint texture) {
+void SimpleShape::collectRaw(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain) {
+    if (vertexArray.getCount() == 0) build();
+    colliders.push_back({chain, &collisionVertices, &collisionIndices});
+}
+
+SimpleShape::SimpleShape() : meshLevel(1), meshEnabled(true), vertexFormat(defaultVertexFormat) {}
+
+SimpleShape *SimpleShape::setTexture(TextureHandle texture) {
     this->texture = texture;
     return this;
 }
@@ -211,6 +294,17 @@ SimpleShape *SimpleShape::setMeshEnabled(DynamicValue<bool> meshEnabled) {
     return this;
 }
 
+void SimpleShape::setMeshReport(std::ostream *meshReport) { SimpleShape::meshReport = meshReport; }
+
+void SimpleShape::setDefaultVertexFormat(VertexFormat vertexFormat) { SimpleShape::defaultVertexFormat = vertexFormat; }
+
+SimpleShape *SimpleShape::setVertexFormat(VertexFormat vertexFormat) {
+    // only shapes whose normal follows from the position can drop the normal stream
+    assert(vertexFormat.normal != NormalFormat::Analytic || hasAnalyticNormals());
+    this->vertexFormat = vertexFormat;
+    return this;
+}
+
 // class Cuboid : public SimpleShape
 
 void Cuboid::generate() {
@@ -368,15 +462,20 @@ Shape *PrismWall::clone() const { return new PrismWall(*this); };
 
 void Sphere::generate() {
     int i, j;
-    double theta, phi, x, y, z, xz, u, v;
+    double x, y, z, xz, u, v;
+    // every ring and meridian angle only needs its sine and cosine once
+    std::vector<GLfloat> thetas(spanY + 1), thetaSines(spanY + 1), thetaCosines(spanY + 1);
+    std::vector<GLfloat> phis(spanX + 1), phiSines(spanX + 1), phiCosines(spanX + 1);
+    for (i = 0; i <= spanY; ++i) thetas[i] = M_PI_2 - M_PI * (i + offsetY) / detail;
+    for (j = 0; j <= spanX; ++j) phis[j] = 2 * M_PI * (j + offsetX) / detail;
+    Maths::sinCos(thetas.data(), thetaSines.data(), thetaCosines.data(), spanY + 1);
+    Maths::sinCos(phis.data(), phiSines.data(), phiCosines.data(), spanX + 1);
     for (i = 0; i <= spanY; ++i) {
-        theta = M_PI_2 - M_PI * (i + offsetY) / detail;
-        xz = radius * cos(theta);
-        y = radius * sin(theta);
+        xz = radius * thetaCosines[i];
+        y = radius * thetaSines[i];
         for (j = 0; j <= spanX; ++j) {
-            phi = 2 * M_PI * (j + offsetX) / detail;
-            x = xz * cos(phi);
-            z = xz * sin(phi);
+            x = xz * phiCosines[j];
+            z = xz * phiSines[j];
             u = (j + 0.) / spanX;
             v = (spanY - i + 0.) / spanY;
             // right down
@@ -427,18 +526,23 @@ Shape *Sphere::clone() const { return new Sphere(*this); };
 
 void Donut::generate() {
     int i, j, direction;
-    double theta, phi, x, y, z, dx, dy, dz, u, v;
+    double x, y, z, dx, dy, dz, u, v;
+    // every ring and tube angle only needs its sine and cosine once
+    std::vector<GLfloat> thetas(spanXY + 1), thetaSines(spanXY + 1), thetaCosines(spanXY + 1);
+    std::vector<GLfloat> phis(spanZ + 1), phiSines(spanZ + 1), phiCosines(spanZ + 1);
+    for (i = 0; i <= spanXY; ++i) thetas[i] = 2 * M_PI * (i + offsetXY) / detailXY;
+    for (j = 0; j <= spanZ; ++j) phis[j] = 2 * M_PI * (j + offsetZ) / detailZ;
+    Maths::sinCos(thetas.data(), thetaSines.data(), thetaCosines.data(), spanXY + 1);
+    Maths::sinCos(phis.data(), phiSines.data(), phiCosines.data(), spanZ + 1);
     for (i = 0; i <= spanXY; ++i) {
-        theta = 2 * M_PI * (i + offsetXY) / detailXY;
         for (j = 0; j <= spanZ; ++j) {
             direction = j + offsetZ <= detailZ / 4 || j + offsetZ >= 3 * detailZ / 4 ? 1 : -1;
-            phi = 2 * M_PI * (j + offsetZ) / detailZ;
-            x = (middleRadius + ringRadius * cos(phi)) * cos(theta);
-            y = (middleRadius + ringRadius * cos(phi)) * sin(theta);
-            z = ringRadius * sin(phi);
-            dx = cos(phi) * cos(theta);
-            dy = cos(phi) * sin(theta);
-            dz = sin(phi);
+            x = (middleRadius + ringRadius * phiCosines[j]) * thetaCosines[i];
+            y = (middleRadius + ringRadius * phiCosines[j]) * thetaSines[i];
+            z = ringRadius * phiSines[j];
+            dx = phiCosines[j] * thetaCosines[i];
+            dy = phiCosines[j] * thetaSines[i];
+            dz = phiSines[j];
             // left down
             if (i < spanXY && j < spanZ) {
                 vertices[i * 12 * spanZ + j * 12] = x;
@@ -591,6 +695,18 @@ void CompoundShape::renderRaw() {
     std::for_each(shapes.begin(), shapes.end(), [](auto &shape) { shape->render(); });
 }
 
+void CompoundShape::queueRaw(DrawQueue &queue, const Matrix4 &matrix) {
+    for (auto &shape : shapes) shape->queue(queue, matrix);
+}
+
+void CompoundShape::pickRaw(Picker &picker) {
+    std::for_each(shapes.begin(), shapes.end(), [&picker](auto &shape) { shape->pick(picker); });
+}
+
+void CompoundShape::collectRaw(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain) {
+    std::for_each(shapes.begin(), shapes.end(), [&](auto &shape) { shape->collect(colliders, chain); });
+}
+
 CompoundShape::CompoundShape(std::initializer_list<Shape *> shapes) : shapes(shapes.begin(), shapes.end()) {}
 
 CompoundShape::CompoundShape(std::vector<Shape *> shapes) : shapes(shapes.begin(), shapes.end()) {}
@@ -3,6 +3,8 @@
 
 #define _USE_MATH_DEFINES
 
+#include <GL/glew.h>
+// glew must be included first
 #include <GL/freeglut.h>
 #include <assert.h>
 
@@ -14,15 +16,22 @@
 #include <type_traits>
 #include <vector>
 
+#include "materials.hpp"
+#include "maths.hpp"
+#include "meshes.hpp"
+#include "resources.hpp"
 #include "structures.hpp"
+#include "vertices.hpp"
 
 struct Transformation {
     Coordinates3D parameters;
     std::function<void(Coordinates3D &)> getParameters;
     Transformation(Coordinates3D parameters) : parameters(parameters), getParameters(NULL) {}
     Transformation(std::function<void(Coordinates3D &)> getParameters) : parameters{0, 0, 0}, getParameters(getParameters) {}
-    
-    virtual void execute() {
+
+    virtual Matrix4 getMatrix() const = 0;
+
+    void update() {
         if (getParameters) getParameters(parameters);
     }
 };
@@ -30,77 +39,122 @@ struct Transformation {
 struct Translation : Transformation {
     Translation(Coordinates3D parameters) : Transformation(parameters) {}
     Translation(std::function<void(Coordinates3D &)> getParameters) : Transformation(getParameters){};
-    
-    void execute() {
-        Transformation::execute();
-        glTranslatef(parameters.x, parameters.y, parameters.z);
-    }
+
+    Matrix4 getMatrix() const { return Matrix4::translation(parameters); }
 };
 
 struct Rotation : Transformation {
     Rotation(Coordinates3D parameters) : Transformation(parameters) {}
     Rotation(std::function<void(Coordinates3D &)> getParameters) : Transformation(getParameters){};
-    
-    void execute() {
-        Transformation::execute();
-        glRotatef(parameters.x, 1, 0, 0);
-        glRotatef(parameters.y, 0, 1, 0);
-        glRotatef(parameters.z, 0, 0, 1);
+
+    // same order as glRotatef around x, then y, then z, skipping the axes left at zero
+    Matrix4 getMatrix() const {
+        Matrix4 matrix = Matrix4::identity();
+        if (parameters.x != 0) matrix = Matrix4::rotation(parameters.x, {1, 0, 0});
+        if (parameters.y != 0) matrix = matrix * Matrix4::rotation(parameters.y, {0, 1, 0});
+        if (parameters.z != 0) matrix = matrix * Matrix4::rotation(parameters.z, {0, 0, 1});
+        return matrix;
     }
 };
 
 struct Scale : Transformation {
     Scale(Coordinates3D parameters) : Transformation(parameters) {}
     Scale(std::function<void(Coordinates3D &)> getParameters) : Transformation(getParameters){};
-    
-    void execute() {
-        Transformation::execute();
-        glScalef(parameters.x, parameters.y, parameters.z);
-    }
+
+    Matrix4 getMatrix() const { return Matrix4::scaling(parameters); }
+};
+
+// a simple shape as seen by collisions, with every transformation from the root down to it
+struct Collider {
+    std::vector<std::shared_ptr<Transformation>> transformations;
+    const std::vector<GLfloat> *vertices;
+    const std::vector<GLuint> *indices;
 };
 
 class CompoundShape;
+class DrawQueue;
+class InstancedShape;
+class Picker;
 
 class Shape {
     private:
-    DynamicValue<ColorRGBA> color, ambient, diffuse, specular;
-    DynamicValue<GLfloat> shininess;
+    DynamicValue<ColorRGBA> color;
+    uint32_t material;  // in the material table
     std::vector<std::shared_ptr<Transformation>> transformations;
+    std::function<void()> onClick;
+    Matrix4 updateMatrix();
     virtual void renderRaw() = 0;
+    // for the depth pre-pass, whose depth-only shader is bound; a shape that binds a shader of its own binds a
+    // depth-only one instead
+    virtual void renderDepthRaw() { renderRaw(); }
+    virtual void pickRaw(Picker &picker) = 0;
+    virtual void collectRaw(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain) = 0;
+    virtual void queueRaw(DrawQueue &queue, const Matrix4 &matrix);
+    // the point its depth is sorted by, in its own coordinates
+    virtual Vector3 getCenter() { return {0, 0, 0}; }
+    friend class DrawQueue;
 
     public:
     Shape();
     virtual Shape *clone() const = 0;
     virtual CompoundShape *clone(int times, std::function<Shape *(int, Shape *)> transform);
     Shape *setColor(ColorRGBA color);
-    Shape *setMaterial(DynamicValue<ColorRGBA> ambient, DynamicValue<ColorRGBA> diffuse, DynamicValue<ColorRGBA> specular, DynamicValue<GLfloat> shininess);
+    // interned, so shapes of the same material share it
+    Shape *setMaterial(ColorRGBA ambient, ColorRGBA diffuse, ColorRGBA specular, GLfloat shininess);
+    // one from the material table, such as one made to change
+    Shape *setMaterial(uint32_t material);
     Shape *translate(Coordinates3D parameters);
     Shape *translate(std::function<void(Coordinates3D &)> getParameters);
     Shape *rotate(Coordinates3D parameters);
     Shape *rotate(std::function<void(Coordinates3D &)> getParameters);
     Shape *scale(Coordinates3D parameters);
     Shape *scale(std::function<void(Coordinates3D &)> getParameters);
+    Shape *setOnClick(std::function<void()> onClick);
+    void click();
     virtual void render();
+    void pick(Picker &picker);
+    void collect(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain);
+    // queues every simple shape below for drawing, placed by the modelview matrix it is drawn with
+    void queue(DrawQueue &queue, const Matrix4 &matrix);
 };
 
 class SimpleShape : public Shape {
     private:
-    GLuint texture;
+    static std::ostream *meshReport;
+    static VertexFormat defaultVertexFormat;
+    TextureHandle texture;
     int meshLevel;
     DynamicValue<bool> meshEnabled;
+    VertexFormat vertexFormat;
+    VertexArray vertexArray, meshVertexArray;
+    std::vector<GLfloat> collisionVertices;
+    std::vector<GLuint> collisionIndices;
+    Vector3 center;  // of the box around its vertices
     virtual void generate() = 0;
     virtual int getQuadCount() const = 0;
+    virtual std::string getName() const = 0;
+    virtual bool hasAnalyticNormals() const { return false; }
     void createMesh(int level);
+    void build();
+    Vector3 getCenter();
+    friend class InstancedShape;
 
     protected:
     std::vector<GLfloat> vertices, normals, textureVertices, meshVertices, meshNormals, meshTextureVertices;
     virtual void renderRaw();
+    void pickRaw(Picker &picker);
+    void collectRaw(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain);
 
     public:
     SimpleShape();
-    SimpleShape *setTexture(GLuint texture);
+    SimpleShape *setTexture(TextureHandle texture);
     SimpleShape *setMeshLevel(int meshLevel);
     SimpleShape *setMeshEnabled(DynamicValue<bool> meshEnabled);
+    SimpleShape *setVertexFormat(VertexFormat vertexFormat);
+    static void setMeshReport(std::ostream *meshReport);
+    // the format of shapes made from now on; analytic normals go to the shapes that have them, the others get
+    // octahedral ones
+    static void setDefaultVertexFormat(VertexFormat vertexFormat);
 };
 
 class Cuboid : public SimpleShape {
@@ -108,6 +162,7 @@ class Cuboid : public SimpleShape {
     GLfloat width, height, length;
 
     int getQuadCount() const { return 6; }
+    std::string getName() const { return "Cuboid"; }
     void generate();
 
     public:
@@ -122,6 +177,7 @@ class PrismWall : public SimpleShape {
     float offset;
 
     int getQuadCount() const { return span; }
+    std::string getName() const { return "PrismWall"; }
     void generate();
 
     public:
@@ -137,6 +193,8 @@ class Sphere : public SimpleShape {
     float offsetX, offsetY;
 
     int getQuadCount() const { return spanY * spanX; }
+    bool hasAnalyticNormals() const { return true; }
+    std::string getName() const { return "Sphere"; }
     void generate();
 
     public:
@@ -153,6 +211,7 @@ class Donut : public SimpleShape {
     float offsetXY, offsetZ;
 
     int getQuadCount() const { return spanXY * spanZ; }
+    std::string getName() const { return "Donut"; }
     void generate();
 
     public:
@@ -168,6 +227,7 @@ class Ring : public SimpleShape {
     float offset;
 
     int getQuadCount() const { return 4 * span; }
+    std::string getName() const { return "Ring"; }
     void generate();
 
     public:
@@ -180,6 +240,9 @@ class CompoundShape : public Shape {
     private:
     std::vector<std::shared_ptr<Shape>> shapes;
     void renderRaw();
+    void pickRaw(Picker &picker);
+    void collectRaw(std::vector<Collider> &colliders, std::vector<std::shared_ptr<Transformation>> &chain);
+    void queueRaw(DrawQueue &queue, const Matrix4 &matrix);
 
     public:
     CompoundShape(std::initializer_list<Shape *> shapes);
@@ -0,0 +1,167 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "maths.hpp"
+
+// lane abstraction, so every kernel is written once for avx2, sse2 and plain scalar code
+
+namespace Simd {
+#if defined(__AVX2__)
+    const int lanes = 8;
+    typedef __m256 Floats;
+    typedef __m256i Ints;
+    inline Floats load(const GLfloat *p) { return _mm256_loadu_ps(p); }
+    inline void store(GLfloat *p, Floats a) { _mm256_storeu_ps(p, a); }
+    inline Floats set(GLfloat a) { return _mm256_set1_ps(a); }
+    inline Ints setInt(int a) { return _mm256_set1_epi32(a); }
+    inline Floats add(Floats a, Floats b) { return _mm256_add_ps(a, b); }
+    inline Floats sub(Floats a, Floats b) { return _mm256_sub_ps(a, b); }
+    inline Floats mul(Floats a, Floats b) { return _mm256_mul_ps(a, b); }
+    inline Floats min(Floats a, Floats b) { return _mm256_min_ps(a, b); }
+    inline Floats max(Floats a, Floats b) { return _mm256_max_ps(a, b); }
+    inline Floats sqrt(Floats a) { return _mm256_sqrt_ps(a); }
+    inline Floats bitAnd(Floats a, Floats b) { return _mm256_and_ps(a, b); }
+    inline Floats bitOr(Floats a, Floats b) { return _mm256_or_ps(a, b); }
+    inline Floats bitAndNot(Floats a, Floats b) { return _mm256_andnot_ps(a, b); }
+    inline Floats bitXor(Floats a, Floats b) { return _mm256_xor_ps(a, b); }
+    inline Floats greater(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    inline Ints truncate(Floats a) { return _mm256_cvttps_epi32(a); }
+    inline Floats toFloats(Ints a) { return _mm256_cvtepi32_ps(a); }
+    inline Floats asFloats(Ints a) { return _mm256_castsi256_ps(a); }
+    inline Ints addInt(Ints a, Ints b) { return _mm256_add_epi32(a, b); }
+    inline Ints andInt(Ints a, Ints b) { return _mm256_and_si256(a, b); }
+    inline Ints andNotInt(Ints a, Ints b) { return _mm256_andnot_si256(a, b); }
+    inline Ints equalInt(Ints a, Ints b) { return _mm256_cmpeq_epi32(a, b); }
+    inline Ints shiftInt(Ints a, int bits) { return _mm256_slli_epi32(a, bits); }
+#elif defined(MATHS_SSE)
+    const int lanes = 4;
+    typedef __m128 Floats;
+    typedef __m128i Ints;
+    inline Floats load(const GLfloat *p) { return _mm_loadu_ps(p); }
+    inline void store(GLfloat *p, Floats a) { _mm_storeu_ps(p, a); }
+    inline Floats set(GLfloat a) { return _mm_set1_ps(a); }
+    inline Ints setInt(int a) { return _mm_set1_epi32(a); }
+    inline Floats add(Floats a, Floats b) { return _mm_add_ps(a, b); }
+    inline Floats sub(Floats a, Floats b) { return _mm_sub_ps(a, b); }
+    inline Floats mul(Floats a, Floats b) { return _mm_mul_ps(a, b); }
+    inline Floats min(Floats a, Floats b) { return _mm_min_ps(a, b); }
+    inline Floats max(Floats a, Floats b) { return _mm_max_ps(a, b); }
+    inline Floats sqrt(Floats a) { return _mm_sqrt_ps(a); }
+    inline Floats bitAnd(Floats a, Floats b) { return _mm_and_ps(a, b); }
+    inline Floats bitOr(Floats a, Floats b) { return _mm_or_ps(a, b); }
+    inline Floats bitAndNot(Floats a, Floats b) { return _mm_andnot_ps(a, b); }
+    inline Floats bitXor(Floats a, Floats b) { return _mm_xor_ps(a, b); }
+    inline Floats greater(Floats a, Floats b) { return _mm_cmpgt_ps(a, b); }
+    inline Ints truncate(Floats a) { return _mm_cvttps_epi32(a); }
+    inline Floats toFloats(Ints a) { return _mm_cvtepi32_ps(a); }
+    inline Floats asFloats(Ints a) { return _mm_castsi128_ps(a); }
+    inline Ints addInt(Ints a, Ints b) { return _mm_add_epi32(a, b); }
+    inline Ints andInt(Ints a, Ints b) { return _mm_and_si128(a, b); }
+    inline Ints andNotInt(Ints a, Ints b) { return _mm_andnot_si128(a, b); }
+    inline Ints equalInt(Ints a, Ints b) { return _mm_cmpeq_epi32(a, b); }
+    inline Ints shiftInt(Ints a, int bits) { return _mm_slli_epi32(a, bits); }
+#else
+    const int lanes = 1;
+    typedef GLfloat Floats;
+    typedef int32_t Ints;
+    inline GLfloat asFloat(int32_t a) {
+        GLfloat f;
+        std::memcpy(&f, &a, sizeof f);
+        return f;
+    }
+    inline int32_t asInt(GLfloat a) {
+        int32_t i;
+        std::memcpy(&i, &a, sizeof i);
+        return i;
+    }
+    inline Floats load(const GLfloat *p) { return *p; }
+    inline void store(GLfloat *p, Floats a) { *p = a; }
+    inline Floats set(GLfloat a) { return a; }
+    inline Ints setInt(int a) { return a; }
+    inline Floats add(Floats a, Floats b) { return a + b; }
+    inline Floats sub(Floats a, Floats b) { return a - b; }
+    inline Floats mul(Floats a, Floats b) { return a * b; }
+    inline Floats min(Floats a, Floats b) { return std::min(a, b); }
+    inline Floats max(Floats a, Floats b) { return std::max(a, b); }
+    inline Floats sqrt(Floats a) { return std::sqrt(a); }
+    inline Floats bitAnd(Floats a, Floats b) { return asFloat(asInt(a) & asInt(b)); }
+    inline Floats bitOr(Floats a, Floats b) { return asFloat(asInt(a) | asInt(b)); }
+    inline Floats bitAndNot(Floats a, Floats b) { return asFloat(~asInt(a) & asInt(b)); }
+    inline Floats bitXor(Floats a, Floats b) { return asFloat(asInt(a) ^ asInt(b)); }
+    inline Floats greater(Floats a, Floats b) { return asFloat(a > b ? -1 : 0); }
+    inline Ints truncate(Floats a) { return (int32_t) a; }
+    inline Floats toFloats(Ints a) { return (GLfloat) a; }
+    inline Floats asFloats(Ints a) { return asFloat(a); }
+    inline Ints addInt(Ints a, Ints b) { return a + b; }
+    inline Ints andInt(Ints a, Ints b) { return a & b; }
+    inline Ints andNotInt(Ints a, Ints b) { return ~a & b; }
+    inline Ints equalInt(Ints a, Ints b) { return a == b ? -1 : 0; }
+    inline Ints shiftInt(Ints a, int bits) { return a << bits; }
+#endif
+
+    // a where the mask is set, b elsewhere
+    inline Floats select(Floats mask, Floats a, Floats b) { return bitOr(bitAnd(mask, a), bitAndNot(mask, b)); }
+
+    inline Floats expLanes(Floats x) {
+        x = min(max(x, set(-88.3762626647949f)), set(88.3762626647949f));
+        // express exp(x) as exp(g + n * log(2))
+        Floats fx = add(mul(x, set(1.44269504088896341f)), set(0.5f));
+        Floats floored = toFloats(truncate(fx));
+        fx = sub(floored, bitAnd(greater(floored, fx), set(1)));
+        x = sub(x, mul(fx, set(0.693359375f)));
+        x = sub(x, mul(fx, set(-2.12194440e-4f)));
+        Floats z = mul(x, x);
+        Floats y = set(1.9875691500e-4f);
+        y = add(mul(y, x), set(1.3981999507e-3f));
+        y = add(mul(y, x), set(8.3334519073e-3f));
+        y = add(mul(y, x), set(4.1665795894e-2f));
+        y = add(mul(y, x), set(1.6666665459e-1f));
+        y = add(mul(y, x), set(5.0000001201e-1f));
+        y = add(add(mul(y, z), x), set(1));
+        // build 2^n straight into the exponent bits
+        Ints n = shiftInt(addInt(truncate(fx), setInt(0x7f)), 23);
+        return mul(y, asFloats(n));
+    }
+
+    inline void sinCosLanes(Floats x, Floats &sines, Floats &cosines) {
+        Floats signMask = asFloats(setInt((int) 0x80000000));
+        Floats sinSign = bitAnd(x, signMask);
+        x = bitAndNot(signMask, x);
+        // reduce to an octant
+        Ints j = truncate(mul(x, set(1.27323954473516f)));
+        j = andInt(addInt(j, setInt(1)), setInt(~1));
+        Floats y = toFloats(j);
+        Floats swapSinSign = asFloats(shiftInt(andInt(j, setInt(4)), 29));
+        Floats polynomialMask = asFloats(equalInt(andInt(j, setInt(2)), setInt(0)));
+        Floats cosSign = asFloats(shiftInt(andNotInt(addInt(j, setInt(-2)), setInt(4)), 29));
+        sinSign = bitXor(sinSign, swapSinSign);
+        // extended precision modular arithmetic
+        x = add(x, mul(y, set(-0.78515625f)));
+        x = add(x, mul(y, set(-2.4187564849853515625e-4f)));
+        x = add(x, mul(y, set(-3.77489497744594108e-8f)));
+        Floats z = mul(x, x);
+        // cosine polynomial
+        Floats cosine = set(2.443315711809948e-5f);
+        cosine = add(mul(cosine, z), set(-1.388731625493765e-3f));
+        cosine = add(mul(cosine, z), set(4.166664568298827e-2f));
+        cosine = mul(mul(cosine, z), z);
+        cosine = add(sub(cosine, mul(z, set(0.5f))), set(1));
+        // sine polynomial
+        Floats sine = set(-1.9515295891e-4f);
+        sine = add(mul(sine, z), set(8.3321608736e-3f));
+        sine = add(mul(sine, z), set(-1.6666654611e-1f));
+        sine = add(mul(mul(sine, z), x), x);
+        // pick which polynomial goes where
+        Floats sineResult = add(bitAnd(polynomialMask, sine), bitAndNot(polynomialMask, cosine));
+        Floats cosineResult = add(bitAnd(polynomialMask, cosine), bitAndNot(polynomialMask, sine));
+        sines = bitXor(sineResult, sinSign);
+        cosines = bitXor(cosineResult, cosSign);
+    }
+}
+
+#endif
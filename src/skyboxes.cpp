@@ -0,0 +1,53 @@
+#define _USE_MATH_DEFINES
+
+#include "skyboxes.hpp"
+
+#include <cmath>
+
+#include "maths.hpp"
+#include "shaders.hpp"
+
+// class Skybox
+
+Skybox::Skybox() : unprojectLocation(-1), angleLocation(-1) {}
+
+void Skybox::initialize(TextureHandle texture, ShaderHandle shader) {
+    this->texture = texture;
+    this->shader = shader;
+    unprojectLocation = Resources::getShader(shader)->getUniformLocation("unproject");
+    angleLocation = Resources::getShader(shader)->getUniformLocation("angle");
+    // faces filter into each other at their edges
+    if (GLEW_ARB_seamless_cube_map) glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+}
+
+void Skybox::render(GLfloat degrees) {
+    Shader *program = Resources::getShader(shader);
+    GLuint cubeMap = Resources::getTexture(texture, GL_TEXTURE_CUBE_MAP);
+    // a sky that couldn't be loaded leaves the clear color
+    if (!program || !cubeMap) return;
+
+    // the sky is infinitely far away, so only the way the observer looks moves it
+    Matrix4 projection, view;
+    glGetFloatv(GL_PROJECTION_MATRIX, projection.array);
+    glGetFloatv(GL_MODELVIEW_MATRIX, view.array);
+    view.array[12] = view.array[13] = view.array[14] = 0;
+    Matrix4 unproject = (projection * view).inverse();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_POLYGON_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glDisable(GL_LIGHTING);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
+    program->enable();
+    glUniformMatrix4fv(unprojectLocation, 1, GL_FALSE, unproject.array);
+    glUniform1f(angleLocation, degrees * M_PI / 180);
+    // the corners come from the vertex ids, no arrays are read
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    Shader::clear();
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    glPopAttrib();
+}
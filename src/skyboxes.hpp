@@ -0,0 +1,27 @@
+#ifndef SKYBOXES_HPP
+#define SKYBOXES_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include "resources.hpp"
+
+// the sky as a cube map, looked up along the view ray of every pixel by a single triangle covering the screen at the
+// far plane; drawn after the opaque scene with the depth test at less or equal, only the pixels nothing covers are
+// shaded, and drawn before it, it is under everything
+class Skybox {
+    private:
+    TextureHandle texture;
+    ShaderHandle shader;
+    GLint unprojectLocation, angleLocation;
+
+    public:
+    Skybox();
+    // the shader is skybox.vert and skybox.frag, with the cube map on texture unit 0
+    void initialize(TextureHandle texture, ShaderHandle shader);
+    // draws with the current projection and the rotation of the current modelview, the sky turned around y by degrees
+    void render(GLfloat degrees);
+};
+
+#endif
@@ -3,30 +3,171 @@
 
 #include <GL/freeglut.h>
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
 #include <type_traits>
 #include <variant>
+#include <vector>
+
+namespace Reactive {
+    // every value is brought up to date at most once per epoch, the main loop advances it once per frame
+    inline unsigned long epoch = 1;
+    inline void advance() { ++epoch; }
+
+    class Node {
+        public:
+        unsigned long checked = 0;  // epoch in which the node was last brought up to date
+        unsigned long changed = 0;  // epoch in which its value last changed
+        virtual ~Node() {}
+        virtual void refresh() = 0;
+        void update() {
+            // marked first so that a cycle reads the previous value instead of recursing
+            if (checked == epoch) return;
+            checked = epoch;
+            refresh();
+        }
+    };
+
+    // the reads of the derived value under evaluation, which become its dependencies
+    inline std::vector<std::shared_ptr<Node>> *reads = nullptr;
+    inline void track(const std::shared_ptr<Node> &node) {
+        if (reads) reads->push_back(node);
+    }
+
+    template <typename T, typename = void>
+    struct IsComparable : std::false_type {};
+    template <typename T>
+    struct IsComparable<T, std::void_t<decltype(std::declval<const T &>() == std::declval<const T &>())>> : std::true_type {};
+
+    template <typename T>
+    bool equal(const T &a, const T &b) {
+        if constexpr (IsComparable<T>::value) {
+            return a == b;
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>, "reactive values must be comparable or trivially copyable");
+            return std::memcmp(&a, &b, sizeof(T)) == 0;
+        }
+    }
+
+    template <typename T>
+    class Constant : public Node {
+        public:
+        T value;
+        Constant(const T &value) : value(value) { changed = epoch; }
+        void refresh() {}
+    };
+
+    // a plain variable, polled once per epoch, so it can still be written through a pointer
+    template <typename T>
+    class Source : public Node {
+        public:
+        const T *pointer;
+        T value;
+        Source(const T *pointer) : pointer(pointer), value(*pointer) { changed = epoch; }
+        void refresh() {
+            if (equal(value, *pointer)) return;
+            value = *pointer;
+            changed = epoch;
+        }
+    };
+
+    // sources are shared by address so that every reader depends on the same node
+    template <typename T>
+    std::shared_ptr<Source<T>> source(const T *pointer) {
+        static std::map<const T *, std::shared_ptr<Source<T>>> sources;
+        auto &source = sources[pointer];
+        if (!source) source = std::make_shared<Source<T>>(pointer);
+        return source;
+    }
+
+    // reads a variable as a dependency of the derived value under evaluation (a plain read otherwise)
+    template <typename T>
+    const T &read(const T *pointer) {
+        if (reads) {
+            auto node = source(pointer);
+            node->update();
+            track(node);
+        }
+        return *pointer;
+    }
+
+    // a function of other values, re-evaluated only when something it read last time changed;
+    // one that read nothing reactive is treated as volatile and evaluated on every epoch
+    template <typename T>
+    class Derived : public Node {
+        public:
+        std::function<T()> function;
+        std::optional<T> value;
+        std::vector<std::shared_ptr<Node>> dependencies;
+        unsigned long evaluated = 0;
+        Derived(std::function<T()> function) : function(function) {}
+        void refresh() {
+            if (value && !dependencies.empty() && std::none_of(dependencies.begin(), dependencies.end(), [this](auto &dependency) {
+                    dependency->update();
+                    return dependency->changed > evaluated;
+                })) return;
+            std::vector<std::shared_ptr<Node>> current, *outer = reads;
+            reads = &current;
+            T result = function();
+            reads = outer;
+            dependencies.swap(current);
+            evaluated = epoch;
+            if (value && equal(*value, result)) return;
+            value = result;
+            changed = epoch;
+        }
+    };
+}
 
 template <typename T>
 class DynamicValue {
     private:
-    std::variant<T, std::function<T()>> getter;
+    enum class Kind { Constant, Source, Derived };
+    std::shared_ptr<Reactive::Node> node;
+    Kind kind;
+    // where the node keeps its value, taken when the handle is made so reads need no casts
+    const T *value = nullptr;
+    const std::optional<T> *derived = nullptr;
+    DynamicValue(std::shared_ptr<Reactive::Constant<T>> constant) : node(constant), kind(Kind::Constant), value(&constant->value) {}
+    DynamicValue(std::shared_ptr<Reactive::Source<T>> source) : node(source), kind(Kind::Source), value(&source->value) {}
+    DynamicValue(std::shared_ptr<Reactive::Derived<T>> derived) : node(derived), kind(Kind::Derived), derived(&derived->value) {}
+    const T &get() const {
+        // constants never change, so nothing needs to bring them up to date or depend on them
+        if (kind == Kind::Constant) return *value;
+        node->update();
+        Reactive::track(node);
+        return kind == Kind::Source ? *value : **derived;
+    }
 
     public:
-    DynamicValue(const T& constant) : getter(constant){};
+    DynamicValue(const T& constant) : DynamicValue(std::make_shared<Reactive::Constant<T>>(constant)) {}
     template <typename F, typename = std::enable_if_t<std::is_invocable_v<F>>>
-    DynamicValue(F&& function) : getter(function) {}
-    DynamicValue(const T* pointer) : DynamicValue([pointer]() { return *pointer; }) {}
-    DynamicValue(const DynamicValue& value) : getter(value.getter) {}
+    DynamicValue(F&& function) : DynamicValue(std::make_shared<Reactive::Derived<T>>(std::function<T()>(function))) {}
+    DynamicValue(const T* pointer) : DynamicValue(Reactive::source(pointer)) {}
+    DynamicValue(const DynamicValue& value) : node(value.node), kind(value.kind), value(value.value), derived(value.derived) {}
     DynamicValue(DynamicValue& value) : DynamicValue((const DynamicValue&) value) {}
-    DynamicValue(DynamicValue&& value) : getter(std::move(value.getter)) {}
+    DynamicValue(DynamicValue&& value) : node(std::move(value.node)), kind(value.kind), value(value.value), derived(value.derived) {}
     ~DynamicValue() {}
     DynamicValue& operator=(const DynamicValue& value) {
-        getter = value.getter;
+        node = value.node;
+        kind = value.kind;
+        this->value = value.value;
+        derived = value.derived;
         return *this;
     }
-    T operator()() const { return getter.index() == 0 ? std::get<T>(getter) : std::get<std::function<T()>>(getter)(); }
+    T operator()() const { return get(); }
+    // whether the value changed in the current epoch
+    bool changed() const { return changedSince(Reactive::epoch - 1); }
+    // whether the value changed after a given epoch, for caches that remember when they were last filled
+    bool changedSince(unsigned long epoch) const {
+        if (kind != Kind::Constant) node->update();
+        return node->changed > epoch;
+    }
 };
 
 struct Coordinates4D {
@@ -0,0 +1,207 @@
+#include "textures.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "bitmaps.hpp"
+#include "files.hpp"
+#include "maths.hpp"
+
+namespace {
+    template <typename T>
+    T read(const char *data, size_t offset) {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+}
+
+// struct CompressedTexture
+
+size_t CompressedTexture::getLevelSize(Format format, GLint width, GLint height) {
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * (format == BC1 ? 8 : 16);
+}
+
+bool CompressedTexture::parseDds(const char *data, size_t size) {
+    if (size < 128 || std::memcmp(data, "DDS ", 4) != 0) return false;
+    GLint height = read<uint32_t>(data, 12), width = read<uint32_t>(data, 16);
+    // the mipmap count only counts when its flag is set
+    uint32_t levelCount = read<uint32_t>(data, 8) & 0x20000 ? std::max(read<uint32_t>(data, 28), 1u) : 1;
+    size_t offset = 128;
+    if (std::memcmp(data + 84, "DXT1", 4) == 0) {
+        format = BC1;
+    } else if (std::memcmp(data + 84, "DX10", 4) == 0 && size >= 148) {
+        // the extended header, for formats with no four character code: bc1 and bc7 in any flavor, one 2d image
+        uint32_t dxgiFormat = read<uint32_t>(data, 128);
+        if (dxgiFormat >= 70 && dxgiFormat <= 72) {
+            format = BC1;
+        } else if (dxgiFormat >= 97 && dxgiFormat <= 99) {
+            format = BC7;
+        } else {
+            return false;
+        }
+        if (read<uint32_t>(data, 132) != 3 || read<uint32_t>(data, 140) > 1) return false;
+        offset = 148;
+    } else {
+        return false;
+    }
+    // cube maps and volumes are elsewhere
+    if (read<uint32_t>(data, 112) & 0x200200 || width <= 0 || height <= 0 || levelCount > 32) return false;
+
+    levels.clear();
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        GLint levelWidth = std::max(width >> i, 1), levelHeight = std::max(height >> i, 1);
+        size_t levelSize = getLevelSize(format, levelWidth, levelHeight);
+        if (offset + levelSize > size) return false;
+        levels.push_back({levelWidth, levelHeight, data + offset, levelSize});
+        offset += levelSize;
+    }
+    return true;
+}
+
+bool CompressedTexture::parseKtx2(const char *data, size_t size) {
+    const unsigned char identifier[12] = {0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+    if (size < 80 || std::memcmp(data, identifier, 12) != 0) return false;
+    uint32_t vkFormat = read<uint32_t>(data, 12);
+    GLint width = read<uint32_t>(data, 20), height = read<uint32_t>(data, 24);
+    uint32_t levelCount = std::max(read<uint32_t>(data, 40), 1u);
+    // the vulkan formats of bc1 with and without alpha and bc7, linear or srgb
+    if (vkFormat >= 131 && vkFormat <= 134) {
+        format = BC1;
+    } else if (vkFormat == 145 || vkFormat == 146) {
+        format = BC7;
+    } else {
+        return false;
+    }
+    // one 2d image, not supercompressed
+    if (read<uint32_t>(data, 28) != 0 || read<uint32_t>(data, 32) > 1 || read<uint32_t>(data, 36) != 1 || read<uint32_t>(data, 44) != 0) return false;
+    if (width <= 0 || height <= 0 || levelCount > 32 || 80 + levelCount * 24 > size) return false;
+
+    levels.clear();
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        uint64_t offset = read<uint64_t>(data, 80 + i * 24), length = read<uint64_t>(data, 88 + i * 24);
+        GLint levelWidth = std::max(width >> i, 1), levelHeight = std::max(height >> i, 1);
+        size_t levelSize = getLevelSize(format, levelWidth, levelHeight);
+        if (length < levelSize || offset > size || size - offset < levelSize) return false;
+        levels.push_back({levelWidth, levelHeight, data + offset, levelSize});
+    }
+    return true;
+}
+
+// struct DecodedTexture
+
+bool DecodedTexture::decode(std::string path, bool mipmaps) {
+    levels.clear();
+    buffers.clear();
+    file.reset();
+    if (path.size() < 4 || path.compare(path.size() - 4, 4, ".bmp") != 0) {
+        size_t size = 0;
+        file = Files::map(path, size);
+        CompressedTexture texture;
+        if (!file || !texture.parseDds(file.get(), size) && !texture.parseKtx2(file.get(), size)) {
+            std::cerr << path << " isn't a dds or ktx2 file of bc1 or bc7 blocks" << std::endl;
+            return false;
+        }
+        bool bc1 = texture.format == CompressedTexture::BC1;
+        if (bc1 ? !GLEW_EXT_texture_compression_s3tc : !GLEW_ARB_texture_compression_bptc) {
+            std::cerr << "the gpu can't sample the " << (bc1 ? "bc1" : "bc7") << " blocks of " << path << std::endl;
+            return false;
+        }
+        compressed = true;
+        internalFormat = bc1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+        format = 0;
+        for (size_t i = 0; i < (mipmaps ? texture.levels.size() : 1); ++i) {
+            const CompressedTexture::Level &level = texture.levels[i];
+            levels.push_back({level.width, level.height, level.data, level.size, 4});
+        }
+        return true;
+    }
+
+    if (!bitmap.load(path)) return false;
+    compressed = false;
+    format = bitmap.getFormat();
+    internalFormat = bitmap.hasAlpha() ? GL_RGBA8 : GL_RGB8;
+    int channels = format == GL_RGB || format == GL_BGR ? 3 : 4;
+    GLint width = bitmap.getWidth(), height = bitmap.getHeight(), stride = bitmap.getStride();
+    // mapped rows are padded to four bytes, decoded ones are packed
+    levels.push_back({width, height, bitmap.getPixels(), (size_t) stride * height, stride % 4 == 0 ? 4 : 1});
+    if (!mipmaps) return true;
+
+    // every level is made from the one before, the first straight from the bitmap's rows
+    while (width > 1 || height > 1) {
+        GLint nextWidth = std::max(width / 2, 1), nextHeight = std::max(height / 2, 1);
+        std::vector<unsigned char> &next = buffers.emplace_back((size_t) nextWidth * nextHeight * channels);
+        Textures::downsample((const unsigned char *) levels.back().data, width, height, stride, channels, next.data());
+        levels.push_back({nextWidth, nextHeight, next.data(), next.size(), 1});
+        width = nextWidth;
+        height = nextHeight;
+        stride = width * channels;
+    }
+    return true;
+}
+
+// namespace Textures
+
+GLuint Textures::load(std::string path, TextureSampling sampling) {
+    DecodedTexture decoded;
+    if (!decoded.decode(path, sampling.mipmaps)) return 0;
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    for (size_t i = 0; i < decoded.levels.size(); ++i) uploadLevel(GL_TEXTURE_2D, decoded, i, decoded.levels[i].data);
+    setSampling(GL_TEXTURE_2D, decoded.levels.size(), sampling);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+void Textures::uploadLevel(GLenum target, const DecodedTexture &texture, int level, const void *data) {
+    const DecodedTexture::Level &current = texture.levels[level];
+    if (texture.compressed) {
+        glCompressedTexImage2D(target, level, texture.internalFormat, current.width, current.height, 0, current.size, data);
+        return;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, current.alignment);
+    glTexImage2D(target, level, texture.internalFormat, current.width, current.height, 0, texture.format, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Textures::setSampling(GLenum target, int levels, TextureSampling sampling) {
+    GLint wrap = target == GL_TEXTURE_CUBE_MAP ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+    if (target == GL_TEXTURE_CUBE_MAP) glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+    if (sampling.anisotropy > 1 && GLEW_EXT_texture_filter_anisotropic) {
+        GLfloat maximum = 1;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maximum);
+        glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(sampling.anisotropy, maximum));
+    }
+}
+
+void Textures::downsample(const unsigned char *input, GLint width, GLint height, GLint stride, int channels, unsigned char *output) {
+    GLint outputWidth = std::max(width / 2, 1), outputHeight = std::max(height / 2, 1), length = width * channels;
+    std::vector<uint16_t> sums(length);
+    for (int row = 0; row < outputHeight; ++row) {
+        // the two rows summed first, sixteen channels at a time
+        const unsigned char *top = input + (size_t) std::min(row * 2, height - 1) * stride, *bottom = input + (size_t) std::min(row * 2 + 1, height - 1) * stride;
+        int i = 0;
+#ifdef MATHS_SSE
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *) (top + i)), b = _mm_loadu_si128((const __m128i *) (bottom + i));
+            _mm_storeu_si128((__m128i *) &sums[i], _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)));
+            _mm_storeu_si128((__m128i *) &sums[i + 8], _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)));
+        }
+#endif
+        for (; i < length; ++i) sums[i] = top[i] + bottom[i];
+        // then the two columns, rounding to nearest
+        unsigned char *line = output + (size_t) row * outputWidth * channels;
+        for (int column = 0; column < outputWidth; ++column) {
+            const uint16_t *left = &sums[std::min(column * 2, width - 1) * channels], *right = &sums[std::min(column * 2 + 1, width - 1) * channels];
+            for (int k = 0; k < channels; ++k) line[column * channels + k] = (left[k] + right[k] + 2) >> 2;
+        }
+    }
+}
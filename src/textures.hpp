@@ -0,0 +1,74 @@
+#ifndef TEXTURES_HPP
+#define TEXTURES_HPP
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bitmaps.hpp"
+
+// how textures are sampled: trilinearly from their mipmaps, and anisotropically up to some degree where the gpu can
+struct TextureSampling {
+    bool mipmaps = true;
+    GLfloat anisotropy = 8;  // 1 turns it off
+};
+
+// a texture of 4x4 blocks, each level read from a .dds or .ktx2 file holding bc1 or bc7 blocks; the converter in tools
+// stores rows bottom up, as gl takes them, so other files come out upside down
+struct CompressedTexture {
+    enum Format {
+        BC1,
+        BC7
+    };
+    struct Level {
+        GLint width, height;
+        const char *data;
+        size_t size;
+    };
+    Format format;
+    std::vector<Level> levels;  // largest first
+
+    static size_t getLevelSize(Format format, GLint width, GLint height);
+    // the levels point into data, which must outlive them
+    bool parseDds(const char *data, size_t size);
+    bool parseKtx2(const char *data, size_t size);
+};
+
+// a texture read and laid out the way gl takes it without touching gl, so it can be made on any thread: a bitmap with
+// the mipmaps made from it, or a compressed texture with mipmaps made offline
+struct DecodedTexture {
+    struct Level {
+        GLint width, height;
+        const void *data;
+        size_t size;
+        GLint alignment;  // of rows, for unpacking
+    };
+    bool compressed = false;
+    GLenum internalFormat = 0, format = 0;  // no format for compressed levels
+    std::vector<Level> levels;  // largest first, pointing into what is kept below
+    Bitmap bitmap;
+    std::shared_ptr<const char> file;
+    std::vector<std::vector<unsigned char>> buffers;
+
+    // only the first level without mipmaps; false when the file can't be read or the gpu can't take its format
+    bool decode(std::string path, bool mipmaps);
+};
+
+namespace Textures {
+    // loads a bitmap or compressed texture into a new 2d texture that repeats; 0 when it can't be decoded
+    GLuint load(std::string path, TextureSampling sampling);
+    // specifies a level of the texture bound to a 2d target, or of a cube map face, from data, which is an offset when a
+    // pixel unpack buffer is bound
+    void uploadLevel(GLenum target, const DecodedTexture &texture, int level, const void *data);
+    // filters the texture bound to the target, once all of its levels are in; cube maps clamp rather than repeat
+    void setSampling(GLenum target, int levels, TextureSampling sampling);
+    // halves a level of 8 bit channels with a box filter, clamping the odd row or column at the edge
+    void downsample(const unsigned char *input, GLint width, GLint height, GLint stride, int channels, unsigned char *output);
+}
+
+#endif
@@ -0,0 +1,252 @@
+#include "vertices.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "shaders.hpp"
+
+// namespace Quantize
+
+uint16_t Quantize::toHalf(GLfloat value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int exponent = (int) ((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    // too small even for a subnormal half
+    if (exponent < -10) return sign;
+    // subnormal half, shift the implicit bit in and round to nearest
+    if (exponent <= 0) {
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        uint16_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1) half++;
+        return sign | half;
+    }
+    // too big, saturate to infinity
+    if (exponent >= 31) return sign | 0x7c00;
+    // normal half, rounding may carry into the exponent which is still correct
+    uint16_t half = sign | (exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000) half++;
+    return half;
+}
+
+int16_t Quantize::toShort(GLfloat value) {
+    return (int16_t) std::lround(std::clamp(value, -1.f, 1.f) * 32767);
+}
+
+void Quantize::toOctahedral(const GLfloat *normal, int16_t *encoded) {
+    GLfloat length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+    if (length == 0) {
+        encoded[0] = encoded[1] = 0;
+        return;
+    }
+    // project onto the octahedron
+    GLfloat x = normal[0] / length, y = normal[1] / length;
+    // fold the lower hemisphere over the diagonals
+    if (normal[2] < 0) {
+        GLfloat foldedX = (1 - std::abs(y)) * (x >= 0 ? 1 : -1);
+        GLfloat foldedY = (1 - std::abs(x)) * (y >= 0 ? 1 : -1);
+        x = foldedX;
+        y = foldedY;
+    }
+    encoded[0] = toShort(x);
+    encoded[1] = toShort(y);
+}
+
+GLfloat Quantize::fromHalf(uint16_t half) {
+    int exponent = (half >> 10) & 0x1f, mantissa = half & 0x3ff;
+    GLfloat magnitude = exponent == 0 ? std::ldexp((GLfloat) mantissa, -24) : exponent == 31 ? INFINITY : std::ldexp((GLfloat) (mantissa | 0x400), exponent - 25);
+    return half & 0x8000 ? -magnitude : magnitude;
+}
+
+void Quantize::fromOctahedral(const int16_t *encoded, GLfloat *normal) {
+    // as the shaders do it
+    GLfloat x = std::max(encoded[0] / 32767.f, -1.f), y = std::max(encoded[1] / 32767.f, -1.f), z = 1 - std::abs(x) - std::abs(y);
+    if (z < 0) {
+        GLfloat unfoldedX = (1 - std::abs(y)) * (x >= 0 ? 1 : -1);
+        GLfloat unfoldedY = (1 - std::abs(x)) * (y >= 0 ? 1 : -1);
+        x = unfoldedX;
+        y = unfoldedY;
+    }
+    GLfloat length = std::sqrt(x * x + y * y + z * z);
+    normal[0] = x / length;
+    normal[1] = y / length;
+    normal[2] = z / length;
+}
+
+// class VertexArray
+
+VertexArray::VertexArray() : count(0), stride(0), normalOffset(0), textureOffset(0), center{0, 0, 0}, scale(1) {}
+
+VertexArray::VertexArray(VertexFormat format, const std::vector<GLfloat> &vertices, const std::vector<GLfloat> &normals, const std::vector<GLfloat> &textureVertices, std::vector<GLuint> indices)
+    : format(format), indices(std::move(indices)), count(vertices.size() / 3), center{0, 0, 0}, scale(1) {
+    // quantized positions are stored relative to the bounds of the shape
+    GLfloat extent = 1;
+    if (format.position != PositionFormat::Float && count > 0) {
+        Coordinates3D min{vertices[0], vertices[1], vertices[2]}, max = min;
+        for (int i = 0; i < count * 3; ++i) {
+            min.array[i % 3] = std::min(min.array[i % 3], vertices[i]);
+            max.array[i % 3] = std::max(max.array[i % 3], vertices[i]);
+        }
+        extent = 0;
+        for (int k = 0; k < 3; ++k) {
+            center.array[k] = (min.array[k] + max.array[k]) / 2;
+            extent = std::max(extent, (max.array[k] - min.array[k]) / 2);
+        }
+        // a single uniform scale keeps the normal matrix a pure rotation
+        if (extent == 0) extent = 1;
+        scale = format.position == PositionFormat::Short ? extent / 32767 : extent;
+    }
+
+    // compute the interleaved layout (every attribute stays 4-byte aligned)
+    normalOffset = format.position == PositionFormat::Float ? 12 : 8;
+    textureOffset = normalOffset + (format.normal == NormalFormat::Float ? 12 : format.normal == NormalFormat::Octahedral ? 4 : 0);
+    stride = textureOffset + (format.texture == TextureFormat::Float ? 8 : 4);
+    data.resize(count * stride);
+
+    bool textured = textureVertices.size() >= count * 2;
+    for (int i = 0; i < count; ++i) {
+        uint8_t *vertex = &data[i * stride];
+        // position
+        if (format.position == PositionFormat::Float) {
+            std::memcpy(vertex, &vertices[i * 3], 12);
+        } else {
+            uint16_t position[4] = {0, 0, 0, 0};
+            for (int k = 0; k < 3; ++k) {
+                GLfloat relative = (vertices[i * 3 + k] - center.array[k]) / extent;
+                position[k] = format.position == PositionFormat::Half ? Quantize::toHalf(relative) : (uint16_t) Quantize::toShort(relative);
+            }
+            std::memcpy(vertex, position, 8);
+        }
+        // normal
+        if (format.normal == NormalFormat::Float) {
+            std::memcpy(vertex + normalOffset, &normals[i * 3], 12);
+        } else if (format.normal == NormalFormat::Octahedral) {
+            int16_t normal[2];
+            Quantize::toOctahedral(&normals[i * 3], normal);
+            std::memcpy(vertex + normalOffset, normal, 4);
+        }
+        // texture
+        GLfloat texture[2] = {0, 0};
+        if (textured) std::copy(&textureVertices[i * 2], &textureVertices[i * 2] + 2, texture);
+        if (format.texture == TextureFormat::Float) {
+            std::memcpy(vertex + textureOffset, texture, 8);
+        } else {
+            int16_t quantized[2] = {Quantize::toShort(texture[0] * 2 - 1), Quantize::toShort(texture[1] * 2 - 1)};
+            std::memcpy(vertex + textureOffset, quantized, 4);
+        }
+    }
+}
+
+int VertexArray::getCount() const { return count; }
+
+int VertexArray::getStride() const { return stride; }
+
+void VertexArray::enable(bool textured) const {
+    const uint8_t *base = data.data();
+
+    // decode quantized positions with the modelview matrix
+    if (format.position != PositionFormat::Float) {
+        glPushMatrix();
+        glTranslatef(center.x, center.y, center.z);
+        glScalef(scale, scale, scale);
+    }
+    // shaders need the same decode to rebuild analytic normals
+    glVertexAttrib4f(VertexAttribute::vertexDecode, center.x, center.y, center.z, scale);
+    glVertexAttrib1f(VertexAttribute::normalEncoding, (GLfloat) format.normal);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, format.position == PositionFormat::Float ? GL_FLOAT : format.position == PositionFormat::Half ? GL_HALF_FLOAT : GL_SHORT, stride, base);
+    if (format.normal == NormalFormat::Float) {
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT, stride, base + normalOffset);
+    } else if (format.normal == NormalFormat::Octahedral) {
+        glEnableVertexAttribArray(VertexAttribute::octahedralNormal);
+        glVertexAttribPointer(VertexAttribute::octahedralNormal, 2, GL_SHORT, GL_TRUE, stride, base + normalOffset);
+    }
+    // the fixed pipeline only reads gl_Normal, so without a shader compact normals go to it decoded as well
+    if (format.normal != NormalFormat::Float && !Shader::getBound()) {
+        if (fixedNormals.empty()) decodeNormals();
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT, 0, fixedNormals.data());
+    }
+    if (textured) {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, format.texture == TextureFormat::Float ? GL_FLOAT : GL_SHORT, stride, base + textureOffset);
+        // decode quantized texture coordinates with the texture matrix
+        if (format.texture == TextureFormat::Short) {
+            glMatrixMode(GL_TEXTURE);
+            glPushMatrix();
+            glTranslatef(0.5, 0.5, 0);
+            glScalef(0.5f / 32767, 0.5f / 32767, 1);
+            glMatrixMode(GL_MODELVIEW);
+        }
+    }
+}
+
+void VertexArray::decodeNormals() const {
+    fixedNormals.resize(count * 3);
+    for (int i = 0; i < count; ++i) {
+        const uint8_t *vertex = &data[i * stride];
+        GLfloat *normal = &fixedNormals[i * 3];
+        if (format.normal == NormalFormat::Octahedral) {
+            int16_t encoded[2];
+            std::memcpy(encoded, vertex + normalOffset, 4);
+            Quantize::fromOctahedral(encoded, normal);
+            continue;
+        }
+        // analytic, the decoded position of a sphere centered at the origin
+        if (format.position == PositionFormat::Float) {
+            std::memcpy(normal, vertex, 12);
+        } else {
+            int16_t position[3];
+            std::memcpy(position, vertex, 6);
+            for (int k = 0; k < 3; ++k) {
+                GLfloat stored = format.position == PositionFormat::Half ? Quantize::fromHalf(position[k]) : position[k];
+                normal[k] = stored * scale + center.array[k];
+            }
+        }
+        GLfloat length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length > 0) for (int k = 0; k < 3; ++k) normal[k] /= length;
+    }
+}
+
+void VertexArray::draw() const {
+    // indexed arrays hold triangles, plain ones the quads straight from the generators
+    ++drawCalls;
+    if (indices.empty()) {
+        triangles += count / 2;
+        glDrawArrays(GL_QUADS, 0, count);
+    } else {
+        triangles += indices.size() / 3;
+        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, indices.data());
+    }
+}
+
+void VertexArray::draw(int instances) const {
+    ++drawCalls;
+    triangles += (unsigned long) (indices.empty() ? count / 2 : indices.size() / 3) * instances;
+    if (indices.empty()) {
+        glDrawArraysInstanced(GL_QUADS, 0, count, instances);
+    } else {
+        glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, indices.data(), instances);
+    }
+}
+
+void VertexArray::disable(bool textured) const {
+    glDisableClientState(GL_VERTEX_ARRAY);
+    // also the decoded normals, if they were drawn
+    glDisableClientState(GL_NORMAL_ARRAY);
+    if (format.normal == NormalFormat::Octahedral) glDisableVertexAttribArray(VertexAttribute::octahedralNormal);
+    if (textured) {
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        if (format.texture == TextureFormat::Short) {
+            glMatrixMode(GL_TEXTURE);
+            glPopMatrix();
+            glMatrixMode(GL_MODELVIEW);
+        }
+    }
+    if (format.position != PositionFormat::Float) glPopMatrix();
+}
@@ -0,0 +1,86 @@
+#ifndef VERTICES_HPP
+#define VERTICES_HPP
+
+#define _USE_MATH_DEFINES
+
+#include <GL/glew.h>
+// glew must be included first
+#include <GL/freeglut.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "structures.hpp"
+
+// generic attribute locations read by the shaders to decode compact vertices
+// (picked so they don't alias gl_Vertex, gl_Normal, gl_Color or gl_MultiTexCoord)
+namespace VertexAttribute {
+    // set once a draw rather than streamed, the index into the material table, on the location of vertex weights
+    const GLuint materialIndex = 1;
+    const GLuint octahedralNormal = 5;
+    const GLuint vertexDecode = 6;
+    const GLuint normalEncoding = 7;
+    // per instance, on the locations of texture units 3 to 7, which nothing draws with
+    const GLuint instanceAnimation = 11;
+    const GLuint instanceMatrix = 12;  // a column each, up to 15
+}
+
+enum class PositionFormat {
+    Float,  // 3 x 32-bit float
+    Half,   // 3 x 16-bit float, relative to the shape's bounds
+    Short   // 3 x 16-bit normalized integer, relative to the shape's bounds
+};
+
+enum class NormalFormat {
+    Float,       // 3 x 32-bit float
+    Octahedral,  // 2 x 16-bit normalized integer, decoded in the shader
+    Analytic     // no stream, rebuilt from the position in the shader (spheres)
+};
+
+enum class TextureFormat {
+    Float,  // 2 x 32-bit float
+    Short   // 2 x 16-bit normalized integer
+};
+
+struct VertexFormat {
+    PositionFormat position;
+    NormalFormat normal;
+    TextureFormat texture;
+    VertexFormat(PositionFormat position = PositionFormat::Float, NormalFormat normal = NormalFormat::Float, TextureFormat texture = TextureFormat::Float)
+        : position(position), normal(normal), texture(texture) {}
+};
+
+class VertexArray {
+    private:
+    VertexFormat format;
+    std::vector<uint8_t> data;
+    std::vector<GLuint> indices;
+    int count, stride, normalOffset, textureOffset;
+    Coordinates3D center;
+    GLfloat scale;
+    mutable std::vector<GLfloat> fixedNormals;  // decoded from the compact ones the first time no shader draws them
+    void decodeNormals() const;
+
+    public:
+    // draws issued and triangles drawn since they were last zeroed, for benchmarks
+    inline static unsigned long drawCalls = 0, triangles = 0;
+    VertexArray();
+    VertexArray(VertexFormat format, const std::vector<GLfloat> &vertices, const std::vector<GLfloat> &normals, const std::vector<GLfloat> &textureVertices, std::vector<GLuint> indices = {});
+    int getCount() const;
+    int getStride() const;
+    void enable(bool textured) const;
+    void draw() const;
+    void draw(int instances) const;
+    void disable(bool textured) const;
+};
+
+namespace Quantize {
+    uint16_t toHalf(GLfloat value);
+    int16_t toShort(GLfloat value);
+    void toOctahedral(const GLfloat *normal, int16_t *encoded);
+    GLfloat fromHalf(uint16_t half);
+    void fromOctahedral(const int16_t *encoded, GLfloat *normal);
+}
+
+#endif
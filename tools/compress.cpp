@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bitmaps.hpp"
+#include "textures.hpp"
+
+// compresses a bitmap and the mipmaps made from it into bc1 or bc7 blocks, in a dds or ktx2 file that Textures::load
+// takes; rows are kept bottom up, as gl takes them, and alpha is dropped
+//   compress INPUT.bmp OUTPUT.dds|OUTPUT.ktx2 [bc1|bc7]
+
+typedef float Color[4];
+
+// a least squares fit of two endpoints to the pixels of a block, given how much of the first each pixel's index takes
+void fitEndpoints(const Color *pixels, const float *weights, int channels, Color first, Color second) {
+    float aa = 0, ab = 0, bb = 0;
+    Color ax = {}, bx = {};
+    for (int i = 0; i < 16; ++i) {
+        float a = weights[i], b = 1 - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int k = 0; k < channels; ++k) {
+            ax[k] += a * pixels[i][k];
+            bx[k] += b * pixels[i][k];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f) return;
+    for (int k = 0; k < channels; ++k) {
+        first[k] = std::clamp((ax[k] * bb - bx[k] * ab) / determinant, 0.f, 255.f);
+        second[k] = std::clamp((bx[k] * aa - ax[k] * ab) / determinant, 0.f, 255.f);
+    }
+}
+
+// the ends of the principal axis of the pixels' colors
+void principalEndpoints(const Color *pixels, int channels, Color first, Color second) {
+    Color mean = {};
+    for (int i = 0; i < 16; ++i) {
+        for (int k = 0; k < channels; ++k) mean[k] += pixels[i][k] / 16;
+    }
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; ++i) {
+        for (int j = 0; j < channels; ++j) {
+            for (int k = 0; k < channels; ++k) covariance[j][k] += (pixels[i][j] - mean[j]) * (pixels[i][k] - mean[k]);
+        }
+    }
+    // power iteration
+    Color axis = {1, 1, 1, 1};
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        Color next = {};
+        float length = 0;
+        for (int j = 0; j < channels; ++j) {
+            for (int k = 0; k < channels; ++k) next[j] += covariance[j][k] * axis[k];
+            length += next[j] * next[j];
+        }
+        if (length < 1e-12f) break;
+        for (int j = 0; j < channels; ++j) axis[j] = next[j] / std::sqrt(length);
+    }
+    float low = 0, high = 0;
+    for (int i = 0; i < 16; ++i) {
+        float projection = 0;
+        for (int k = 0; k < channels; ++k) projection += (pixels[i][k] - mean[k]) * axis[k];
+        low = std::min(low, projection);
+        high = std::max(high, projection);
+    }
+    for (int k = 0; k < channels; ++k) {
+        first[k] = std::clamp(mean[k] + axis[k] * high, 0.f, 255.f);
+        second[k] = std::clamp(mean[k] + axis[k] * low, 0.f, 255.f);
+    }
+}
+
+// nearest of the palette's colors to each pixel, returning the squared error
+float assignIndices(const Color *pixels, const Color *palette, int colors, int channels, int *indices) {
+    float total = 0;
+    for (int i = 0; i < 16; ++i) {
+        float best = 1e30f;
+        for (int j = 0; j < colors; ++j) {
+            float error = 0;
+            for (int k = 0; k < channels; ++k) error += (pixels[i][k] - palette[j][k]) * (pixels[i][k] - palette[j][k]);
+            if (error < best) {
+                best = error;
+                indices[i] = j;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+// two 5:6:5 endpoints and a 2 bit index per pixel, in four color mode
+float encodeBc1(const Color *pixels, unsigned char *block) {
+    Color first, second;
+    principalEndpoints(pixels, 3, first, second);
+    uint16_t endpoints[2];
+    Color palette[4];
+    int indices[16];
+    float error = 0;
+    for (int iteration = 0; iteration < 3; ++iteration) {
+        // quantized, and expanded back the way the gpu does
+        for (int e = 0; e < 2; ++e) {
+            const float *color = e == 0 ? first : second;
+            int r = std::lround(color[0] * 31 / 255), g = std::lround(color[1] * 63 / 255), b = std::lround(color[2] * 31 / 255);
+            endpoints[e] = r << 11 | g << 5 | b;
+            palette[e][0] = r << 3 | r >> 2;
+            palette[e][1] = g << 2 | g >> 4;
+            palette[e][2] = b << 3 | b >> 2;
+        }
+        for (int k = 0; k < 3; ++k) {
+            palette[2][k] = std::floor((2 * palette[0][k] + palette[1][k]) / 3);
+            palette[3][k] = std::floor((palette[0][k] + 2 * palette[1][k]) / 3);
+        }
+        error = assignIndices(pixels, palette, 4, 3, indices);
+        if (iteration == 2) break;
+        const float shares[4] = {1, 0, 2.f / 3, 1.f / 3};
+        float weights[16];
+        for (int i = 0; i < 16; ++i) weights[i] = shares[indices[i]];
+        fitEndpoints(pixels, weights, 3, first, second);
+    }
+    // the first endpoint must be the greater for four colors, and equal ones leave a single color
+    if (endpoints[0] < endpoints[1]) {
+        std::swap(endpoints[0], endpoints[1]);
+        for (int &index : indices) index ^= 1;
+    } else if (endpoints[0] == endpoints[1]) {
+        std::fill(indices, indices + 16, 0);
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= indices[i] << i * 2;
+    std::memcpy(block, &endpoints[0], 2);
+    std::memcpy(block + 2, &endpoints[1], 2);
+    std::memcpy(block + 4, &bits, 4);
+    return error;
+}
+
+// mode 6: one subset, two 7 bit rgba endpoints with a bit below each and a 4 bit index per pixel
+float encodeBc7(const Color *pixels, unsigned char *block) {
+    static const int interpolation[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    Color first, second;
+    principalEndpoints(pixels, 4, first, second);
+    int quantized[2][4], bit[2], indices[16];
+    Color palette[16];
+    float error = 0;
+    for (int iteration = 0; iteration < 3; ++iteration) {
+        // the low bit of an endpoint is shared by its channels, so both values are tried
+        for (int e = 0; e < 2; ++e) {
+            const float *color = e == 0 ? first : second;
+            float best = 1e30f;
+            for (int p = 0; p < 2; ++p) {
+                int values[4];
+                float difference = 0;
+                for (int k = 0; k < 4; ++k) {
+                    values[k] = std::clamp((int) std::lround((color[k] - p) / 2), 0, 127);
+                    difference += (values[k] * 2 + p - color[k]) * (values[k] * 2 + p - color[k]);
+                }
+                if (difference < best) {
+                    best = difference;
+                    bit[e] = p;
+                    std::copy(values, values + 4, quantized[e]);
+                }
+            }
+        }
+        for (int j = 0; j < 16; ++j) {
+            for (int k = 0; k < 4; ++k) {
+                int a = quantized[0][k] * 2 + bit[0], b = quantized[1][k] * 2 + bit[1];
+                palette[j][k] = ((64 - interpolation[j]) * a + interpolation[j] * b + 32) >> 6;
+            }
+        }
+        error = assignIndices(pixels, palette, 16, 4, indices);
+        if (iteration == 2) break;
+        float weights[16];
+        for (int i = 0; i < 16; ++i) weights[i] = 1 - interpolation[indices[i]] / 64.f;
+        fitEndpoints(pixels, weights, 4, first, second);
+    }
+    // the first pixel's index has its top bit left out, so it must be below 8
+    if (indices[0] >= 8) {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(bit[0], bit[1]);
+        for (int &index : indices) index = 15 - index;
+    }
+    std::memset(block, 0, 16);
+    int position = 0;
+    auto write = [&](int value, int bits) {
+        for (int i = 0; i < bits; ++i, ++position) block[position / 8] |= (value >> i & 1) << position % 8;
+    };
+    write(1 << 6, 7);
+    for (int k = 0; k < 4; ++k) {
+        write(quantized[0][k], 7);
+        write(quantized[1][k], 7);
+    }
+    write(bit[0], 1);
+    write(bit[1], 1);
+    for (int i = 0; i < 16; ++i) write(indices[i], i == 0 ? 3 : 4);
+    return error;
+}
+
+// every block of a level of rgb rows, with the edge pixels repeated to fill blocks past it
+std::vector<unsigned char> compress(const std::vector<unsigned char> &rgb, int width, int height, CompressedTexture::Format format, double &error) {
+    std::vector<unsigned char> blocks(CompressedTexture::getLevelSize(format, width, height));
+    int blockSize = format == CompressedTexture::BC1 ? 8 : 16;
+    unsigned char *block = blocks.data();
+    for (int y = 0; y < height; y += 4) {
+        for (int x = 0; x < width; x += 4, block += blockSize) {
+            Color pixels[16];
+            for (int i = 0; i < 16; ++i) {
+                const unsigned char *pixel = &rgb[((size_t) std::min(y + i / 4, height - 1) * width + std::min(x + i % 4, width - 1)) * 3];
+                pixels[i][0] = pixel[0];
+                pixels[i][1] = pixel[1];
+                pixels[i][2] = pixel[2];
+                pixels[i][3] = 255;
+            }
+            error += format == CompressedTexture::BC1 ? encodeBc1(pixels, block) : encodeBc7(pixels, block);
+        }
+    }
+    return blocks;
+}
+
+template <typename T>
+void put(std::vector<char> &data, T value) {
+    data.insert(data.end(), (const char *) &value, (const char *) &value + sizeof(T));
+}
+
+std::vector<char> writeDds(CompressedTexture::Format format, int width, int height, const std::vector<std::vector<unsigned char>> &levels) {
+    std::vector<char> data = {'D', 'D', 'S', ' '};
+    put<uint32_t>(data, 124);
+    put<uint32_t>(data, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);  // caps, height, width, pixel format, mipmap count, linear size
+    put<uint32_t>(data, height);
+    put<uint32_t>(data, width);
+    put<uint32_t>(data, levels[0].size());
+    put<uint32_t>(data, 0);
+    put<uint32_t>(data, levels.size());
+    for (int i = 0; i < 11; ++i) put<uint32_t>(data, 0);
+    // the pixel format, bc7 only naming itself in the extended header
+    put<uint32_t>(data, 32);
+    put<uint32_t>(data, 0x4);
+    data.insert(data.end(), {'D', 'X', format == CompressedTexture::BC1 ? 'T' : '1', format == CompressedTexture::BC1 ? '1' : '0'});
+    for (int i = 0; i < 5; ++i) put<uint32_t>(data, 0);
+    put<uint32_t>(data, 0x1000 | 0x400000 | 0x8);  // texture, mipmap, complex
+    for (int i = 0; i < 4; ++i) put<uint32_t>(data, 0);
+    if (format == CompressedTexture::BC7) {
+        put<uint32_t>(data, 98);  // DXGI_FORMAT_BC7_UNORM
+        put<uint32_t>(data, 3);   // a 2d texture
+        put<uint32_t>(data, 0);
+        put<uint32_t>(data, 1);
+        put<uint32_t>(data, 0);
+    }
+    for (auto &level : levels) data.insert(data.end(), level.begin(), level.end());
+    return data;
+}
+
+std::vector<char> writeKtx2(CompressedTexture::Format format, int width, int height, const std::vector<std::vector<unsigned char>> &levels) {
+    bool bc1 = format == CompressedTexture::BC1;
+    int blockSize = bc1 ? 8 : 16;
+    // the data format descriptor: one basic block of a single sample covering the whole 4x4 block
+    std::vector<char> descriptor;
+    put<uint32_t>(descriptor, 44);
+    put<uint32_t>(descriptor, 0);
+    put<uint16_t>(descriptor, 2);
+    put<uint16_t>(descriptor, 40);
+    descriptor.insert(descriptor.end(), {(char) (bc1 ? 128 : 134), 1, 1, 0, 3, 3, 0, 0, (char) blockSize, 0, 0, 0, 0, 0, 0, 0});
+    put<uint16_t>(descriptor, 0);
+    descriptor.insert(descriptor.end(), {(char) (blockSize * 8 - 1), 0, 0, 0, 0, 0});
+    put<uint32_t>(descriptor, 0);
+    put<uint32_t>(descriptor, 0xffffffff);
+    // rows go up, not down as ktx2 assumes
+    std::vector<char> keys;
+    const char orientation[] = "KTXorientation\0ru";
+    put<uint32_t>(keys, sizeof(orientation));
+    keys.insert(keys.end(), orientation, orientation + sizeof(orientation));
+    keys.resize((keys.size() + 3) / 4 * 4);
+
+    size_t indexSize = 80 + levels.size() * 24, keysOffset = indexSize + descriptor.size();
+    size_t offset = (keysOffset + keys.size() + blockSize - 1) / blockSize * blockSize;
+    // levels are stored smallest first, each aligned to a block
+    std::vector<size_t> offsets(levels.size());
+    for (int i = levels.size() - 1; i >= 0; --i) {
+        offsets[i] = offset;
+        offset = (offset + levels[i].size() + blockSize - 1) / blockSize * blockSize;
+    }
+
+    std::vector<char> data = {(char) 0xab, 'K', 'T', 'X', ' ', '2', '0', (char) 0xbb, '\r', '\n', 0x1a, '\n'};
+    put<uint32_t>(data, bc1 ? 131 : 145);  // VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC7_UNORM_BLOCK
+    put<uint32_t>(data, 1);
+    put<uint32_t>(data, width);
+    put<uint32_t>(data, height);
+    put<uint32_t>(data, 0);
+    put<uint32_t>(data, 0);
+    put<uint32_t>(data, 1);
+    put<uint32_t>(data, levels.size());
+    put<uint32_t>(data, 0);
+    put<uint32_t>(data, indexSize);
+    put<uint32_t>(data, descriptor.size());
+    put<uint32_t>(data, keysOffset);
+    put<uint32_t>(data, keys.size());
+    put<uint64_t>(data, 0);
+    put<uint64_t>(data, 0);
+    for (size_t i = 0; i < levels.size(); ++i) {
+        put<uint64_t>(data, offsets[i]);
+        put<uint64_t>(data, levels[i].size());
+        put<uint64_t>(data, levels[i].size());
+    }
+    data.insert(data.end(), descriptor.begin(), descriptor.end());
+    data.insert(data.end(), keys.begin(), keys.end());
+    for (int i = levels.size() - 1; i >= 0; --i) {
+        data.resize(offsets[i]);
+        data.insert(data.end(), levels[i].begin(), levels[i].end());
+    }
+    return data;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "usage: compress INPUT.bmp OUTPUT.dds|OUTPUT.ktx2 [bc1|bc7]" << std::endl;
+        return 1;
+    }
+    std::string input = argv[1], output = argv[2], name = argc > 3 ? argv[3] : "bc1";
+    bool ktx2 = output.size() >= 5 && output.compare(output.size() - 5, 5, ".ktx2") == 0;
+    if (name != "bc1" && name != "bc7") {
+        std::cerr << "unknown format " << name << std::endl;
+        return 1;
+    }
+    CompressedTexture::Format format = name == "bc1" ? CompressedTexture::BC1 : CompressedTexture::BC7;
+    Bitmap bitmap;
+    if (!bitmap.load(input)) return 1;
+
+    int width = bitmap.getWidth(), height = bitmap.getHeight();
+    std::vector<unsigned char> level(width * height * 3), next;
+    bitmap.toRgb(level.data(), width * 3);
+    std::vector<std::vector<unsigned char>> levels;
+    double error = 0;
+    for (int levelWidth = width, levelHeight = height;;) {
+        double levelError = 0;
+        levels.push_back(compress(level, levelWidth, levelHeight, format, levelError));
+        // the error of the full size level is what matters
+        if (levels.size() == 1) error = levelError;
+        if (levelWidth == 1 && levelHeight == 1) break;
+        next.resize(std::max(levelWidth / 2, 1) * std::max(levelHeight / 2, 1) * 3);
+        Textures::downsample(level.data(), levelWidth, levelHeight, levelWidth * 3, 3, next.data());
+        level.swap(next);
+        levelWidth = std::max(levelWidth / 2, 1);
+        levelHeight = std::max(levelHeight / 2, 1);
+    }
+
+    std::vector<char> data = ktx2 ? writeKtx2(format, width, height, levels) : writeDds(format, width, height, levels);
+    std::ofstream file(output, std::ios::binary);
+    file.write(data.data(), data.size());
+    if (!file) {
+        std::cerr << "couldn't write " << output << std::endl;
+        return 1;
+    }
+    double meanSquare = error / (width * height * 3.);
+    std::cout << output << ": " << name << ", " << width << "x" << height << ", " << levels.size() << " levels, " << data.size() << " bytes, "
+              << std::fixed << std::setprecision(2) << (meanSquare > 0 ? 10 * std::log10(255 * 255 / meanSquare) : INFINITY) << " dB" << std::endl;
+}
@@ -0,0 +1,63 @@
+#define _USE_MATH_DEFINES
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "RgbImage.h"
+#include "bitmaps.hpp"
+
+// cuts the six faces of a cube map out of a panorama, mapped the way Sphere maps its texture: the first column at +x,
+// a quarter of the way along at +z, and the bottom row straight down; faces are written as BASE_px.bmp, BASE_nx.bmp,
+// BASE_py.bmp and on, each size pixels square, and sampled bilinearly from the panorama
+//   cubemap INPUT.bmp BASE [size]
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "usage: cubemap INPUT.bmp BASE [size]" << std::endl;
+        return 1;
+    }
+    Bitmap bitmap;
+    if (!bitmap.load(argv[1])) return 1;
+    int width = bitmap.getWidth(), height = bitmap.getHeight();
+    // a face as wide as a quarter of the panorama keeps about as many texels around the horizon
+    int size = argc > 3 ? std::stoi(argv[3]) : std::max(width / 4, 1);
+    std::vector<unsigned char> panorama((size_t) width * height * 3);
+    bitmap.toRgb(panorama.data(), width * 3);
+
+    // the direction through a face's texel, from its coordinates in [-1, 1] the way gl looks them up
+    const char *names[6] = {"px", "nx", "py", "ny", "pz", "nz"};
+    auto direction = [](int face, double s, double t, double *d) {
+        const double directions[6][3] = {{1, -t, -s}, {-1, -t, s}, {s, 1, t}, {s, -1, -t}, {s, -t, 1}, {-s, -t, -1}};
+        std::copy(directions[face], directions[face] + 3, d);
+    };
+    for (int face = 0; face < 6; ++face) {
+        RgbImage image(size, size);
+        for (int row = 0; row < size; ++row) {
+            for (int column = 0; column < size; ++column) {
+                double d[3];
+                direction(face, (column + 0.5) / size * 2 - 1, (row + 0.5) / size * 2 - 1, d);
+                // longitude around from +x towards +z, latitude up from the horizon
+                double u = std::atan2(d[2], d[0]) / (2 * M_PI), v = 0.5 + std::atan2(d[1], std::hypot(d[0], d[2])) / M_PI;
+                double x = (u - std::floor(u)) * width - 0.5, y = std::clamp(v * height - 0.5, 0., height - 1.);
+                int x0 = std::floor(x), y0 = std::floor(y), y1 = std::min(y0 + 1, height - 1);
+                double fx = x - x0, fy = y - y0;
+                // wrapped around the panorama's seam, clamped at its poles
+                x0 = (x0 + width) % width;
+                int x1 = (x0 + 1) % width;
+                unsigned char pixel[3];
+                for (int k = 0; k < 3; ++k) {
+                    auto at = [&](int x, int y) { return panorama[((size_t) y * width + x) * 3 + k]; };
+                    double top = at(x0, y1) * (1 - fx) + at(x1, y1) * fx, bottom = at(x0, y0) * (1 - fx) + at(x1, y0) * fx;
+                    pixel[k] = std::lround(bottom * (1 - fy) + top * fy);
+                }
+                image.SetRgbPixelc(row, column, pixel[0], pixel[1], pixel[2]);
+            }
+        }
+        std::string path = std::string(argv[2]) + "_" + names[face] + ".bmp";
+        if (!image.WriteBmpFile(path.c_str())) return 1;
+        std::cout << path << ": " << size << "x" << size << std::endl;
+    }
+}